@@ -0,0 +1,113 @@
+// Measures how fast typical JSON bodies are gzip compressed and decompressed and prints the link
+// bandwidth below which compressing a body of the given size reduces the total transfer time:
+//
+//   size / bandwidth > compressTime + decompressTime + compressedSize / bandwidth
+//
+// Usage: compression_benchmark [level]
+
+#include "../src/compression.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+// The body of a bulk insert, as sent by BulkWriter.
+std::string bulkInsert(std::size_t size) {
+  std::string body = "{\"stmt\":\"INSERT INTO players (id, name, score, active, joined) "
+                     "VALUES (?, ?, ?, ?, ?)\",\"bulk_args\":[";
+  for (int i = 0; body.size() < size; ++i) {
+    if (i > 0) body += ",";
+    body += "[" + std::to_string(i) + ",\"player-" + std::to_string(i * 7919 % 100000) + "\"," +
+            std::to_string((i * 31) % 1000) + "." + std::to_string(i % 100) + "," +
+            (i % 3 ? "true" : "false") + "," + std::to_string(1500000000000LL + i * 1013) + "]";
+  }
+  return body + "]}";
+}
+
+// A reply of a SELECT statement.
+std::string selectReply(std::size_t size) {
+  std::string body = "{\"cols\":[\"id\",\"name\",\"score\",\"active\",\"joined\"],"
+                     "\"col_types\":[10,4,6,3,11],\"rows\":[";
+  for (int i = 0; body.size() < size; ++i) {
+    if (i > 0) body += ",";
+    body += "[" + std::to_string(i) + ",\"player-" + std::to_string(i * 7919 % 100000) + "\"," +
+            std::to_string((i * 31) % 1000) + "." + std::to_string(i % 100) + "," +
+            (i % 3 ? "true" : "false") + "," + std::to_string(1500000000000LL + i * 1013) + "]";
+  }
+  return body + "],\"rowcount\":0,\"duration\":1.5}";
+}
+
+// Compresses \a data like Connection does, reading the body in pieces of curl's upload buffer.
+std::string compress(CppCrate::GzipReader& reader, const std::string& data) {
+  static std::vector<char> buffer(65536);
+  std::string compressed;
+  reader.reset(data.data(), data.size());
+  while (std::size_t read = reader.read(&buffer[0], buffer.size())) {
+    compressed.append(&buffer[0], read);
+  }
+  return compressed;
+}
+
+std::size_t decompress(const std::string& compressed) {
+  static std::vector<char> buffer(65536);
+  z_stream stream = z_stream();
+  inflateInit2(&stream, 15 + 16);
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+  stream.avail_in = static_cast<uInt>(compressed.size());
+  std::size_t total = 0;
+  int code = Z_OK;
+  while (code == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef*>(&buffer[0]);
+    stream.avail_out = static_cast<uInt>(buffer.size());
+    code = inflate(&stream, Z_NO_FLUSH);
+    total += buffer.size() - stream.avail_out;
+  }
+  inflateEnd(&stream);
+  return total;
+}
+
+double seconds(Clock::duration d) { return std::chrono::duration<double>(d).count(); }
+
+void run(const char* name, std::string (*payload)(std::size_t), int level) {
+  std::printf("\n%s, level %d\n", name, level);
+  std::printf("%10s %10s %7s %12s %12s %16s\n", "bytes", "gzip", "ratio", "deflate MB/s",
+              "inflate MB/s", "break-even Mbit/s");
+
+  CppCrate::GzipReader reader(level);
+  for (std::size_t size = 256; size <= 16 * 1024 * 1024; size *= 4) {
+    const std::string data = payload(size);
+    const int rounds = static_cast<int>(std::max<std::size_t>(5, (64 * 1024 * 1024) / data.size()));
+
+    std::string compressed;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < rounds; ++i) compressed = compress(reader, data);
+    const double compressTime = seconds(Clock::now() - start) / rounds;
+
+    start = Clock::now();
+    for (int i = 0; i < rounds; ++i) decompress(compressed);
+    const double decompressTime = seconds(Clock::now() - start) / rounds;
+
+    const double saved = static_cast<double>(data.size()) - static_cast<double>(compressed.size());
+    const double breakEven = saved > 0 ? saved * 8 / (compressTime + decompressTime) / 1e6 : 0;
+    std::printf("%10zu %10zu %6.1f%% %12.1f %12.1f %16.0f\n", data.size(), compressed.size(),
+                100.0 * compressed.size() / data.size(), data.size() / compressTime / 1e6,
+                data.size() / decompressTime / 1e6, breakEven);
+  }
+}
+}
+
+int main(int argc, char** argv) {
+  const int level = argc > 1 ? std::atoi(argv[1]) : Z_BEST_SPEED;
+  std::printf("Compressing pays off on links slower than the break-even bandwidth.\n");
+  run("Bulk insert body", bulkInsert, level);
+  run("SELECT reply", selectReply, level);
+  return 0;
+}
@@ -0,0 +1,89 @@
+// Measures the throughput of computing blob keys with each SHA-1 implementation supported by the
+// CPU and with the bundled implementation %CppCrate used before, which reads a stream. Afterwards
+// many small blobs are hashed one after another and in parallel lanes.
+//
+// Usage: sha1_benchmark [megabytes]
+
+#include "../src/sha1.h"
+
+#include <sha1/sha1.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+template <typename Function>
+void measure(const char* name, std::size_t size, Function hash) {
+  // The best of some runs, so the result does not depend on other load.
+  double best = 1e9;
+  std::string digest;
+  for (int i = 0; i < 5; ++i) {
+    const Clock::time_point start = Clock::now();
+    digest = hash();
+    best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+  }
+  std::printf("%-28s %8.3f GB/s  %s\n", name, size / best / 1e9, digest.c_str());
+}
+}
+
+int main(int argc, char** argv) {
+  using CppCrate::Sha1;
+
+  const std::size_t size = (argc > 1 ? std::atoi(argv[1]) : 256) * std::size_t(1024 * 1024);
+  std::string data(size, '\0');
+  for (std::size_t i = 0; i < size; ++i) data[i] = static_cast<char>(i * 2654435761u >> 24);
+
+  std::printf("Hashing %zu MiB\n\n", size / (1024 * 1024));
+  measure("bundled, stream", size, [&data]() {
+    std::istringstream stream(data);
+    SHA1 gen;
+    gen.update(stream);
+    return gen.final();
+  });
+
+  const Sha1::Implementation implementations[] = {
+      Sha1::ScalarImplementation, Sha1::Ssse3Implementation, Sha1::ShaNiImplementation};
+  for (int i = 0; i < 3; ++i) {
+    if (!Sha1::isSupported(implementations[i])) {
+      std::printf("%-28s not supported by the CPU\n", Sha1::name(implementations[i]));
+      continue;
+    }
+    const Sha1::Implementation implementation = implementations[i];
+    measure(Sha1::name(implementation), size, [&data, implementation]() {
+      Sha1 gen(implementation);
+      gen.update(data.data(), data.size());
+      return gen.final();
+    });
+  }
+  std::printf("\nUsed implementation: %s\n", Sha1::name(Sha1::fastest()));
+
+  // Blobs between 5 and 50 KB taken from the same data.
+  std::vector<Sha1::Buffer> buffers;
+  std::size_t total = 0;
+  for (std::size_t offset = 0, i = 0; offset + 50000 <= size; offset += 50000, ++i) {
+    buffers.push_back(Sha1::Buffer(data.data() + offset, 5000 + (i * 7919) % 45000));
+    total += buffers.back().size;
+  }
+  std::printf("\nHashing %zu blobs of 5-50 KB\n\n", buffers.size());
+  const Sha1::Implementation batchImplementations[] = {
+      Sha1::ScalarImplementation, Sha1::Ssse3Implementation, Sha1::ShaNiImplementation,
+      Sha1::Sse2LanesImplementation, Sha1::Avx2LanesImplementation};
+  for (int i = 0; i < 5; ++i) {
+    if (!Sha1::isSupported(batchImplementations[i])) {
+      std::printf("%-28s not supported by the CPU\n", Sha1::name(batchImplementations[i]));
+      continue;
+    }
+    const Sha1::Implementation implementation = batchImplementations[i];
+    measure(Sha1::name(implementation), total, [&buffers, implementation]() {
+      return Sha1::hash(buffers, implementation).back();
+    });
+  }
+  std::printf("\nUsed implementation: %s\n", Sha1::name(Sha1::fastestBatch()));
+  return 0;
+}
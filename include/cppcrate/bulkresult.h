@@ -0,0 +1,51 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+#include <cppcrate/rawresult.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CppCrate {
+
+class CPPCRATE_EXPORT BulkResult {
+  CPPCRATE_PIMPL_DECLARE_ALL(BulkResult)
+
+ public:
+  BulkResult();
+  explicit BulkResult(int rows);
+
+#ifdef ENABLE_CPP11_SUPPORT
+  explicit
+#endif
+  operator bool() const;
+  bool hasError() const;
+  std::string errorString() const;
+
+  int size() const;
+  int64_t rowCount(int row) const;
+  bool isFailed(int row) const;
+  int failedCount() const;
+  std::vector<int> failedRows() const;
+
+  void setChunkResult(int firstRow, int rows, const RawResult &raw);
+};
+
+}  // namespace CppCrate
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/bulkresult.h>
+#include <cppcrate/global.h>
+#include <cppcrate/query.h>
+
+namespace CppCrate {
+
+class Client;
+
+class CPPCRATE_EXPORT BulkWriter {
+  CPPCRATE_PIMPL_DECLARE_PRIVATE(BulkWriter)
+
+ public:
+  explicit BulkWriter(Client &client, int chunkSize = 1000, int maxParallelChunks = 4);
+
+  int chunkSize() const;
+  void setChunkSize(int rows);
+  int maxParallelChunks() const;
+  void setMaxParallelChunks(int chunks);
+
+  BulkResult write(const Query &query);
+
+ private:
+  BulkWriter(const BulkWriter &);
+  BulkWriter &operator=(const BulkWriter &);
+};
+
+}  // namespace CppCrate
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+
+#include <string>
+
+namespace CppCrate {
+
+class CPPCRATE_EXPORT Cell {
+  friend class Result;
+
+ public:
+  Cell();
+
+  bool isNull() const;
+
+  bool read(bool &value) const;
+  bool read(int16_t &value) const;
+  bool read(int32_t &value) const;
+  bool read(int64_t &value) const;
+  bool read(float &value) const;
+  bool read(double &value) const;
+  bool read(std::string &value) const;
+
+ private:
+  explicit Cell(const void *json);
+
+  const void *json;
+};
+
+}  // namespace CppCrate
@@ -19,6 +19,7 @@
 #include <cppcrate/global.h>
 
 #include <cppcrate/node.h>
+#include <cppcrate/preparedquery.h>
 #include <cppcrate/query.h>
 #include <cppcrate/rawresult.h>
 #include <cppcrate/result.h>
@@ -29,6 +30,14 @@
 #include <iostream>
 #endif
 
+#ifdef ENABLE_CPP11_SUPPORT
+#include <cppcrate/rowcursor.h>
+#include <cppcrate/tablescanner.h>
+
+#include <functional>
+#include <future>
+#endif
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -42,7 +51,8 @@ class CPPCRATE_EXPORT Client {
   enum ConnectionOptions {
     ConnectToFirstNodeAlways,
     ConnectToLastAccessedNode,
-    ConnectToRandomNode
+    ConnectToRandomNode,
+    ConnectToLeastLoadedNode
   };
 
   Client();
@@ -63,11 +73,41 @@ class CPPCRATE_EXPORT Client {
   void clearDefaultSchema();
   const std::string &defaultSchema() const;
 
+  void setReplyCompression(bool enabled);
+  bool replyCompression() const;
+#ifdef ENABLE_COMPRESSION_SUPPORT
+  void setRequestCompressionThreshold(int bytes);
+  int requestCompressionThreshold() const;
+#endif
+
+#ifdef ENABLE_CPP11_SUPPORT
+  void setNodeRefreshInterval(int milliseconds);
+  int nodeRefreshInterval() const;
+#endif
+
   Result exec(const std::string &sql);
   Result exec(const Query &query);
   RawResult execRaw(const std::string &sql);
   RawResult execRaw(const Query &query);
 
+  PreparedQuery prepare(const std::string &sql) const;
+  Result exec(const PreparedQuery &query, const std::string &args = std::string());
+  RawResult execRaw(const PreparedQuery &query, const std::string &args = std::string());
+
+#ifdef ENABLE_CPP11_SUPPORT
+  std::future<Result> execAsync(const std::string &sql);
+  std::future<Result> execAsync(const Query &query);
+  void execAsync(const Query &query, const std::function<void(const Result &)> &callback);
+  std::future<RawResult> execRawAsync(const Query &query);
+  void execRawAsync(const Query &query, const std::function<void(const RawResult &)> &callback);
+
+  RowCursor query(const std::string &sql, int bufferedRows = 1000);
+  RowCursor query(const Query &query, int bufferedRows = 1000);
+
+  TableScanner scan(const std::string &table, const std::string &keyColumn, int pageSize = 1000,
+                    const std::string &columns = "*");
+#endif
+
   bool refresh(const std::string &table);
   std::vector<std::string> schemata();
   std::vector<Node> clusterNodes();
@@ -80,10 +120,26 @@ class CPPCRATE_EXPORT Client {
 
   BlobResult uploadBlob(const std::string &tableName, std::istream &data);
   BlobResult uploadBlob(const std::string &tableName, const std::string &file);
+  std::vector<BlobResult> uploadBlobs(const std::string &tableName,
+                                      const std::vector<std::string> &files);
+  std::vector<BlobResult> downloadBlobs(const std::string &tableName,
+                                        const std::vector<std::string> &keys,
+                                        const std::string &directory);
+#ifdef ENABLE_CPP11_SUPPORT
+  std::vector<BlobResult> downloadBlobs(
+      const std::string &tableName, const std::vector<std::string> &keys,
+      const std::function<std::unique_ptr<std::ostream>(const std::string &)> &open);
+#endif
+  void setMaxBlobTransfers(int transfers);
+  int maxBlobTransfers() const;
+  bool setBlobCache(const std::string &directory, int64_t maxBytes);
+  void clearBlobCache();
   BlobResult existsBlob(const std::string &tableName, const std::string &key);
   BlobResult downloadBlob(const std::string &tableName, const std::string &key, std::ostream &data);
   BlobResult downloadBlob(const std::string &tableName, const std::string &key,
                           const std::string &file);
+  BlobResult downloadBlob(const std::string &tableName, const std::string &key,
+                          const std::string &file, int ranges);
   BlobResult deleteBlob(const std::string &tableName, const std::string &key);
 #endif
 };
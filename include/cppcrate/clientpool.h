@@ -0,0 +1,106 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+
+#include <cppcrate/client.h>
+#include <cppcrate/node.h>
+#include <cppcrate/preparedquery.h>
+#include <cppcrate/query.h>
+#include <cppcrate/rawresult.h>
+#include <cppcrate/result.h>
+
+#ifdef ENABLE_BLOB_SUPPORT
+#include <cppcrate/blobresult.h>
+
+#include <iostream>
+#endif
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CppCrate {
+
+class CPPCRATE_EXPORT ClientPool {
+  CPPCRATE_PIMPL_DECLARE_PRIVATE(ClientPool)
+
+ public:
+  explicit ClientPool(int maxConnections = 8);
+
+  int maxConnections() const;
+  int openConnections() const;
+
+  bool connect(const std::string &url);
+  bool connect(const Node &node);
+  bool connect(const std::vector<Node> &nodes,
+               Client::ConnectionOptions options = Client::ConnectToLastAccessedNode);
+  void disconnect();
+  bool isConnected() const;
+  explicit operator bool() const;
+
+  void setDefaultSchema(const std::string &schema);
+  void clearDefaultSchema();
+  std::string defaultSchema() const;
+
+  void setReplyCompression(bool enabled);
+  bool replyCompression() const;
+#ifdef ENABLE_COMPRESSION_SUPPORT
+  void setRequestCompressionThreshold(int bytes);
+  int requestCompressionThreshold() const;
+#endif
+
+  void setNodeRefreshInterval(int milliseconds);
+  int nodeRefreshInterval() const;
+
+  Result exec(const std::string &sql);
+  Result exec(const Query &query);
+  RawResult execRaw(const std::string &sql);
+  RawResult execRaw(const Query &query);
+
+  PreparedQuery prepare(const std::string &sql) const;
+  Result exec(const PreparedQuery &query, const std::string &args = std::string());
+  RawResult execRaw(const PreparedQuery &query, const std::string &args = std::string());
+
+#ifdef ENABLE_BLOB_SUPPORT
+  BlobResult uploadBlob(const std::string &tableName, std::istream &data);
+  BlobResult uploadBlob(const std::string &tableName, const std::string &file);
+  std::vector<BlobResult> uploadBlobs(const std::string &tableName,
+                                      const std::vector<std::string> &files);
+  std::vector<BlobResult> downloadBlobs(const std::string &tableName,
+                                        const std::vector<std::string> &keys,
+                                        const std::string &directory);
+  std::vector<BlobResult> downloadBlobs(
+      const std::string &tableName, const std::vector<std::string> &keys,
+      const std::function<std::unique_ptr<std::ostream>(const std::string &)> &open);
+  void setMaxBlobTransfers(int transfers);
+  int maxBlobTransfers() const;
+  bool setBlobCache(const std::string &directory, int64_t maxBytes);
+  void clearBlobCache();
+  BlobResult existsBlob(const std::string &tableName, const std::string &key);
+  BlobResult downloadBlob(const std::string &tableName, const std::string &key, std::ostream &data);
+  BlobResult downloadBlob(const std::string &tableName, const std::string &key,
+                          const std::string &file);
+  BlobResult downloadBlob(const std::string &tableName, const std::string &key,
+                          const std::string &file, int ranges);
+  BlobResult deleteBlob(const std::string &tableName, const std::string &key);
+#endif
+};
+
+}  // namespace CppCrate
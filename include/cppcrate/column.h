@@ -0,0 +1,53 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/cratedatatype.h>
+#include <cppcrate/global.h>
+
+#include <string>
+#include <vector>
+
+namespace CppCrate {
+
+class CPPCRATE_EXPORT Column {
+  CPPCRATE_PIMPL_DECLARE_ALL(Column)
+  friend class Result;
+
+ public:
+  enum Type { InvalidType, BoolType, Int64Type, DoubleType, StringType };
+
+  Column();
+
+  const std::string &name() const;
+  const CrateDataType &crateType() const;
+  Type type() const;
+
+  int size() const;
+  bool isNull(int row) const;
+  int nullCount() const;
+  const std::vector<uint8_t> &nullBitmap() const;
+
+  const std::vector<uint8_t> &bools() const;
+  const std::vector<int64_t> &int64s() const;
+  const std::vector<double> &doubles() const;
+  const std::string &stringData() const;
+  const std::vector<std::size_t> &stringOffsets() const;
+  std::string string(int row) const;
+};
+
+}  // namespace CppCrate
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/bulkresult.h>
+#include <cppcrate/global.h>
+#include <cppcrate/query.h>
+#include <cppcrate/rowbatch.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace CppCrate {
+
+class ClientPool;
+
+class CPPCRATE_EXPORT InsertCoalescer {
+  CPPCRATE_PIMPL_DECLARE_PRIVATE(InsertCoalescer)
+
+ public:
+  enum OverflowPolicy { BlockOnOverflow, RejectOnOverflow };
+
+  typedef std::function<void(const std::string &sql, const RowBatch &rows,
+                             const BulkResult &result)>
+      ErrorHandler;
+
+  explicit InsertCoalescer(ClientPool &pool);
+
+  int maxRows() const;
+  void setMaxRows(int rows);
+  std::size_t maxBytes() const;
+  void setMaxBytes(std::size_t bytes);
+  int maxDelay() const;
+  void setMaxDelay(int milliseconds);
+  int highWaterMark() const;
+  void setHighWaterMark(int rows);
+  OverflowPolicy overflowPolicy() const;
+  void setOverflowPolicy(OverflowPolicy policy);
+  void setErrorHandler(const ErrorHandler &handler);
+
+  bool insert(const std::string &sql, const std::string &args);
+  bool insert(const Query &query);
+  void flush();
+
+  int pendingRows() const;
+
+ private:
+  InsertCoalescer(const InsertCoalescer &);
+  InsertCoalescer &operator=(const InsertCoalescer &);
+};
+
+}  // namespace CppCrate
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/cell.h>
+#include <cppcrate/global.h>
+#include <cppcrate/result.h>
+
+#include <string>
+#include <vector>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::Mapping
+ *
+ * \brief Decodes the rows of a result into user defined structs.
+ *
+ * The class template %Mapping assigns columns of a Result to data members of \a T. The columns'
+ * positions are resolved once per result and each member is read directly from the reply by the
+ * Cell::read() overload matching the member's type, so no Value is created:
+ * \code
+ * struct Player {
+ *   int64_t id;
+ *   std::string name;
+ *   double score;
+ * };
+ *
+ * const CppCrate::Mapping<Player> mapping(&Player::id, "id", &Player::name, "name",
+ *                                         &Player::score, "score");
+ * std::vector<Player> players = mapping.decode(client.exec("SELECT * FROM players"));
+ * \endcode
+ *
+ * Without C++11 support use map() to add the members one after another.
+ *
+ * Supported member types are \c bool, \c int16_t, \c int32_t, \c int64_t, \c float, \c double and
+ * \c std::string. Members whose column is missing, null or not convertible keep the value they got
+ * from \a T's default constructor.
+ */
+template <class T>
+class Mapping {
+ public:
+  /*!
+   * Constructs an empty mapping.
+   */
+  Mapping() {}
+
+#ifdef ENABLE_CPP11_SUPPORT
+  /*!
+   * Constructs a mapping of \a member to the column \a name followed by further pairs of members
+   * and column names in \a rest.
+   */
+  template <class M, class... Rest>
+  Mapping(M T::*member, const std::string &name, Rest... rest) {
+    map(member, name, rest...);
+  }
+#endif
+
+  Mapping(const Mapping &other) {
+    fields.reserve(other.fields.size());
+    for (std::size_t i = 0, total = other.fields.size(); i < total; ++i) {
+      fields.push_back(other.fields[i]->clone());
+    }
+  }
+
+  ~Mapping() {
+    for (std::size_t i = 0, total = fields.size(); i < total; ++i) delete fields[i];
+  }
+
+  Mapping &operator=(Mapping other) {
+    fields.swap(other.fields);
+    return *this;
+  }
+
+  /*!
+   * Maps \a member to the column \a name.
+   */
+  template <class M>
+  Mapping &map(M T::*member, const std::string &name) {
+    fields.push_back(new MemberField<M>(member, name));
+    return *this;
+  }
+
+#ifdef ENABLE_CPP11_SUPPORT
+  /*!
+   * Maps \a member to the column \a name followed by further pairs of members and column names in
+   * \a rest.
+   */
+  template <class M, class... Rest>
+  Mapping &map(M T::*member, const std::string &name, Rest... rest) {
+    map(member, name);
+    return map(rest...);
+  }
+#endif
+
+  /*!
+   * Returns all records of \a result decoded into \a T.
+   */
+  std::vector<T> decode(const Result &result) const {
+    std::vector<T> rows(static_cast<std::size_t>(result.recordSize()));
+    for (std::size_t i = 0, total = fields.size(); i < total; ++i) {
+      const int column = result.columnIndex(fields[i]->name);
+      if (column >= 0) fields[i]->read(result, column, rows);
+    }
+    return rows;
+  }
+
+ private:
+  class Field {
+   public:
+    explicit Field(const std::string &name) : name(name) {}
+    virtual ~Field() {}
+    virtual Field *clone() const = 0;
+    virtual void read(const Result &result, int column, std::vector<T> &rows) const = 0;
+
+    std::string name;
+  };
+
+  template <class M>
+  class MemberField : public Field {
+   public:
+    MemberField(M T::*member, const std::string &name) : Field(name), member(member) {}
+    Field *clone() const { return new MemberField(member, this->name); }
+    void read(const Result &result, int column, std::vector<T> &rows) const {
+      for (std::size_t row = 0, total = rows.size(); row < total; ++row) {
+        result.cell(static_cast<int>(row), column).read(rows[row].*member);
+      }
+    }
+
+    M T::*member;
+  };
+
+  std::vector<Field *> fields;
+};
+
+}  // namespace CppCrate
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+
+#include <memory>
+#include <string>
+
+namespace CppCrate {
+
+class Connection;
+
+class CPPCRATE_EXPORT PreparedQuery {
+  CPPCRATE_PIMPL_DECLARE_ALL(PreparedQuery)
+  friend class Connection;
+
+ public:
+  PreparedQuery();
+  explicit PreparedQuery(const std::string &sql, const std::string &defaultSchema = std::string());
+
+  bool isEmpty() const;
+  const std::string &statement() const;
+  const std::string &defaultSchema() const;
+};
+
+}  // namespace CppCrate
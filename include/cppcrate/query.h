@@ -17,7 +17,9 @@
 #pragma once
 
 #include <cppcrate/global.h>
+#include <cppcrate/rowbatch.h>
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -33,6 +35,7 @@ class CPPCRATE_EXPORT Query {
   explicit Query(const std::string &sql = "");
   Query(const std::string &sql, const std::string &args);
   Query(const std::string &sql, const std::vector<std::string> &bulkArgs);
+  Query(const std::string &sql, const RowBatch &bulkArgs);
 
   bool isEmpty() const;
   Type type() const;
@@ -46,8 +49,25 @@ class CPPCRATE_EXPORT Query {
   bool hasArguments() const;
 
   void setBulkArguments(const std::vector<std::string> &bulkArgs);
-  const std::vector<std::string> &bulkArguments() const;
+  void setBulkArguments(const RowBatch &bulkArgs);
+  std::vector<std::string> bulkArguments() const;
+  const RowBatch &bulkArgumentBatch() const;
   bool hasBulkArguments() const;
+
+  Query &bind(bool value);
+  Query &bind(int value);
+  Query &bind(unsigned int value);
+  Query &bind(long value);
+  Query &bind(unsigned long value);
+  Query &bind(long long value);
+  Query &bind(unsigned long long value);
+  Query &bind(double value);
+  Query &bind(const char *value);
+  Query &bind(const char *value, std::size_t length);
+  Query &bind(const std::string &value);
+  Query &bindNull();
+  Query &nextRow();
+  void clearArguments();
 };
 
 }  // namespace CppCrate
@@ -28,6 +28,8 @@ namespace CppCrate {
 
 class CPPCRATE_EXPORT Record {
   CPPCRATE_PIMPL_DECLARE_ALL(Record)
+  friend class Result;
+  friend class RowCursor;
 
  public:
   Record();
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cppcrate/cell.h>
+#include <cppcrate/column.h>
 #include <cppcrate/cratedatatype.h>
 #include <cppcrate/global.h>
 #include <cppcrate/rawresult.h>
@@ -46,10 +48,15 @@ class CPPCRATE_EXPORT Result {
   int rowCount() const;
   const std::vector<std::string>& cols() const;
   const std::vector<CrateDataType>& colTypes() const;
+  int columnIndex(const std::string& name) const;
   const std::vector<std::string>& rows() const;
 
   int recordSize() const;
   Record record(int pos) const;
+  Cell cell(int row, int column) const;
+
+  Column column(int index) const;
+  Column column(const std::string& name) const;
 };
 
 }  // namespace CppCrate
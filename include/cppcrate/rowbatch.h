@@ -0,0 +1,51 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CppCrate {
+
+class CPPCRATE_EXPORT RowBatch {
+  CPPCRATE_PIMPL_DECLARE_ALL(RowBatch)
+
+ public:
+  RowBatch();
+  explicit RowBatch(const std::vector<std::string> &rows);
+
+  bool isEmpty() const;
+  int size() const;
+  void reserve(std::size_t bytes);
+  void clear();
+
+  void append(const std::string &row);
+  void append(const char *row, std::size_t length);
+  void append(const RowBatch &other);
+
+  std::string row(int pos) const;
+  std::vector<std::string> rows() const;
+  RowBatch slice(int pos, int count) const;
+
+  const std::string &json() const;
+};
+
+}  // namespace CppCrate
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/cratedatatype.h>
+#include <cppcrate/global.h>
+#include <cppcrate/record.h>
+
+#include <string>
+#include <vector>
+
+namespace CppCrate {
+
+class CPPCRATE_EXPORT RowCursor {
+  CPPCRATE_PIMPL_DECLARE_PRIVATE(RowCursor)
+  CPPCRATE_PIMPL_DECLARE_MOVE(RowCursor)
+  friend class Client;
+
+ public:
+  RowCursor();
+
+  explicit operator bool() const;
+  bool hasError() const;
+  std::string errorString() const;
+
+  bool next();
+  const Record &record() const;
+
+  std::vector<std::string> cols() const;
+  std::vector<CrateDataType> colTypes() const;
+  int rowCount() const;
+  double duration() const;
+
+ private:
+  explicit RowCursor(const std::string &errorString);
+  RowCursor(const RowCursor &);
+  RowCursor &operator=(const RowCursor &);
+};
+
+}  // namespace CppCrate
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+#include <cppcrate/result.h>
+
+#include <string>
+
+namespace CppCrate {
+
+class Client;
+
+class CPPCRATE_EXPORT TableScanner {
+  CPPCRATE_PIMPL_DECLARE_PRIVATE(TableScanner)
+  CPPCRATE_PIMPL_DECLARE_MOVE(TableScanner)
+  friend class Client;
+
+ public:
+  TableScanner();
+
+  explicit operator bool() const;
+  bool hasError() const;
+  const std::string &errorString() const;
+
+  bool next();
+  const Result &page() const;
+
+  const std::string &table() const;
+  const std::string &keyColumn() const;
+  int pageSize() const;
+
+ private:
+  TableScanner(Client &client, const std::string &table, const std::string &keyColumn,
+               int pageSize, const std::string &columns);
+  TableScanner(const TableScanner &);
+  TableScanner &operator=(const TableScanner &);
+};
+
+}  // namespace CppCrate
@@ -19,13 +19,16 @@
 #include <cppcrate/cratedatatype.h>
 #include <cppcrate/global.h>
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
 namespace CppCrate {
 
+class ValueMeta;
+
 class CPPCRATE_EXPORT Value {
-  CPPCRATE_PIMPL_DECLARE_ALL(Value)
+  friend class Record;
 
  public:
   enum Type {
@@ -51,8 +54,19 @@ class CPPCRATE_EXPORT Value {
   Value(const std::string &name, const CrateDataType &type, double value);
   Value(const std::string &name, const CrateDataType &type, const std::string &value);
 
+  Value(const Value &other);
+#ifdef ENABLE_CPP11_SUPPORT
+  Value(Value &&other);
+#endif
+  ~Value();
+  Value &operator=(Value other);
+  friend void swap(Value &lhs, Value &rhs);
+
+  bool operator==(const Value &other) const;
+  bool operator!=(const Value &other) const;
+
   const std::string &name() const;
-  CrateDataType crateType() const;
+  const CrateDataType &crateType() const;
 
   bool isInvalid() const;
   bool isNull() const;
@@ -65,6 +79,37 @@ class CPPCRATE_EXPORT Value {
   float asFloat() const;
   double asDouble() const;
   std::string asString() const;
+
+ private:
+  Value(const ValueMeta *meta, Type type);
+  Value(const ValueMeta *meta, bool value);
+  Value(const ValueMeta *meta, int16_t value);
+  Value(const ValueMeta *meta, int32_t value);
+  Value(const ValueMeta *meta, int64_t value);
+  Value(const ValueMeta *meta, float value);
+  Value(const ValueMeta *meta, double value);
+  Value(const ValueMeta *meta, const char *value, std::size_t length);
+
+  void setString(const char *value, std::size_t length);
+  const char *stringData() const;
+  template <typename T>
+  T asNumeric() const;
+
+  enum { SmallStringSize = 16 };
+
+  const ValueMeta *meta;
+  Type dataType;
+  std::size_t length;
+  union Data {
+    bool b;
+    int16_t i;
+    int32_t l;
+    int64_t ll;
+    float f;
+    double d;
+    char *sp;
+    char s[SmallStringSize];
+  } data;
 };
 
 }  // namespace CppCrate
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "asyncworker.h"
+#include "global_p.h"
+#include "nodelist.h"
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+AsyncWorker::AsyncWorker() : multi(curl_multi_init()), stopped(false) {}
+
+AsyncWorker::~AsyncWorker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopped = true;
+  }
+#ifdef CPPCRATE_HAS_MULTI_WAKEUP
+  curl_multi_wakeup(multi);
+#endif
+  if (thread.joinable()) thread.join();
+
+  for (std::set<Transfer*>::iterator it = active.begin(), end = active.end(); it != end; ++it) {
+    curl_multi_remove_handle(multi, (*it)->handle());
+    (*it)->cancel();
+    delete *it;
+  }
+  for (std::size_t i = 0, total = pending.size(); i < total; ++i) {
+    pending[i]->cancel();
+    delete pending[i];
+  }
+  curl_multi_cleanup(multi);
+}
+
+// Takes ownership of \a transfer. The I/O thread is started with the first transfer.
+void AsyncWorker::submit(Transfer* transfer) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!stopped && multi) {
+      pending.push_back(transfer);
+      if (!thread.joinable()) thread = std::thread(&AsyncWorker::run, this);
+      transfer = CPPCRATE_NULLPTR;
+    }
+  }
+
+  if (transfer) {
+    transfer->cancel();
+    delete transfer;
+    return;
+  }
+#ifdef CPPCRATE_HAS_MULTI_WAKEUP
+  curl_multi_wakeup(multi);
+#endif
+}
+
+void AsyncWorker::run() {
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (stopped) return;
+      for (std::size_t i = 0, total = pending.size(); i < total; ++i) {
+        curl_easy_setopt(pending[i]->handle(), CURLOPT_PRIVATE, pending[i]);
+        curl_multi_add_handle(multi, pending[i]->handle());
+        active.insert(pending[i]);
+      }
+      pending.clear();
+    }
+
+    int running = 0;
+    curl_multi_perform(multi, &running);
+
+    // Transfers added again for a further attempt have to be started right away.
+    bool restarted = false;
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+      if (msg->msg != CURLMSG_DONE) continue;
+      CURL* easy = msg->easy_handle;
+      const CURLcode code = msg->data.result;
+      char* data = CPPCRATE_NULLPTR;
+      curl_easy_getinfo(easy, CURLINFO_PRIVATE, &data);
+      Transfer* transfer = reinterpret_cast<Transfer*>(data);
+
+      curl_multi_remove_handle(multi, easy);
+      if (transfer->finish(code)) {
+        curl_multi_add_handle(multi, transfer->handle());
+        restarted = true;
+      } else {
+        active.erase(transfer);
+        delete transfer;
+      }
+    }
+    if (restarted) continue;
+
+#ifdef CPPCRATE_HAS_MULTI_WAKEUP
+    curl_multi_poll(multi, CPPCRATE_NULLPTR, 0, 1000, CPPCRATE_NULLPTR);
+#else
+    // Without curl_multi_wakeup() new transfers are only noticed after the timeout.
+    curl_multi_wait(multi, CPPCRATE_NULLPTR, 0, 10, CPPCRATE_NULLPTR);
+#endif
+  }
+}
+
+ExecTransfer::ExecTransfer(NodeList& nodes, const Query& query, const std::string& defaultSchema,
+                           const Compression& compression, const Callback& callback)
+    : nodes(nodes),
+      query(query),
+      defaultSchema(defaultSchema),
+      callback(callback) {
+  // Without any node the request fails on the empty URL.
+  nodes.next(tries, node);
+  connection.setCompression(compression);
+  if (connection.isValid()) {
+    connection.prepareExec(node, query, defaultSchema);
+    nodes.setNodeStarted(node);
+  }
+}
+
+bool ExecTransfer::isValid() const { return connection.isValid(); }
+
+CURL* ExecTransfer::handle() { return connection.handle(); }
+
+bool ExecTransfer::finish(CURLcode code) {
+  nodes.setNodeFinished(node, connection.responseTime());
+  if (code == CURLE_OK) {
+    nodes.setNodeSuccess(node, tries);
+  } else if (tries.count > 0) {
+    nodes.setNodeError(node);
+    if (nodes.next(tries, node)) {
+      connection.prepareExec(node, query, defaultSchema);
+      nodes.setNodeStarted(node);
+      return true;
+    }
+  }
+  callback(connection.finishExec(code));
+  return false;
+}
+
+void ExecTransfer::cancel() {
+  callback(RawResult(Connection::errorReply("The request was cancelled.", 0, "CppCrate")));
+}
+/// \endcond
+
+}  // namespace CppCrate
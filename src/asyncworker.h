@@ -0,0 +1,97 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+#include <cppcrate/node.h>
+#include <cppcrate/query.h>
+#include <cppcrate/rawresult.h>
+
+#include "connection.h"
+#include "nodelist.h"
+
+#include <curl/curl.h>
+
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+class Transfer {
+ public:
+  virtual ~Transfer() {}
+
+  // Returns the easy handle that performs the transfer.
+  virtual CURL* handle() = 0;
+
+  // Called on the I/O thread once the transfer finished with \a code. Returns \c true if the
+  // transfer was prepared for another attempt and has to be performed again.
+  virtual bool finish(CURLcode code) = 0;
+
+  // Called instead of finish() if the worker shuts down before the transfer finished.
+  virtual void cancel() = 0;
+};
+
+class AsyncWorker {
+ public:
+  AsyncWorker();
+  ~AsyncWorker();
+
+  void submit(Transfer* transfer);
+
+ private:
+  AsyncWorker(const AsyncWorker&);
+  AsyncWorker& operator=(const AsyncWorker&);
+
+  void run();
+
+  CURLM* multi;
+  std::thread thread;
+  std::mutex mutex;
+  std::vector<Transfer*> pending;
+  std::set<Transfer*> active;
+  bool stopped;
+};
+
+class ExecTransfer : public Transfer {
+ public:
+  typedef std::function<void(const RawResult&)> Callback;
+
+  ExecTransfer(NodeList& nodes, const Query& query, const std::string& defaultSchema,
+               const Compression& compression, const Callback& callback);
+
+  bool isValid() const;
+  CURL* handle();
+  bool finish(CURLcode code);
+  void cancel();
+
+ private:
+  NodeList& nodes;
+  Query query;
+  std::string defaultSchema;
+  Callback callback;
+  Connection connection;
+  Node node;
+  NodeList::Tries tries;
+};
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,419 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "blobbatch.h"
+#include "crypto.h"
+#include "filewriter.h"
+#include "global_p.h"
+#include "mappedfile.h"
+#include "nodelist.h"
+#include "pointervector.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+BlobBatch::FileSinks::FileSinks(const std::string& directory) : directory(directory) {}
+
+std::ostream* BlobBatch::FileSinks::open(const std::string& key) {
+  const std::string path = directory.empty() ? key : directory + "/" + key;
+  std::ofstream* file = new std::ofstream(path.c_str(), std::ofstream::binary);
+  if (*file) return file;
+  delete file;
+  return CPPCRATE_NULLPTR;
+}
+
+#ifdef ENABLE_CPP11_SUPPORT
+BlobBatch::FunctionSinks::FunctionSinks(const Open& function) : function(function) {}
+
+std::ostream* BlobBatch::FunctionSinks::open(const std::string& key) {
+  return function(key).release();
+}
+#endif
+
+// Transfers up to \a maxTransfers blobs at the same time. If \a cache is set, downloads are served
+// from it where possible and added to it otherwise.
+BlobBatch::BlobBatch(NodeList& nodes, int maxTransfers, BlobCache* cache)
+    : nodes(nodes),
+      maxTransfers(maxTransfers > 0 ? static_cast<std::size_t>(maxTransfers) : 1),
+      cache(cache) {}
+
+// Uploads \a files. Files are mapped into memory if possible and read as stream otherwise. The keys
+// of all mapped files are computed in one batch.
+std::vector<BlobResult> BlobBatch::upload(const std::string& tableName,
+                                          const std::vector<std::string>& files) {
+  // Limits the number of files opened at the same time.
+  static const std::size_t maxOpenFiles = 256;
+  std::vector<BlobResult> results(files.size());
+  for (std::size_t first = 0, total = files.size(); first < total; first += maxOpenFiles) {
+    const std::size_t last = std::min(total, first + maxOpenFiles);
+    PointerVector<MappedFile> mapped;
+    PointerVector<std::ifstream> streams;
+    std::vector<Item> items;
+    std::vector<Sha1::Buffer> buffers;
+    for (std::size_t i = first; i < last; ++i) {
+      Item item(i);
+      mapped.push_back(new MappedFile(files[i]));
+      if (mapped.back()->isValid()) {
+        item.upload.data = mapped.back()->data();
+        item.upload.size = mapped.back()->size();
+        buffers.push_back(Sha1::Buffer(item.upload.data, item.upload.size));
+        items.push_back(item);
+        continue;
+      }
+
+      streams.push_back(new std::ifstream(files[i].c_str(), std::ifstream::binary));
+      if (!*streams.back()) {
+        results[i] = BlobResult("Could not open file.", BlobResult::OtherErrorType);
+        continue;
+      }
+      item.key = Crypto::sha1(*streams.back());
+      if (item.key.empty()) {
+        results[i] = BlobResult("Could not compute SHA1 key.", BlobResult::OtherErrorType);
+        continue;
+      }
+      item.upload.stream = streams.back();
+      item.upload.size = static_cast<std::size_t>(Crypto::fileSize(*streams.back()));
+      items.push_back(item);
+    }
+
+    const std::vector<std::string> keys = Crypto::sha1Batch(buffers);
+    for (std::size_t i = 0, key = 0, count = items.size(); i < count; ++i) {
+      if (!items[i].upload.stream) items[i].key = keys[key++];
+    }
+    transfer(tableName, items, CPPCRATE_NULLPTR, results);
+  }
+  return results;
+}
+
+// Downloads the blobs \a keys to the streams opened by \a sinks. Cached blobs are not downloaded.
+std::vector<BlobResult> BlobBatch::download(const std::string& tableName,
+                                            const std::vector<std::string>& keys, Sinks& sinks) {
+  std::vector<BlobResult> results(keys.size());
+  std::vector<Item> items;
+  for (std::size_t i = 0, total = keys.size(); i < total; ++i) {
+    if (cache && cache->contains(tableName, keys[i]) &&
+        readCached(tableName, keys[i], sinks, results[i])) {
+      continue;
+    }
+    items.push_back(Item(i));
+    items.back().key = keys[i];
+  }
+  transfer(tableName, items, &sinks, results);
+  return results;
+}
+
+// Writes the cached blob \a key to a stream of \a sinks. Returns \c false if the blob was evicted
+// meanwhile and has to be downloaded.
+bool BlobBatch::readCached(const std::string& tableName, const std::string& key, Sinks& sinks,
+                           BlobResult& r) {
+  r.setKey(key);
+  std::ostream* data = sinks.open(key);
+  if (!data) {
+    r.setErrorString("Could not open the stream.", BlobResult::OtherErrorType);
+    return true;
+  }
+  const BlobCache::ReadResult read = cache->read(tableName, key, *data);
+  delete data;
+  if (read == BlobCache::ReadError) {
+    r.setErrorString("Could not read the cached blob.", BlobResult::OtherErrorType);
+  }
+  return read != BlobCache::NotCached;
+}
+
+// Downloads the blob \a key into \a file in up to maxTransfers byte ranges at the same time. The
+// size is requested first, which also remembers the node owning the blob, so the ranges are sent
+// there directly. If the size is unknown or the server ignores ranges, the blob is downloaded as a
+// whole. A cached blob is copied from the cache instead, but blobs downloaded in ranges are not
+// added to it.
+BlobResult BlobBatch::downloadRanges(const std::string& tableName, const std::string& key,
+                                     const std::string& file) {
+  // Smaller ranges are not worth a request of their own.
+  static const uint64_t minRangeSize = 1024 * 1024;
+
+  BlobResult r("Could not open file.", BlobResult::OtherErrorType);
+  r.setKey(key);
+  if (cache && cache->contains(tableName, key)) {
+    std::ofstream stream(file.c_str(), std::ofstream::binary);
+    if (!stream) return r;
+    const BlobCache::ReadResult read = cache->read(tableName, key, stream);
+    if (read == BlobCache::Read) {
+      r = BlobResult();
+      r.setKey(key);
+    } else if (read == BlobCache::ReadError) {
+      r.setErrorString("Could not read the cached blob.", BlobResult::OtherErrorType);
+    }
+    if (read != BlobCache::NotCached) return r;
+  }
+
+  Connection connection;
+  r.setErrorString("Could not create a curl handle.", BlobResult::OtherErrorType);
+  if (!connection.isValid()) return r;
+  r = connection.existsBlob(nodes, tableName, key);
+  if (!r) {
+    if (r.isCrateError()) {
+      r.setErrorString("Blob with the key '" + key + "' was not found.",
+                       BlobResult::CrateErrorType);
+    }
+    return r;
+  }
+
+  const int64_t size = connection.contentLength();
+  if (size >= 0) {
+    FileWriter writer(file);
+    if (!writer.isValid() || !writer.resize(static_cast<uint64_t>(size))) {
+      r.setErrorString("Could not open file.", BlobResult::OtherErrorType);
+      return r;
+    }
+    if (size == 0) return r;
+
+    const uint64_t count = std::max<uint64_t>(
+        1, std::min<uint64_t>(maxTransfers, static_cast<uint64_t>(size) / minRangeSize));
+    std::vector<BlobRange> ranges(static_cast<std::size_t>(count));
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+      ranges[i].file = &writer;
+      ranges[i].begin = static_cast<uint64_t>(size) * i / count;
+      ranges[i].end = static_cast<uint64_t>(size) * (i + 1) / count;
+    }
+    r = transferRanges(Connection::blobPath(tableName, key), key, ranges);
+
+    bool partial = true;
+    for (std::size_t i = 0; i < ranges.size(); ++i) partial = partial && ranges[i].partial;
+    if (partial) return r;
+  }
+
+  std::ofstream stream(file.c_str(), std::ofstream::binary);
+  if (!stream) {
+    r = BlobResult("Could not open file.", BlobResult::OtherErrorType);
+    r.setKey(key);
+    return r;
+  }
+  return connection.downloadBlob(nodes, tableName, key, stream);
+}
+
+// Downloads \a ranges of the blob \a path at the same time, each on its own connection. A range
+// that failed on all nodes is resumed after its written bytes instead of starting over.
+BlobResult BlobBatch::transferRanges(const std::string& path, const std::string& key,
+                                     std::vector<BlobRange>& ranges) {
+  // Number of times a range is resumed before the download fails.
+  static const int maxResumes = 3;
+
+  BlobResult r;
+  r.setKey(key);
+  CURLM* multi = curl_multi_init();
+  PointerVector<RangeSlot> slots;
+  for (std::size_t i = 0, total = ranges.size(); multi && i < total; ++i) {
+    slots.push_back(new RangeSlot(path, ranges[i]));
+    if (!slots.back()->connection.isValid()) break;
+  }
+
+  std::size_t active = 0;
+  if (slots.size() == ranges.size() && slots.back()->connection.isValid()) {
+    for (std::size_t i = 0, total = slots.size(); i < total; ++i) {
+      if (startRange(multi, *slots[i], r)) ++active;
+    }
+  } else {
+    r.setErrorString("Could not create a curl handle.", BlobResult::OtherErrorType);
+  }
+
+  while (active > 0) {
+    int running = 0;
+    curl_multi_perform(multi, &running);
+
+    bool finished = false;
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+      if (msg->msg != CURLMSG_DONE) continue;
+      CURL* easy = msg->easy_handle;
+      CURLcode code = msg->data.result;
+      char* data = CPPCRATE_NULLPTR;
+      curl_easy_getinfo(easy, CURLINFO_PRIVATE, &data);
+      RangeSlot& slot = *reinterpret_cast<RangeSlot*>(data);
+      curl_multi_remove_handle(multi, easy);
+      finished = true;
+      --active;
+
+      // Only network errors are failed over and resumed, a node that answered is fine.
+      long responseCode = 0;
+      curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &responseCode);
+      const bool answered = responseCode != 0 && responseCode != 206;
+      const bool complete = slot.range.written == slot.range.end - slot.range.begin;
+      if (answered || complete || !slot.range.partial || slot.range.failed) code = CURLE_OK;
+      if (slot.connection.finishBlobAttempt(nodes, slot.request, code)) {
+        slot.connection.prepareDownloadBlob(slot.range);
+        curl_multi_add_handle(multi, easy);
+        ++active;
+        continue;
+      }
+
+      // Without support for ranges the caller downloads the blob as a whole.
+      if (!slot.range.partial || (complete && !slot.range.failed)) continue;
+      if (!answered && !slot.range.failed && slot.resumes++ < maxResumes) {
+        if (startRange(multi, slot, r)) ++active;
+        continue;
+      }
+      if (r.hasError()) continue;
+      if (slot.range.failed) {
+        r.setErrorString("Could not write file.", BlobResult::OtherErrorType);
+      } else if (answered && responseCode != 404) {
+        std::ostringstream error;
+        error << "Downloading the blob with the key '" << key << "' failed with HTTP status "
+              << responseCode << ".";
+        r.setErrorString(error.str(), BlobResult::HttpErrorType);
+      } else {
+        r = slot.connection.finishDownloadBlob(key, slot.request.code);
+      }
+    }
+    if (!finished) curl_multi_wait(multi, CPPCRATE_NULLPTR, 0, 1000, CPPCRATE_NULLPTR);
+  }
+
+  if (multi) curl_multi_cleanup(multi);
+  return r;
+}
+
+// Starts downloading the remaining bytes of the range of \a slot. Sets \a r if no node is left.
+bool BlobBatch::startRange(CURLM* multi, RangeSlot& slot, BlobResult& r) {
+  slot.connection.prepareDownloadBlob(slot.range);
+  curl_easy_setopt(slot.connection.handle(), CURLOPT_PRIVATE, &slot);
+  slot.request = BlobRequest(slot.request.path);
+  if (slot.connection.startBlob(nodes, slot.request)) {
+    curl_multi_add_handle(multi, slot.connection.handle());
+    return true;
+  }
+  if (!r.hasError()) r = slot.connection.finishDownloadBlob(r.key(), slot.request.code);
+  return false;
+}
+
+// Performs up to maxTransfers requests of \a items at the same time on a curl multi handle. Each
+// transfer has its own connection, which is reused for the following items, so keep-alive
+// connections stay warm. Failover and the remembered blob owners work as for a single request.
+void BlobBatch::transfer(const std::string& tableName, std::vector<Item>& items, Sinks* sinks,
+                         std::vector<BlobResult>& results) {
+  if (items.empty()) return;
+
+  CURLM* multi = curl_multi_init();
+  PointerVector<Slot> slots;
+  for (std::size_t i = 0, total = std::min(maxTransfers, items.size()); multi && i < total; ++i) {
+    slots.push_back(new Slot);
+    if (!slots.back()->connection.isValid()) {
+      slots.pop_back();
+      break;
+    }
+  }
+
+  if (slots.empty()) {
+    for (std::size_t i = 0, total = items.size(); i < total; ++i) {
+      results[items[i].index] =
+          BlobResult("Could not create a curl handle.", BlobResult::OtherErrorType);
+      results[items[i].index].setKey(items[i].key);
+    }
+  }
+
+  std::size_t next = 0;
+  std::size_t active = 0;
+  while (!slots.empty()) {
+    for (std::size_t i = 0, total = slots.size(); i < total; ++i) {
+      while (!slots[i]->item && next < items.size()) {
+        if (start(tableName, *slots[i], items[next++], sinks, results)) {
+          curl_multi_add_handle(multi, slots[i]->connection.handle());
+          ++active;
+        }
+      }
+    }
+    if (active == 0) break;
+
+    int running = 0;
+    curl_multi_perform(multi, &running);
+
+    // Finished transfers free their slot or start the next attempt right away.
+    bool finished = false;
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+      if (msg->msg != CURLMSG_DONE) continue;
+      CURL* easy = msg->easy_handle;
+      const CURLcode code = msg->data.result;
+      char* data = CPPCRATE_NULLPTR;
+      curl_easy_getinfo(easy, CURLINFO_PRIVATE, &data);
+      Slot* slot = reinterpret_cast<Slot*>(data);
+
+      curl_multi_remove_handle(multi, easy);
+      if (slot->connection.finishBlobAttempt(nodes, slot->request, code)) {
+        curl_multi_add_handle(multi, easy);
+      } else {
+        finish(*slot, results);
+        --active;
+      }
+      finished = true;
+    }
+    if (!finished) curl_multi_wait(multi, CPPCRATE_NULLPTR, 0, 1000, CPPCRATE_NULLPTR);
+  }
+
+  if (multi) curl_multi_cleanup(multi);
+}
+
+// Prepares the transfer of \a item in \a slot. Returns \c false if the item already failed.
+bool BlobBatch::start(const std::string& tableName, Slot& slot, Item& item, Sinks* sinks,
+                      std::vector<BlobResult>& results) {
+  slot.item = &item;
+  slot.request = BlobRequest(Connection::blobPath(tableName, item.key));
+  if (sinks) {
+    slot.data.reset(sinks->open(item.key));
+    if (!slot.data.get()) {
+      results[item.index] = BlobResult("Could not open the stream.", BlobResult::OtherErrorType);
+      results[item.index].setKey(item.key);
+      slot.item = CPPCRATE_NULLPTR;
+      return false;
+    }
+    std::ostream* data = slot.data.get();
+    if (cache) {
+      slot.cached.reset(new BlobCache::Download(*cache, tableName, item.key, *slot.data));
+      data = &slot.cached->stream();
+    }
+    slot.download = BlobDownload();
+    slot.download.stream = data;
+    slot.connection.prepareDownloadBlob(slot.download);
+    slot.request.download = &slot.download;
+  } else {
+    slot.connection.prepareUploadBlob(item.upload);
+    slot.request.upload = &item.upload;
+  }
+  curl_easy_setopt(slot.connection.handle(), CURLOPT_PRIVATE, &slot);
+
+  if (slot.connection.startBlob(nodes, slot.request)) return true;
+  finish(slot, results);
+  return false;
+}
+
+void BlobBatch::finish(Slot& slot, std::vector<BlobResult>& results) {
+  const Item& item = *slot.item;
+  if (slot.data.get()) {
+    results[item.index] = slot.connection.finishDownloadBlob(item.key, slot.request.code);
+    if (slot.cached.get() && results[item.index]) slot.cached->commit();
+    slot.cached.reset();
+    slot.data.reset();
+  } else {
+    results[item.index] = slot.connection.finishUploadBlob(item.key, slot.request.code);
+  }
+  slot.item = CPPCRATE_NULLPTR;
+}
+/// \endcond
+
+}  // namespace CppCrate
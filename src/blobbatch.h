@@ -0,0 +1,129 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/blobresult.h>
+#include <cppcrate/global.h>
+
+#include "blobcache.h"
+#include "connection.h"
+#include "global_p.h"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef ENABLE_CPP11_SUPPORT
+#include <functional>
+#include <memory>
+#endif
+
+namespace CppCrate {
+
+class NodeList;
+
+/// \cond INTERNAL
+class BlobBatch {
+ public:
+  // Opens the streams blobs are downloaded to. A stream is opened right before its download starts
+  // and deleted once the download finished.
+  class Sinks {
+   public:
+    virtual ~Sinks() {}
+    // Returns the stream for the blob \a key, or a null pointer if it cannot be opened.
+    virtual std::ostream* open(const std::string& key) = 0;
+  };
+
+  // Writes each blob to a file named after its key.
+  class FileSinks : public Sinks {
+   public:
+    explicit FileSinks(const std::string& directory);
+    std::ostream* open(const std::string& key);
+
+   private:
+    std::string directory;
+  };
+
+#ifdef ENABLE_CPP11_SUPPORT
+  class FunctionSinks : public Sinks {
+   public:
+    typedef std::function<std::unique_ptr<std::ostream>(const std::string&)> Open;
+    explicit FunctionSinks(const Open& function);
+    std::ostream* open(const std::string& key);
+
+   private:
+    Open function;
+  };
+#endif
+
+  BlobBatch(NodeList& nodes, int maxTransfers, BlobCache* cache = CPPCRATE_NULLPTR);
+
+  std::vector<BlobResult> upload(const std::string& tableName,
+                                 const std::vector<std::string>& files);
+  std::vector<BlobResult> download(const std::string& tableName,
+                                   const std::vector<std::string>& keys, Sinks& sinks);
+  BlobResult downloadRanges(const std::string& tableName, const std::string& key,
+                            const std::string& file);
+
+ private:
+  struct Item {
+    explicit Item(std::size_t index) : index(index) {}
+    std::size_t index;  // Position of the result.
+    std::string key;
+    BlobUpload upload;
+  };
+
+  struct Slot {
+    Slot() : item(CPPCRATE_NULLPTR), request(std::string()) {}
+    Connection connection;
+    Item* item;
+    BlobRequest request;
+    BlobDownload download;
+    CPPCRATE_UNIQUE_PTR(std::ostream) data;
+    // Writes data to the cache as well, if there is one. Declared after data, so it is destroyed
+    // first.
+    CPPCRATE_UNIQUE_PTR(BlobCache::Download) cached;
+  };
+
+  struct RangeSlot {
+    RangeSlot(const std::string& path, BlobRange& range)
+        : range(range), request(path), resumes(0) {}
+    Connection connection;
+    BlobRange& range;
+    BlobRequest request;
+    int resumes;
+  };
+
+  bool readCached(const std::string& tableName, const std::string& key, Sinks& sinks,
+                  BlobResult& r);
+  void transfer(const std::string& tableName, std::vector<Item>& items, Sinks* sinks,
+                std::vector<BlobResult>& results);
+  bool start(const std::string& tableName, Slot& slot, Item& item, Sinks* sinks,
+             std::vector<BlobResult>& results);
+  void finish(Slot& slot, std::vector<BlobResult>& results);
+  BlobResult transferRanges(const std::string& path, const std::string& key,
+                            std::vector<BlobRange>& ranges);
+  bool startRange(CURLM* multi, RangeSlot& slot, BlobResult& r);
+
+  NodeList& nodes;
+  const std::size_t maxTransfers;
+  BlobCache* cache;
+};
+/// \endcond
+
+}  // namespace CppCrate
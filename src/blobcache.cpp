@@ -0,0 +1,365 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "blobcache.h"
+#include "global_p.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+namespace Internal {
+
+struct CacheFile {
+  std::string name;
+  bool directory;
+  uint64_t size;
+  int64_t modified;
+};
+
+bool isDirectory(const std::string& path) {
+#ifdef _WIN32
+  const DWORD attributes = GetFileAttributesA(path.c_str());
+  return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
+
+bool makeDirectory(const std::string& path) {
+#ifdef _WIN32
+  CreateDirectoryA(path.c_str(), CPPCRATE_NULLPTR);
+#else
+  mkdir(path.c_str(), 0777);
+#endif
+  return isDirectory(path);
+}
+
+std::vector<CacheFile> listDirectory(const std::string& path) {
+  std::vector<CacheFile> files;
+#ifdef _WIN32
+  WIN32_FIND_DATAA data;
+  const HANDLE find = FindFirstFileA((path + "\\*").c_str(), &data);
+  if (find == INVALID_HANDLE_VALUE) return files;
+  do {
+    CacheFile file;
+    file.name = data.cFileName;
+    file.directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    file.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    file.modified = (static_cast<int64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                    data.ftLastWriteTime.dwLowDateTime;
+    if (file.name != "." && file.name != "..") files.push_back(file);
+  } while (FindNextFileA(find, &data));
+  FindClose(find);
+#else
+  DIR* dir = opendir(path.c_str());
+  if (!dir) return files;
+  while (const dirent* entry = readdir(dir)) {
+    CacheFile file;
+    file.name = entry->d_name;
+    struct stat info;
+    if (file.name == "." || file.name == "..") continue;
+    if (stat((path + '/' + file.name).c_str(), &info) != 0) continue;
+    file.directory = S_ISDIR(info.st_mode);
+    file.size = static_cast<uint64_t>(info.st_size);
+    file.modified = static_cast<int64_t>(info.st_mtime);
+    files.push_back(file);
+  }
+  closedir(dir);
+#endif
+  return files;
+}
+
+bool isKey(const std::string& name) {
+  if (name.size() != 40) return false;
+  for (std::size_t i = 0; i < name.size(); ++i) {
+    const char c = name[i];
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return false;
+  }
+  return true;
+}
+
+// Blobs are stored at "<table>/<key>", so table names that could escape the directory are not
+// cached.
+bool isTable(const std::string& name) {
+  return !name.empty() && name != "." && name != ".." &&
+         name.find_first_of("/\\:") == std::string::npos;
+}
+
+bool isTemporary(const std::string& name) {
+  return name.size() > 5 && name.compare(name.size() - 5, 5, ".part") == 0;
+}
+
+bool modifiedBefore(const std::pair<int64_t, CacheFile>& a,
+                    const std::pair<int64_t, CacheFile>& b) {
+  return a.first < b.first;
+}
+
+}  // namespace Internal
+
+// Caches downloaded blobs in \a directory, which is created if needed, and keeps at most \a maxSize
+// bytes there. Blobs already stored in \a directory are picked up, the most recently written ones
+// are kept longest.
+//
+// Since a blob's key is the SHA-1 digest of its content, a cached blob never becomes stale. Only
+// blobs whose content matches their key are cached. The cache may be used from several threads, but
+// a directory must not be shared by several caches at the same time.
+BlobCache::BlobCache(const std::string& directory, uint64_t maxSize)
+    : directory(directory), maxSize(maxSize), valid(false), total(0), downloads(0) {
+  valid = !directory.empty() && Internal::makeDirectory(directory);
+  if (valid) load();
+}
+
+bool BlobCache::isValid() const { return valid; }
+
+// Returns the size of all cached blobs.
+uint64_t BlobCache::size() const {
+  CPPCRATE_LOCK_GUARD(mutex);
+  return total;
+}
+
+// Returns whether the blob \a key of \a tableName is cached and marks it as recently used.
+bool BlobCache::contains(const std::string& tableName, const std::string& key) {
+  if (!accepts(tableName, key)) return false;
+  CPPCRATE_LOCK_GUARD(mutex);
+  std::map<std::string, Entry>::iterator it = entries.find(tableName + '/' + key);
+  if (it == entries.end() || it->second.removed) return false;
+  blobs.splice(blobs.begin(), blobs, it->second.position);
+  return true;
+}
+
+// Writes the cached blob \a key of \a tableName to \a data. Nothing is written if the blob is not
+// cached. The file is read without holding the lock, it is not deleted before the read finished.
+BlobCache::ReadResult BlobCache::read(const std::string& tableName, const std::string& key,
+                                      std::ostream& data) {
+  if (!accepts(tableName, key)) return NotCached;
+  const std::string name = tableName + '/' + key;
+  {
+    CPPCRATE_LOCK_GUARD(mutex);
+    std::map<std::string, Entry>::iterator it = entries.find(name);
+    if (it == entries.end() || it->second.removed) return NotCached;
+    blobs.splice(blobs.begin(), blobs, it->second.position);
+    ++it->second.readers;
+  }
+
+  std::ifstream file((directory + '/' + name).c_str(), std::ifstream::binary);
+  if (!file) {
+    // The file vanished, forget about it.
+    release(name);
+    remove(tableName, key);
+    return NotCached;
+  }
+  std::vector<char> buffer(64 * 1024);
+  while (file && data) {
+    file.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+    data.write(&buffer[0], file.gcount());
+  }
+  const bool complete = file.eof() && data;
+  release(name);
+  return complete ? Read : ReadError;
+}
+
+// Removes the blob \a key of \a tableName from the cache.
+void BlobCache::remove(const std::string& tableName, const std::string& key) {
+  if (!accepts(tableName, key)) return;
+  CPPCRATE_LOCK_GUARD(mutex);
+  std::map<std::string, Entry>::iterator it = entries.find(tableName + '/' + key);
+  if (it != entries.end() && !it->second.removed) erase(it);
+}
+
+// Removes all blobs of the table \a tableName, e.g. after the table was dropped.
+void BlobCache::removeTable(const std::string& tableName) {
+  if (!Internal::isTable(tableName)) return;
+  const std::string prefix = tableName + '/';
+  CPPCRATE_LOCK_GUARD(mutex);
+  std::map<std::string, Entry>::iterator it = entries.lower_bound(prefix);
+  while (it != entries.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+    const std::map<std::string, Entry>::iterator current = it++;
+    if (!current->second.removed) erase(current);
+  }
+}
+
+bool BlobCache::accepts(const std::string& tableName, const std::string& key) {
+  return Internal::isTable(tableName) && Internal::isKey(key);
+}
+
+std::string BlobCache::temporaryPath(const std::string& tableName, const std::string& key) {
+  const std::string table = directory + '/' + tableName;
+  if (!accepts(tableName, key) || !Internal::makeDirectory(table)) return std::string();
+  std::ostringstream path;
+  path << table << '/' << key << '.';
+  {
+    CPPCRATE_LOCK_GUARD(mutex);
+    path << downloads++;
+  }
+  path << ".part";
+  return path.str();
+}
+
+// Moves the downloaded file \a temporary of \a size bytes into the cache as \a name.
+void BlobCache::insert(const std::string& name, const std::string& temporary, uint64_t size) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  // Blobs larger than the cache would only evict everything else. A blob that is still cached, or
+  // that is still read although it was removed, keeps its file.
+  if (size > maxSize || entries.find(name) != entries.end() ||
+      std::rename(temporary.c_str(), (directory + '/' + name).c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return;
+  }
+  blobs.push_front(name);
+  Entry& entry = entries[name];
+  entry.size = size;
+  entry.position = blobs.begin();
+  total += size;
+  evict();
+}
+
+// Finishes a read of \a name and deletes its file if it was removed meanwhile.
+void BlobCache::release(const std::string& name) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  std::map<std::string, Entry>::iterator it = entries.find(name);
+  if (it == entries.end()) return;
+  if (--it->second.readers == 0 && it->second.removed) {
+    std::remove((directory + '/' + name).c_str());
+    entries.erase(it);
+  }
+}
+
+// Removes \a it from the cache. Its file is deleted right away unless it is read at the moment.
+// Expects the lock to be held.
+void BlobCache::erase(std::map<std::string, Entry>::iterator it) {
+  blobs.erase(it->second.position);
+  total -= it->second.size;
+  if (it->second.readers > 0) {
+    it->second.removed = true;
+    return;
+  }
+  std::remove((directory + '/' + it->first).c_str());
+  entries.erase(it);
+}
+
+// Removes the least recently used blobs until the cache fits into its size. Expects the lock to be
+// held.
+void BlobCache::evict() {
+  while (total > maxSize && !blobs.empty()) erase(entries.find(blobs.back()));
+}
+
+// Picks up the blobs stored in the directory. Leftovers of interrupted downloads are deleted.
+void BlobCache::load() {
+  std::vector<std::pair<int64_t, Internal::CacheFile> > found;
+  const std::vector<Internal::CacheFile> tables = Internal::listDirectory(directory);
+  for (std::size_t i = 0; i < tables.size(); ++i) {
+    if (!tables[i].directory || !Internal::isTable(tables[i].name)) continue;
+    const std::string table = directory + '/' + tables[i].name;
+    const std::vector<Internal::CacheFile> files = Internal::listDirectory(table);
+    for (std::size_t j = 0; j < files.size(); ++j) {
+      if (files[j].directory) continue;
+      if (Internal::isTemporary(files[j].name)) {
+        std::remove((table + '/' + files[j].name).c_str());
+      } else if (Internal::isKey(files[j].name)) {
+        Internal::CacheFile file = files[j];
+        file.name = tables[i].name + '/' + file.name;
+        found.push_back(std::make_pair(file.modified, file));
+      }
+    }
+  }
+
+  std::sort(found.begin(), found.end(), Internal::modifiedBefore);
+  for (std::size_t i = 0; i < found.size(); ++i) {
+    blobs.push_front(found[i].second.name);
+    Entry& entry = entries[found[i].second.name];
+    entry.size = found[i].second.size;
+    entry.position = blobs.begin();
+    total += entry.size;
+  }
+  evict();
+}
+
+// Opens a temporary file for the blob \a key of \a tableName. If that fails, the blob is only
+// written to \a data.
+BlobCache::Download::Download(BlobCache& cache, const std::string& tableName,
+                              const std::string& key, std::ostream& data)
+    : cache(cache),
+      name(tableName + '/' + key),
+      key(key),
+      path(cache.temporaryPath(tableName, key)),
+      buffer(data, file),
+      tee(&buffer),
+      committed(false) {
+  if (!path.empty()) file.open(path.c_str(), std::ofstream::binary);
+}
+
+BlobCache::Download::~Download() {
+  if (file.is_open()) file.close();
+  if (!committed && !path.empty()) std::remove(path.c_str());
+}
+
+// Returns the stream the blob is downloaded to.
+std::ostream& BlobCache::Download::stream() { return tee; }
+
+// Caches the downloaded blob if it was written completely and its content matches the key.
+void BlobCache::Download::commit() {
+  if (!file.is_open()) return;
+  file.close();
+  if (file && buffer.sha1.final() == key) {
+    cache.insert(name, path, buffer.written);
+    committed = true;
+  }
+}
+
+BlobCache::Download::Buffer::Buffer(std::ostream& data, std::ostream& file)
+    : written(0), data(data), file(file) {}
+
+int BlobCache::Download::Buffer::overflow(int c) {
+  if (c == traits_type::eof()) return traits_type::not_eof(c);
+  const char ch = traits_type::to_char_type(c);
+  return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+}
+
+// The blob is always written to the stream, a failing cache file only prevents caching it.
+std::streamsize BlobCache::Download::Buffer::xsputn(const char* s, std::streamsize n) {
+  if (!data.write(s, n)) return 0;
+  if (file) file.write(s, n);
+  sha1.update(s, static_cast<std::size_t>(n));
+  written += static_cast<uint64_t>(n);
+  return n;
+}
+
+// Reports the number of bytes written, which is used to tell whether a download has started.
+BlobCache::Download::Buffer::pos_type BlobCache::Download::Buffer::seekoff(
+    off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+  if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out)) {
+    return pos_type(off_type(-1));
+  }
+  return pos_type(static_cast<off_type>(written));
+}
+/// \endcond
+
+}  // namespace CppCrate
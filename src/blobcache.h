@@ -0,0 +1,130 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+
+#include "sha1.h"
+
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <streambuf>
+#include <string>
+
+#ifdef ENABLE_CPP11_SUPPORT
+#include <cstdint>
+#include <mutex>
+#else
+#include <stdint.h>
+#endif
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+class BlobCache {
+ public:
+  // Writes a downloaded blob to its stream and to a temporary file of the cache. Once the download
+  // succeeded, commit() moves the file into the cache if its content matches the key.
+  class Download {
+   public:
+    Download(BlobCache& cache, const std::string& tableName, const std::string& key,
+             std::ostream& data);
+    ~Download();
+
+    std::ostream& stream();
+    void commit();
+
+   private:
+    Download(const Download&);
+    Download& operator=(const Download&);
+
+    class Buffer : public std::streambuf {
+     public:
+      Buffer(std::ostream& data, std::ostream& file);
+      Sha1 sha1;
+      uint64_t written;
+
+     protected:
+      int overflow(int c);
+      std::streamsize xsputn(const char* s, std::streamsize n);
+      pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which);
+
+     private:
+      std::ostream& data;
+      std::ostream& file;
+    };
+
+    BlobCache& cache;
+    const std::string name;
+    const std::string key;
+    std::string path;
+    std::ofstream file;
+    Buffer buffer;
+    std::ostream tee;
+    bool committed;
+  };
+
+  enum ReadResult { NotCached, Read, ReadError };
+
+  BlobCache(const std::string& directory, uint64_t maxSize);
+
+  bool isValid() const;
+  uint64_t size() const;
+
+  bool contains(const std::string& tableName, const std::string& key);
+  ReadResult read(const std::string& tableName, const std::string& key, std::ostream& data);
+  void remove(const std::string& tableName, const std::string& key);
+  void removeTable(const std::string& tableName);
+
+ private:
+  BlobCache(const BlobCache&);
+  BlobCache& operator=(const BlobCache&);
+
+  struct Entry {
+    Entry() : size(0), readers(0), removed(false) {}
+    uint64_t size;
+    int readers;   // Number of reads in progress, the file is not deleted meanwhile.
+    bool removed;  // Whether the file is deleted once the last read finished.
+    std::list<std::string>::iterator position;
+  };
+
+  static bool accepts(const std::string& tableName, const std::string& key);
+  std::string temporaryPath(const std::string& tableName, const std::string& key);
+  void insert(const std::string& name, const std::string& temporary, uint64_t size);
+  void release(const std::string& name);
+  void erase(std::map<std::string, Entry>::iterator it);
+  void evict();
+  void load();
+
+  const std::string directory;  // Blobs are stored as "<directory>/<table>/<key>".
+  const uint64_t maxSize;
+  bool valid;
+  uint64_t total;
+  uint64_t downloads;
+  // Cached blobs by "<table>/<key>", the most recently used one comes first.
+  std::list<std::string> blobs;
+  std::map<std::string, Entry> entries;
+#ifdef ENABLE_CPP11_SUPPORT
+  mutable std::mutex mutex;
+#endif
+};
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cppcrate/bulkresult.h>
+#include "global_p.h"
+
+#include <cppcrate/result.h>
+
+#include <rapidjson/document.h>
+
+#include <algorithm>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::BulkResult
+ *
+ * \brief Holds the outcome of every row of a bulk operation.
+ *
+ * The class %BulkResult holds the row count Crate reported for every row of a bulk operation that
+ * was sent in one or more chunks by BulkWriter. The rows are addressed by their position in the
+ * original bulk arguments, regardless of the chunk they were sent in:
+ * \code
+ * BulkResult result = writer.write(query);
+ * if (!result) {
+ *   std::vector<int> failed = result.failedRows();
+ *   // Retry exactly the failed rows, e.g. query.bulkArgumentBatch().row(failed[i])
+ * }
+ * \endcode
+ *
+ * A row has failed if Crate reported a row count of -2 for it or if the request of its chunk
+ * failed as a whole, e.g. due to a network error. In the latter case errorString() holds the
+ * chunk's error until the rows are set by a successful retry.
+ */
+
+/// \cond INTERNAL
+class BulkResult::Private {
+ public:
+  Private() : failed(0), chunkFailed(0) {}
+
+  bool operator==(const Private &other) const {
+    return rowCounts == other.rowCounts && chunkError() == other.chunkError();
+  }
+
+  void setFailed(std::size_t row, int error = -1) {
+    if (rowCounts[row] != -2) {
+      rowCounts[row] = -2;
+      ++failed;
+    }
+    setChunkError(row, error);
+  }
+
+  void setRowCount(std::size_t row, int64_t count) {
+    if (rowCounts[row] == -2) --failed;
+    rowCounts[row] = count;
+    if (count == -2) ++failed;
+    setChunkError(row, -1);
+  }
+
+  void setChunkError(std::size_t row, int error) {
+    if (rowErrors[row] >= 0) --chunkFailed;
+    rowErrors[row] = error;
+    if (error >= 0) ++chunkFailed;
+    if (chunkFailed == 0) chunkErrors.clear();
+  }
+
+  // Returns the error of the first row whose chunk failed as a whole.
+  std::string chunkError() const {
+    if (chunkFailed == 0) return std::string();
+    for (std::size_t i = 0, total = rowErrors.size(); i < total; ++i) {
+      if (rowErrors[i] >= 0) return chunkErrors[static_cast<std::size_t>(rowErrors[i])];
+    }
+    return std::string();
+  }
+
+  std::vector<int64_t> rowCounts;
+  int failed;
+  // The errors of chunks that failed as a whole and, for every row, the position of its chunk's
+  // error or -1 if the chunk did not fail as a whole.
+  std::vector<std::string> chunkErrors;
+  std::vector<int> rowErrors;
+  int chunkFailed;  // Number of rows with a chunk error.
+};
+/// \endcond
+
+CPPCRATE_PIMPL_IMPLEMENT_ALL(BulkResult)
+
+/*!
+ * Constructs an empty result.
+ */
+BulkResult::BulkResult() : p(new Private) {}
+
+/*!
+ * Constructs a result for \a rows rows. All rows are considered failed until their row count is set
+ * by setChunkResult().
+ */
+BulkResult::BulkResult(int rows) : p(new Private) {
+  if (rows < 0) rows = 0;
+  p->rowCounts.assign(static_cast<std::size_t>(rows), -2);
+  p->rowErrors.assign(static_cast<std::size_t>(rows), -1);
+  p->failed = rows;
+}
+
+/*!
+ * Returns whether all rows succeeded.
+ */
+BulkResult::operator bool() const { return !hasError(); }
+
+/*!
+ * Returns whether at least one row failed.
+ */
+bool BulkResult::hasError() const { return p->failed > 0; }
+
+/*!
+ * Returns the error string. If a chunk failed as a whole its error is returned, otherwise the failed
+ * rows are listed starting from 1 like Result::errorString() does for a single bulk request.
+ */
+std::string BulkResult::errorString() const {
+  const std::string chunkError = p->chunkError();
+  if (!chunkError.empty()) return chunkError;
+  if (p->failed == 0) return std::string();
+
+  std::string error = "[crate] Error in bulk arguments [";
+  for (std::size_t i = 0, total = p->rowCounts.size(), listed = 0; i < total; ++i) {
+    if (p->rowCounts[i] != -2) continue;
+    if (listed++ > 0) error.append(", ");
+    error.append(CPPCRATE_TO_STRING(i + 1));
+  }
+  error.append("].");
+  return error;
+}
+
+/*!
+ * Returns the number of rows.
+ */
+int BulkResult::size() const { return static_cast<int>(p->rowCounts.size()); }
+
+/*!
+ * Returns the row count Crate reported for the row at position \a row, i.e. the number of rows the
+ * statement affected for this row of arguments. Failed rows and invalid positions return -2.
+ */
+int64_t BulkResult::rowCount(int row) const {
+  const std::size_t i = static_cast<std::size_t>(row);
+  if (row < 0 || i >= p->rowCounts.size()) return -2;
+  return p->rowCounts[i];
+}
+
+/*!
+ * Returns whether the row at position \a row failed.
+ */
+bool BulkResult::isFailed(int row) const { return rowCount(row) == -2; }
+
+/*!
+ * Returns the number of failed rows.
+ */
+int BulkResult::failedCount() const { return p->failed; }
+
+/*!
+ * Returns the positions of all failed rows in ascending order.
+ */
+std::vector<int> BulkResult::failedRows() const {
+  std::vector<int> rows;
+  rows.reserve(static_cast<std::size_t>(p->failed));
+  for (std::size_t i = 0, total = p->rowCounts.size(); i < total; ++i) {
+    if (p->rowCounts[i] == -2) rows.push_back(static_cast<int>(i));
+  }
+  return rows;
+}
+
+/*!
+ * Sets the row counts of the \a rows rows starting at \a firstRow from the reply \a raw of a bulk
+ * request that contained exactly these rows. If the request failed as a whole all its rows are
+ * marked as failed. A later result for the same rows, e.g. of a retry, replaces the row counts as
+ * well as the error. Rows outside the result's boundaries are ignored.
+ */
+void BulkResult::setChunkResult(int firstRow, int rows, const RawResult &raw) {
+  const std::size_t first = static_cast<std::size_t>(firstRow < 0 ? 0 : firstRow);
+  const std::size_t total = p->rowCounts.size();
+  const std::size_t end = rows <= 0 ? first : std::min(total, first + static_cast<std::size_t>(rows));
+  if (firstRow < 0 || first >= end) return;
+
+  rapidjson::Document doc;
+  doc.Parse(raw.reply());
+  const bool hasResults =
+      !doc.HasParseError() && doc.IsObject() && !doc.HasMember("error") &&
+      doc.HasMember("results") && doc["results"].IsArray();
+  if (!hasResults) {
+    std::string error = Result(raw).errorString();
+    if (error.empty()) error = "[CppCrate] The reply contains no bulk results.";
+    p->chunkErrors.push_back(error);
+    const int pos = static_cast<int>(p->chunkErrors.size() - 1);
+    for (std::size_t i = first; i < end; ++i) p->setFailed(i, pos);
+    return;
+  }
+
+  const rapidjson::Value &results = doc["results"];
+  for (std::size_t i = first; i < end; ++i) {
+    const rapidjson::SizeType pos = static_cast<rapidjson::SizeType>(i - first);
+    if (pos < results.Size() && results[pos].IsObject() && results[pos].HasMember("rowcount") &&
+        results[pos]["rowcount"].IsInt64()) {
+      p->setRowCount(i, results[pos]["rowcount"].GetInt64());
+    } else {
+      p->setFailed(i);
+    }
+  }
+}
+
+}  // namespace CppCrate
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cppcrate/bulkwriter.h>
+#include "global_p.h"
+
+#include <cppcrate/client.h>
+
+#include <algorithm>
+#include <deque>
+#include <future>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::BulkWriter
+ *
+ * \brief Sends large bulk operations in chunks over several connections at the same time.
+ *
+ * The class %BulkWriter splits the bulk arguments of a query into chunks of chunkSize() rows and
+ * sends up to maxParallelChunks() chunks at the same time. Each chunk uses its own connection of
+ * the client's asynchronous interface. The chunks are only spread over the cluster's nodes with
+ * Client::ConnectToLeastLoadedNode, which picks a node for every request. With the other options
+ * all chunks go to the same node as long as it is reachable.
+ *
+ * The row counts Crate reports for each chunk are mapped back to the rows' positions in the
+ * original query, so the returned BulkResult tells exactly which rows failed:
+ * \code
+ * BulkWriter writer(client, 5000, 8);
+ * BulkResult result = writer.write(Query("INSERT INTO players (id) VALUES (?)", batch));
+ * if (!result) {
+ *   std::cout << result.failedCount() << " rows failed: " << result.errorString() << "\n";
+ * }
+ * \endcode
+ *
+ * \note Since the chunks are independent requests, a failing chunk does not stop the others. The
+ *       writer must not be used after the client was destroyed.
+ */
+
+/// \cond INTERNAL
+class BulkWriter::Private {
+ public:
+  Private(Client &client, int chunkSize, int maxParallelChunks)
+      : client(client), chunkSize(chunkSize), maxParallelChunks(maxParallelChunks) {}
+
+  struct Chunk {
+    int firstRow;
+    int rows;
+    std::future<RawResult> reply;
+  };
+
+  Client &client;
+  int chunkSize;
+  int maxParallelChunks;
+};
+/// \endcond
+
+CPPCRATE_PIMPL_IMPLEMENT_PRIVATE(BulkWriter)
+
+/*!
+ * Constructs a writer that sends the bulk operations via \a client in chunks of \a chunkSize rows
+ * with at most \a maxParallelChunks chunks at the same time.
+ */
+BulkWriter::BulkWriter(Client &client, int chunkSize, int maxParallelChunks)
+    : p(new Private(client, 1, 1)) {
+  setChunkSize(chunkSize);
+  setMaxParallelChunks(maxParallelChunks);
+}
+
+/*!
+ * Returns the maximal number of rows sent in one request.
+ */
+int BulkWriter::chunkSize() const { return p->chunkSize; }
+
+/*!
+ * Sets the maximal number of rows sent in one request to \a rows. Values smaller than 1 are
+ * ignored.
+ */
+void BulkWriter::setChunkSize(int rows) {
+  if (rows > 0) p->chunkSize = rows;
+}
+
+/*!
+ * Returns the maximal number of requests sent at the same time.
+ */
+int BulkWriter::maxParallelChunks() const { return p->maxParallelChunks; }
+
+/*!
+ * Sets the maximal number of requests sent at the same time to \a chunks. Values smaller than 1
+ * are ignored.
+ */
+void BulkWriter::setMaxParallelChunks(int chunks) {
+  if (chunks > 0) p->maxParallelChunks = chunks;
+}
+
+/*!
+ * Executes the bulk operation \a query and returns the outcome of every row. Blocks until all
+ * chunks are finished.
+ *
+ * If \a query has no bulk arguments nothing is sent and an empty result is returned.
+ */
+BulkResult BulkWriter::write(const Query &query) {
+  const RowBatch &batch = query.bulkArgumentBatch();
+  const int rows = batch.size();
+  BulkResult result(rows);
+  std::deque<Private::Chunk> pending;
+  int next = 0;
+  while (next < rows || !pending.empty()) {
+    while (next < rows && static_cast<int>(pending.size()) < p->maxParallelChunks) {
+      Private::Chunk chunk;
+      chunk.firstRow = next;
+      chunk.rows = std::min(p->chunkSize, rows - next);
+      chunk.reply =
+          p->client.execRawAsync(Query(query.statement(), batch.slice(next, chunk.rows)));
+      next += chunk.rows;
+      pending.push_back(std::move(chunk));
+    }
+
+    Private::Chunk &chunk = pending.front();
+    result.setChunkResult(chunk.firstRow, chunk.rows, chunk.reply.get());
+    pending.pop_front();
+  }
+  return result;
+}
+
+}  // namespace CppCrate
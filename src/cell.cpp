@@ -0,0 +1,144 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cppcrate/cell.h>
+#include "global_p.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <limits>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::Cell
+ *
+ * \brief Refers to a single value of a result's reply without converting it into a Value.
+ *
+ * The class %Cell refers to a single value inside the parsed reply of a Result. It does not copy
+ * the value, so reading it with one of the read() functions converts directly from the reply into
+ * the target variable. A cell is only valid as long as the result it was obtained from exists.
+ *
+ * Cells are the building block of Mapping, which fills user defined structs from a result.
+ *
+ * \sa Result::cell()
+ */
+
+/// \cond INTERNAL
+namespace Internal {
+inline const rapidjson::Value *cellValue(const void *json) {
+  return static_cast<const rapidjson::Value *>(json);
+}
+
+template <typename T>
+bool readInteger(const void *json, T &value) {
+  const rapidjson::Value *v = cellValue(json);
+  if (!v || !v->IsInt64()) return false;
+  const int64_t number = v->GetInt64();
+  if (number < static_cast<int64_t>(std::numeric_limits<T>::min()) ||
+      number > static_cast<int64_t>(std::numeric_limits<T>::max())) {
+    return false;
+  }
+  value = static_cast<T>(number);
+  return true;
+}
+
+template <typename T>
+bool readFloatingPoint(const void *json, T &value) {
+  const rapidjson::Value *v = cellValue(json);
+  if (!v || !v->IsNumber()) return false;
+  value = static_cast<T>(v->GetDouble());
+  return true;
+}
+}
+/// \endcond
+
+/*!
+ * Constructs an invalid cell.
+ */
+Cell::Cell() : json(CPPCRATE_NULLPTR) {}
+
+/// \cond INTERNAL
+Cell::Cell(const void *json) : json(json) {}
+/// \endcond
+
+/*!
+ * Returns whether the cell holds a null value or is invalid.
+ */
+bool Cell::isNull() const {
+  const rapidjson::Value *v = Internal::cellValue(json);
+  return !v || v->IsNull();
+}
+
+/*!
+ * Reads a boolean into \a value. If the cell does not hold a boolean \c false is returned and
+ * \a value is left untouched.
+ */
+bool Cell::read(bool &value) const {
+  const rapidjson::Value *v = Internal::cellValue(json);
+  if (!v || !v->IsBool()) return false;
+  value = v->GetBool();
+  return true;
+}
+
+/*!
+ * Reads an integer into \a value. If the cell does not hold an integer or if it does not fit into
+ * \a value \c false is returned and \a value is left untouched.
+ */
+bool Cell::read(int16_t &value) const { return Internal::readInteger(json, value); }
+
+/*!
+ * \overload
+ */
+bool Cell::read(int32_t &value) const { return Internal::readInteger(json, value); }
+
+/*!
+ * \overload
+ */
+bool Cell::read(int64_t &value) const { return Internal::readInteger(json, value); }
+
+/*!
+ * Reads a number into \a value. If the cell does not hold a number \c false is returned and
+ * \a value is left untouched.
+ */
+bool Cell::read(float &value) const { return Internal::readFloatingPoint(json, value); }
+
+/*!
+ * \overload
+ */
+bool Cell::read(double &value) const { return Internal::readFloatingPoint(json, value); }
+
+/*!
+ * Reads a string into \a value. Objects, arrays, numbers and booleans are returned as received by
+ * Crate. If the cell is null or invalid \c false is returned and \a value is left untouched.
+ */
+bool Cell::read(std::string &value) const {
+  const rapidjson::Value *v = Internal::cellValue(json);
+  if (!v || v->IsNull()) return false;
+  if (v->IsString()) {
+    value.assign(v->GetString(), v->GetStringLength());
+  } else {
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    v->Accept(writer);
+    value.assign(sb.GetString(), sb.GetSize());
+  }
+  return true;
+}
+
+}  // namespace CppCrate
@@ -15,20 +15,25 @@
  */
 
 #include <cppcrate/client.h>
+#include "connection.h"
 #include "global_p.h"
+#include "nodelist.h"
+
+#ifdef ENABLE_CPP11_SUPPORT
+#include "asyncworker.h"
+#include "nodediscovery.h"
+#include "rowcursor_p.h"
+#endif
 
 #ifdef ENABLE_BLOB_SUPPORT
+#include <algorithm>
 #include <fstream>
+#include "blobbatch.h"
+#include "blobcache.h"
 #include "crypto.h"
+#include "mappedfile.h"
 #endif
 
-#include <curl/curl.h>
-
-#include <rapidjson/stringbuffer.h>
-#include <rapidjson/writer.h>
-
-#include <algorithm>
-
 namespace CppCrate {
 
 /*!
@@ -52,6 +57,11 @@ namespace CppCrate {
  * Result for more information. In order to avoid defining the used schema all over the place
  * setDefaultSchema() can be used to minimize the typing effort.
  *
+ * With execAsync() and execRawAsync() queries can also be sent asynchronously. This way a single
+ * client can keep many queries in flight at the same time. For result sets that are too large to be
+ * kept in memory use query(), which returns a RowCursor that provides the rows while they are
+ * received, or scan(), which returns a TableScanner that reads a whole table page by page.
+ *
  * \code
  * Client c;
  * c.connect("http://localhost:4200");
@@ -70,6 +80,18 @@ namespace CppCrate {
  * %Client also provides an interface for accessing blob data. See createBlobStorage(),
  * uploadBlob(), existsBlob(), downloadBlob(), deleteBlob(), and removeBlobStorage() for more
  * information.
+ *
+ * Crate redirects blob requests to the node owning the blob. %CppCrate remembers that node for the
+ * most recently used blobs and sends further requests for them there directly, which saves a round
+ * trip. If the remembered node fails, the request falls back to the nodes passed to connect().
+ *
+ * To transfer many blobs use uploadBlobs() and downloadBlobs(). They keep up to
+ * maxBlobTransfers() requests in flight at the same time instead of waiting for each round trip.
+ *
+ * Blobs that are downloaded over and over again can be kept in a local directory set with
+ * setBlobCache(). Since a blob's key is the SHA-1 digest of its content, the content of a cached
+ * blob never becomes stale and downloads are served without contacting the cluster. A blob can
+ * still be deleted, though, so existsBlob() always asks the cluster.
  */
 
 /*!
@@ -78,6 +100,11 @@ namespace CppCrate {
  * Describes how the client handles node failures. %CppCrate's fallback mechanism is only activated
  * on network errors. Error reports issued by Crate are not considered.
  *
+ * Every request tries each node at most once. A node that failed is skipped by all requests for
+ * half a second, doubled with every further failure up to 30 seconds. After that time a single
+ * request probes the node again and a success makes it available to all requests. If every node
+ * is skipped, a request still tries the node whose waiting time ends first.
+ *
  * \var Client::ConnectionOptions Client::ConnectToFirstNodeAlways
  * The client will always use the first node for queries. If a query fails the client will
  * automatically retry to sent the query to the next node and so on.
@@ -89,402 +116,209 @@ namespace CppCrate {
  * \var Client::ConnectionOptions Client::ConnectToRandomNode
  * The client use a random node for new queries. If the query fails the client will automatically
  * retry to sent the query to the next node and so on.
+ *
+ * \var Client::ConnectionOptions Client::ConnectToLeastLoadedNode
+ * The client picks two random nodes for every query and uses the one with the lower load. The load
+ * of a node is its average response time, weighted towards recent requests, multiplied by the
+ * number of its requests in flight plus one. Thus a slow node receives fewer queries long before it
+ * fails, while nodes without recent requests are tried again. If the query fails the client will
+ * automatically retry to sent the query to the next node and so on. Queries sent concurrently by
+ * ClientPool, the asynchronous functions, or cursors are spread over the nodes as well.
  */
 
-/// \cond INTERNAL
-namespace Internal {
-std::size_t writeStringFunction(void* ptr, std::size_t size, std::size_t nmemb, std::string* data) {
-  const std::size_t total = size * nmemb;
-  data->append(static_cast<char*>(ptr), total);
-  return total;
-}
-
-#ifdef ENABLE_BLOB_SUPPORT
-std::size_t writeStreamFunction(void* ptr, std::size_t size, std::size_t nmemb,
-                                std::ostream* data) {
-  const std::size_t total = size * nmemb;
-  data->write(static_cast<char*>(ptr), static_cast<std::streamsize>(total));
-  return total;
-}
-
-std::size_t readFunction(void* ptr, std::size_t size, std::size_t nmemb, std::istream* stream) {
-  const std::streamsize read =
-      stream->readsome(static_cast<char*>(ptr), static_cast<std::streamsize>(size * nmemb));
-  return static_cast<std::size_t>(read);
-}
-#endif
-}
+class BlobCache;
 
+/// \cond INTERNAL
 class Client::Private {
  public:
-  Private() : curl(CPPCRATE_NULLPTR), options(ConnectToFirstNodeAlways), nodePos(0) {}
-  ~Private() { disconnect(); }
-
-  bool connect() {
-    if (curl) {
-      std::vector<Node> tmp = nodes;
-      disconnect();
-      nodes = tmp;
-    }
-    curl = curl_easy_init();
-    if (!curl) return false;
-
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "CppCrate");
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);
-    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 25L);
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, curlError);
-    curl_easy_setopt(curl, CURLOPT_COOKIEFILE, "");
-
-#ifdef CURL_AT_LEAST_VERSION
-#if CURL_AT_LEAST_VERSION(7, 25, 0)
-    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
-#endif
+#ifdef ENABLE_CPP11_SUPPORT
+  Private()
+      : connection(CPPCRATE_NULLPTR),
+        worker(CPPCRATE_NULLPTR),
+        discovery(CPPCRATE_NULLPTR),
+        refreshInterval(0),
+        maxBlobTransfers(8),
+        cache(CPPCRATE_NULLPTR) {}
+#else
+  Private() : connection(CPPCRATE_NULLPTR), maxBlobTransfers(8), cache(CPPCRATE_NULLPTR) {}
 #endif
-
+  ~Private() {
+    disconnect();
 #ifdef ENABLE_BLOB_SUPPORT
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, Internal::readFunction);
-#else
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Internal::writeStringFunction);
+    delete cache;
 #endif
+  }
 
-    return true;
+  bool connect() {
+    disconnect();
+    connection = new Connection;
+    connection->setCompression(compression);
+    if (connection->isValid()) return true;
+    disconnect();
+    return false;
   }
 
   void disconnect() {
-    if (curl) {
-      curl_easy_cleanup(curl);
-      curl = CPPCRATE_NULLPTR;
-    }
-    curlError[0] = '\0';
+#ifdef ENABLE_CPP11_SUPPORT
+    stopDiscovery();
+    delete worker;
+    worker = CPPCRATE_NULLPTR;
+#endif
+    delete connection;
+    connection = CPPCRATE_NULLPTR;
     nodes.clear();
-    nodePos = 0;
   }
 
-  void resetCurl() {
-    curlError[0] = '\0';
-    curl_easy_setopt(curl, CURLOPT_NOBODY, 0L);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, CPPCRATE_NULLPTR);
-    curl_easy_setopt(curl, CURLOPT_UPLOAD, 0L);
-    curl_easy_setopt(curl, CURLOPT_PUT, 0L);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, CPPCRATE_NULLPTR);
-
-#ifdef ENABLE_BLOB_SUPPORT
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CPPCRATE_NULLPTR);
-    curl_easy_setopt(curl, CURLOPT_HTTPGET, 0L);
-#endif
-    curl_easy_setopt(curl, CURLOPT_READDATA, CPPCRATE_NULLPTR);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, CPPCRATE_NULLPTR);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0L);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, CPPCRATE_NULLPTR);
-    curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, 0L);
+  RawResult exec(const Query& query) {
+    if (connection) return connection->exec(nodes, query, defaultSchema);
+    return notConnected();
   }
 
-  void setAuthentication(const Node& node) {
-    if (node.hasHttpAuthenticationInformation()) {
-      curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_ANY);
-      const std::string& user = nodes.front().httpUser();
-      curl_easy_setopt(curl, CURLOPT_USERNAME, user.data());
-      const std::string& password = nodes.front().httpPassword();
-      curl_easy_setopt(curl, CURLOPT_PASSWORD, password.data());
-    } else {
-      curl_easy_setopt(curl, CURLOPT_HTTPAUTH, 0L);
-      curl_easy_setopt(curl, CURLOPT_USERNAME, "");
-      curl_easy_setopt(curl, CURLOPT_PASSWORD, "");
-    }
+  RawResult exec(const PreparedQuery& query, const std::string& args) {
+    if (connection) return connection->exec(nodes, query, args);
+    return notConnected();
   }
 
-  Node getNode() { return nodes[nodePos]; }
-
-  // Returns \c true if untried nodes left.
-  bool setNodeError() {
-    ++nodePos;
-    if (nodePos < nodes.size()) {
-      return true;
-    } else {
-      nodePos = 0;
-      return false;
-    }
+  static RawResult notConnected() {
+    return RawResult(
+        Connection::errorReply("CppCrate::Client is not connected.", 0, "CppCrate"));
   }
 
-  void setNodeSuccess() {
-    if (nodePos == 0) return;
-
-    switch (options) {
-      case ConnectToFirstNodeAlways:
-        break;
-      case ConnectToLastAccessedNode:
 #ifdef ENABLE_CPP11_SUPPORT
-        std::rotate(nodes.begin(), std::next(nodes.begin(), nodePos), nodes.end());
-#else
-        std::rotate(nodes.begin(), nodes.begin() + nodePos, nodes.end());
-#endif
-        break;
-      case ConnectToRandomNode:
-        std::random_shuffle(nodes.begin(), nodes.end());
-        break;
+  void startDiscovery() {
+    stopDiscovery();
+    if (connection && refreshInterval > 0) {
+      discovery = new NodeDiscovery(nodes, seeds, refreshInterval);
     }
+  }
 
-    nodePos = 0;
+  void stopDiscovery() {
+    delete discovery;
+    discovery = CPPCRATE_NULLPTR;
   }
 
-  RawResult exec(const Query& query) {
-    RawResult r;
-    if (curl) {
-      resetCurl();
-
-      curl_slist* curlHeaders = CPPCRATE_NULLPTR;
-      if (!defaultSchema.empty()) {
-        const std::string header = "Default-Schema: " + defaultSchema;
-        curlHeaders = curl_slist_append(curlHeaders, header.data());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, curlHeaders);
-      }
-
-      rapidjson::StringBuffer sb;
-      rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-      writer.StartObject();
-      writer.Key("stmt");
-      writer.String(query.statement());
-      if (query.hasArguments()) {
-        writer.Key("args");
-        const std::string& args = query.arguments();
-        writer.RawValue(args.data(), args.size(), rapidjson::kArrayType);
-      } else if (query.hasBulkArguments()) {
-        writer.Key("bulk_args");
-        const std::vector<std::string>& bulkArgs = query.bulkArguments();
-        std::string arg = "[";
-        for (std::vector<std::string>::const_iterator it = bulkArgs.begin(), end = bulkArgs.end();
-             it != end; ++it) {
-          arg += *it + ",";
-        }
-        arg.replace(arg.size() - 1, 1, "]");
-        writer.RawValue(arg.data(), arg.size(), rapidjson::kArrayType);
-      }
-      writer.EndObject();
-      curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, sb.GetSize());
-      curl_easy_setopt(curl, CURLOPT_POSTFIELDS, sb.GetString());
-
-      std::string reply;
-#ifdef ENABLE_BLOB_SUPPORT
-      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Internal::writeStringFunction);
-#endif
-      curl_easy_setopt(curl, CURLOPT_WRITEDATA, &reply);
-
-      const Node& node = getNode();
-      setAuthentication(node);
-      const std::string& url = node.url("/_sql?types");
-      curl_easy_setopt(curl, CURLOPT_URL, url.data());
-
-      const CURLcode code = curl_easy_perform(curl);
-      curl_slist_free_all(curlHeaders);
-      long responseCode;
-      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
-      r.setHttpStatusCode(static_cast<int>(responseCode));
-
-      if (code == CURLE_OK) {
-        r.setReply(reply);
-        setNodeSuccess();
-      } else {
-        if (setNodeError()) {
-          return exec(query);
-        }
-        rapidjson::StringBuffer sb;
-        rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-        writer.StartObject();
-        writer.Key("error");
-        writer.StartObject();
-        writer.Key("message");
-        writer.String(curlError);
-        writer.Key("code");
-        writer.Int(code);
-        writer.Key("component");
-        writer.String("curl");
-        writer.EndObject();
-        writer.EndObject();
-        r.setReply(std::string(sb.GetString(), sb.GetSize()));
-      }
-    } else {
-      rapidjson::StringBuffer sb;
-      rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-      writer.StartObject();
-      writer.Key("error");
-      writer.StartObject();
-      writer.Key("message");
-      writer.String("");
-      writer.Key("CppCrate::Client is not connected.");
-      writer.Int(0);
-      writer.Key("component");
-      writer.String("CppCrate");
-      writer.EndObject();
-      writer.EndObject();
-      r.setReply(std::string(sb.GetString(), sb.GetSize()));
+  void execAsync(const Query& query, const ExecTransfer::Callback& callback) {
+    if (!connection) {
+      callback(notConnected());
+      return;
     }
-    return r;
+    ExecTransfer* transfer = new ExecTransfer(nodes, query, defaultSchema, compression, callback);
+    if (!transfer->isValid()) {
+      delete transfer;
+      callback(RawResult(Connection::errorReply("Could not create a curl handle.", 0, "curl")));
+      return;
+    }
+    if (!worker) worker = new AsyncWorker;
+    worker->submit(transfer);
   }
+#endif
 
 #ifdef ENABLE_BLOB_SUPPORT
   BlobResult uploadBlob(const std::string& tableName, const std::string& key, std::istream& data) {
-    BlobResult r;
-    r.setKey(key);
-
-    if (curl) {
-      resetCurl();
-      curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-      curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
-      curl_easy_setopt(curl, CURLOPT_PUT, 1L);
-      curl_easy_setopt(curl, CURLOPT_READDATA, &data);
-      curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE,
-                       static_cast<curl_off_t>(Crypto::fileSize(data)));
-
-      const Node& node = getNode();
-      setAuthentication(node);
-      const std::string& url = node.url("/_blobs/" + tableName + "/" + key);
-      curl_easy_setopt(curl, CURLOPT_URL, url.data());
-
-      const CURLcode code = curl_easy_perform(curl);
-      long responseCode;
-      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
-
-      if (code == CURLE_OK) {
-        if (responseCode != 201) {
-          r.setErrorString("Blob with the key '" + key + "' already exists.",
-                           BlobResult::CrateErrorType);
-        }
-        setNodeSuccess();
-      } else {
-        if (setNodeError()) {
-          return uploadBlob(tableName, key, data);
-        }
-        r.setErrorString(curlError, BlobResult::HttpErrorType);
-      }
-    } else {
-      r.setErrorString("Client is not connected.", BlobResult::OtherErrorType);
-    }
+    if (connection) return connection->uploadBlob(nodes, tableName, key, data);
+    return notConnected(key);
+  }
 
-    return r;
+  BlobResult uploadBlob(const std::string& tableName, const std::string& key,
+                        const MappedFile& file) {
+    if (connection) return connection->uploadBlob(nodes, tableName, key, file);
+    return notConnected(key);
   }
 
   BlobResult existsBlob(const std::string& tableName, const std::string& key) {
-    BlobResult r;
-    r.setKey(key);
+    if (connection) return connection->existsBlob(nodes, tableName, key);
+    return notConnected(key);
+  }
 
-    if (curl) {
-      resetCurl();
-      curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
-      curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "HEAD");
-
-      const Node& node = getNode();
-      setAuthentication(node);
-      const std::string& url = node.url("/_blobs/" + tableName + "/" + key);
-      curl_easy_setopt(curl, CURLOPT_URL, url.data());
-
-      const CURLcode code = curl_easy_perform(curl);
-      long responseCode;
-      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
-
-      if (code == CURLE_OK) {
-        if (responseCode != 200) {
-          r.setErrorString("Blob with the key '" + key + "' does not exist.",
-                           BlobResult::CrateErrorType);
-        }
-        setNodeSuccess();
-      } else {
-        if (setNodeError()) {
-          return existsBlob(tableName, key);
-        }
-        r.setErrorString(curlError, BlobResult::HttpErrorType);
-      }
-    } else {
-      r.setErrorString("Client is not connected.", BlobResult::OtherErrorType);
-    }
+  BlobResult deleteBlob(const std::string& tableName, const std::string& key) {
+    if (!connection) return notConnected(key);
+    if (cache) cache->remove(tableName, key);
+    return connection->deleteBlob(nodes, tableName, key);
+  }
 
+  // Reads the blob from the cache if possible. Otherwise it is downloaded and added to the cache.
+  BlobResult downloadBlob(const std::string& tableName, const std::string& key,
+                          std::ostream& data) {
+    if (!connection) return notConnected(key);
+    if (!cache) return connection->downloadBlob(nodes, tableName, key, data);
+
+    const BlobCache::ReadResult read = cache->read(tableName, key, data);
+    if (read == BlobCache::Read) return cached(key);
+    if (read == BlobCache::ReadError) {
+      BlobResult r("Could not read the cached blob.", BlobResult::OtherErrorType);
+      r.setKey(key);
+      return r;
+    }
+    BlobCache::Download download(*cache, tableName, key, data);
+    const BlobResult r = connection->downloadBlob(nodes, tableName, key, download.stream());
+    if (r) download.commit();
     return r;
   }
 
-  BlobResult deleteBlob(const std::string& tableName, const std::string& key) {
-    BlobResult r;
-    r.setKey(key);
+  std::vector<BlobResult> uploadBlobs(const std::string& tableName,
+                                      const std::vector<std::string>& files) {
+    if (connection) return BlobBatch(nodes, maxBlobTransfers).upload(tableName, files);
+    return std::vector<BlobResult>(files.size(), notConnected(std::string()));
+  }
 
-    if (curl) {
-      resetCurl();
-      curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
-      curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-
-      const Node& node = getNode();
-      setAuthentication(node);
-      const std::string& url = node.url("/_blobs/" + tableName + "/" + key);
-      curl_easy_setopt(curl, CURLOPT_URL, url.data());
-
-      const CURLcode code = curl_easy_perform(curl);
-      long responseCode;
-      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
-
-      if (code == CURLE_OK) {
-        if (responseCode != 204) {
-          r.setErrorString("Blob with the key '" + key + "' does not exist.",
-                           BlobResult::CrateErrorType);
-        }
-        setNodeSuccess();
-      } else {
-        if (setNodeError()) {
-          return deleteBlob(tableName, key);
-        }
-        r.setErrorString(curlError, BlobResult::HttpErrorType);
-      }
-    } else {
-      r.setErrorString("Client is not connected.", BlobResult::OtherErrorType);
+  std::vector<BlobResult> downloadBlobs(const std::string& tableName,
+                                        const std::vector<std::string>& keys,
+                                        BlobBatch::Sinks& sinks) {
+    if (connection) {
+      return BlobBatch(nodes, maxBlobTransfers, cache).download(tableName, keys, sinks);
     }
-
-    return r;
+    std::vector<BlobResult> results;
+    for (std::size_t i = 0, total = keys.size(); i < total; ++i) {
+      results.push_back(notConnected(keys[i]));
+    }
+    return results;
   }
 
   BlobResult downloadBlob(const std::string& tableName, const std::string& key,
-                          std::ostream& data) {
+                          const std::string& file, int ranges) {
+    if (connection) return BlobBatch(nodes, ranges, cache).downloadRanges(tableName, key, file);
+    return notConnected(key);
+  }
+
+  bool setBlobCache(const std::string& directory, int64_t maxBytes) {
+    clearBlobCache();
+    if (maxBytes <= 0) return false;
+    cache = new BlobCache(directory, static_cast<uint64_t>(maxBytes));
+    if (cache->isValid()) return true;
+    clearBlobCache();
+    return false;
+  }
+
+  void clearBlobCache() {
+    delete cache;
+    cache = CPPCRATE_NULLPTR;
+  }
+
+  static BlobResult cached(const std::string& key) {
     BlobResult r;
     r.setKey(key);
+    return r;
+  }
 
-    if (curl) {
-      resetCurl();
-      curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
-
-      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Internal::writeStreamFunction);
-      curl_easy_setopt(curl, CURLOPT_WRITEDATA, &data);
-
-      const Node& node = getNode();
-      setAuthentication(node);
-      const std::string& url = node.url("/_blobs/" + tableName + "/" + key);
-      curl_easy_setopt(curl, CURLOPT_URL, url.data());
-
-      const CURLcode code = curl_easy_perform(curl);
-      long responseCode;
-      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
-
-      if (code == CURLE_OK) {
-        if (responseCode == 404) {
-          r.setErrorString("Blob with the key '" + key + "' was not found.",
-                           BlobResult::CrateErrorType);
-        }
-        setNodeSuccess();
-      } else {
-        if (setNodeError()) {
-          return downloadBlob(tableName, key, data);
-        }
-        r.setErrorString(curlError, BlobResult::HttpErrorType);
-      }
-    } else {
-      r.setErrorString("Client is not connected.", BlobResult::OtherErrorType);
-    }
-
+  static BlobResult notConnected(const std::string& key) {
+    BlobResult r("Client is not connected.", BlobResult::OtherErrorType);
+    r.setKey(key);
     return r;
   }
 #endif
 
-  std::vector<Node> nodes;
-  CURL* curl;
-  char curlError[CURL_ERROR_SIZE];
+  NodeList nodes;
+  Connection* connection;
+#ifdef ENABLE_CPP11_SUPPORT
+  AsyncWorker* worker;
+  NodeDiscovery* discovery;
+  std::vector<Node> seeds;
+  int refreshInterval;
+#endif
   std::string defaultSchema;
-  ConnectionOptions options;
-  std::size_t nodePos;
+  Compression compression;
+  int maxBlobTransfers;
+  BlobCache* cache;
 };
 /// \endcond
 
@@ -531,9 +365,13 @@ bool Client::connect(const Node& node) {
  * \see Client::ConnectionOptions
  */
 bool Client::connect(const std::vector<Node>& nodes, ConnectionOptions options) {
-  p->nodes = nodes;
-  p->options = options;
-  return p->connect();
+  if (!p->connect()) return false;
+  p->nodes.setNodes(nodes, options);
+#ifdef ENABLE_CPP11_SUPPORT
+  p->seeds = nodes;
+  p->startDiscovery();
+#endif
+  return true;
 }
 
 /*!
@@ -544,7 +382,7 @@ void Client::disconnect() { p->disconnect(); }
 /*!
  * Returns whether the client is connected.
  */
-bool Client::isConnected() const { return p->curl != CPPCRATE_NULLPTR; }
+bool Client::isConnected() const { return p->connection != CPPCRATE_NULLPTR; }
 
 /*!
  * Returns whether the client is connected.
@@ -574,6 +412,77 @@ void Client::clearDefaultSchema() { p->defaultSchema.clear(); }
  */
 const std::string& Client::defaultSchema() const { return p->defaultSchema; }
 
+/*!
+ * Sets whether gzip or deflate compressed replies are accepted to \a enabled. Crate only compresses
+ * replies if its setting \c http.compression is enabled. Replies are decoded by curl while they are
+ * received, so results are not affected. The default is \c false.
+ *
+ * Compressing pays off for large results sent over slow links, for small results and fast links it
+ * just costs CPU time.
+ */
+void Client::setReplyCompression(bool enabled) {
+  p->compression.replies = enabled;
+  if (p->connection) p->connection->setCompression(p->compression);
+}
+
+/*!
+ * Returns whether compressed replies are accepted.
+ */
+bool Client::replyCompression() const { return p->compression.replies; }
+
+#ifdef ENABLE_COMPRESSION_SUPPORT
+/*!
+ * Sends the bodies of SQL requests with at least \a bytes bytes gzip compressed. A negative value
+ * disables compressing requests, which is the default.
+ *
+ * The body is compressed while it is sent, so it is not held twice in memory. Since its compressed
+ * size is not known in advance, it is sent using chunked transfer encoding. This is mostly useful
+ * for bulk operations: JSON arguments shrink to a fraction of their size, but compressing costs
+ * more time than sending small bodies over a fast link. A threshold of some kilobytes is a
+ * reasonable choice, \c benchmarks/compression_benchmark prints the break-even bandwidth for
+ * typical bodies.
+ *
+ * \note Only available if %CppCrate is built with compression support.
+ */
+void Client::setRequestCompressionThreshold(int bytes) {
+  p->compression.requestThreshold = bytes < 0 ? -1 : bytes;
+  if (p->connection) p->connection->setCompression(p->compression);
+}
+
+/*!
+ * Returns the minimal size of a request body to be sent compressed, or -1 if requests are not
+ * compressed.
+ */
+int Client::requestCompressionThreshold() const { return p->compression.requestThreshold; }
+#endif
+
+#ifdef ENABLE_CPP11_SUPPORT
+/*!
+ * Refreshes the nodes of the Crate cluster every \a milliseconds in the background. A value of zero
+ * or less disables the refresh, which is the default.
+ *
+ * The nodes passed to connect() are only used as seeds: right after connecting and then
+ * periodically the nodes are queried from the table \c sys.nodes (see clusterNodes()). Nodes that
+ * joined the cluster are added, nodes that left it are removed. Nodes that stay keep their position
+ * and their state, so neither ConnectionOptions nor the circuit breaker start from scratch. The
+ * scheme and the HTTP authentication of the discovered nodes are taken from the first seed. If the
+ * cluster cannot be queried, the seeds are added again. The refresh uses its own connection and
+ * does not delay requests.
+ *
+ * \note Only available if %CppCrate is built with C++11 support.
+ */
+void Client::setNodeRefreshInterval(int milliseconds) {
+  p->refreshInterval = milliseconds > 0 ? milliseconds : 0;
+  p->startDiscovery();
+}
+
+/*!
+ * Returns the interval in milliseconds the nodes are refreshed with, or 0 if they are not
+ * refreshed.
+ */
+int Client::nodeRefreshInterval() const { return p->refreshInterval; }
+#endif
+
 /*!
  * Executes the SQL statement \a sql and returns the result.
  */
@@ -594,6 +503,166 @@ RawResult Client::execRaw(const std::string& sql) { return p->exec(Query(sql));
  */
 RawResult Client::execRaw(const Query& query) { return p->exec(query); }
 
+/*!
+ * Returns a prepared query for the SQL statement \a sql. The query is executed in the current
+ * default schema, even if it is changed later.
+ *
+ * Use a prepared query for statements that are executed many times. The statement is serialized
+ * only once, so executing it only needs to append the arguments to the request.
+ *
+ * \see PreparedQuery
+ */
+PreparedQuery Client::prepare(const std::string& sql) const {
+  return PreparedQuery(sql, p->defaultSchema);
+}
+
+/*!
+ * Executes the prepared query \a query with the arguments \a args and returns the result. If
+ * \a query is empty an error is returned without sending a request.
+ *
+ * \pre \a args must be empty or a well-formed JSON array.
+ */
+Result Client::exec(const PreparedQuery& query, const std::string& args) {
+  return Result(p->exec(query, args));
+}
+
+/*!
+ * Executes the prepared query \a query with the arguments \a args and returns the raw result. If
+ * \a query is empty an error is returned without sending a request.
+ *
+ * \pre \a args must be empty or a well-formed JSON array.
+ */
+RawResult Client::execRaw(const PreparedQuery& query, const std::string& args) {
+  return p->exec(query, args);
+}
+
+#ifdef ENABLE_CPP11_SUPPORT
+/*!
+ * Executes the SQL statement \a sql asynchronously and returns a future for the result.
+ *
+ * \see execAsync(const Query&, const std::function<void(const Result&)>&)
+ */
+std::future<Result> Client::execAsync(const std::string& sql) { return execAsync(Query(sql)); }
+
+/*!
+ * Executes the query \a query asynchronously and returns a future for the result.
+ *
+ * \code
+ * std::future<Result> players = client.execAsync("SELECT name FROM players");
+ * std::future<Result> teams = client.execAsync("SELECT name FROM teams");
+ * // Both queries are in flight now.
+ * Result result = players.get();
+ * \endcode
+ *
+ * \see execAsync(const Query&, const std::function<void(const Result&)>&)
+ */
+std::future<Result> Client::execAsync(const Query& query) {
+  std::shared_ptr<std::promise<Result>> promise = std::make_shared<std::promise<Result>>();
+  execAsync(query, [promise](const Result& result) { promise->set_value(result); });
+  return promise->get_future();
+}
+
+/*!
+ * Executes the query \a query asynchronously and calls \a callback with the result.
+ *
+ * All asynchronous requests of a client are driven by a single internal I/O thread that is started
+ * with the first asynchronous request. Thus a single client can keep many queries in flight at the
+ * same time. The fallback mechanism described by Client::ConnectionOptions applies as it does for
+ * exec().
+ *
+ * \a callback is called on the internal I/O thread, so it should return quickly and must not
+ * throw. If the client is not connected, \a callback is called immediately. If the client is
+ * disconnected or destroyed while requests are in flight, these requests are cancelled and their
+ * callbacks receive an error result.
+ *
+ * \note Asynchronous execution is only available if %CppCrate is build with C++11 support.
+ */
+void Client::execAsync(const Query& query, const std::function<void(const Result&)>& callback) {
+  p->execAsync(query, [callback](const RawResult& raw) { callback(Result(raw)); });
+}
+
+/*!
+ * Executes the query \a query asynchronously and returns a future for the raw result.
+ *
+ * \see execAsync(const Query&, const std::function<void(const Result&)>&)
+ */
+std::future<RawResult> Client::execRawAsync(const Query& query) {
+  std::shared_ptr<std::promise<RawResult>> promise = std::make_shared<std::promise<RawResult>>();
+  execRawAsync(query, [promise](const RawResult& result) { promise->set_value(result); });
+  return promise->get_future();
+}
+
+/*!
+ * Executes the query \a query asynchronously and calls \a callback with the raw result.
+ *
+ * \see execAsync(const Query&, const std::function<void(const Result&)>&)
+ */
+void Client::execRawAsync(const Query& query,
+                          const std::function<void(const RawResult&)>& callback) {
+  p->execAsync(query, callback);
+}
+
+/*!
+ * Executes the SQL statement \a sql and returns a cursor for its rows.
+ *
+ * \see query(const Query&, int)
+ */
+RowCursor Client::query(const std::string& sql, int bufferedRows) {
+  return query(Query(sql), bufferedRows);
+}
+
+/*!
+ * Executes the query \a query and returns a cursor that provides the rows while they are received.
+ * At most \a bufferedRows rows are decoded ahead of the caller.
+ *
+ * Use this function instead of exec() for large result sets. Since the reply is never held in
+ * memory completely, the memory usage is bounded by \a bufferedRows regardless of the result set's
+ * size. The fallback mechanism described by Client::ConnectionOptions applies as long as no data
+ * was received.
+ *
+ * \code
+ * RowCursor cursor = client.query("SELECT name FROM players");
+ * while (cursor.next()) {
+ *   std::cout << cursor.record().value("name").asString() << "\n";
+ * }
+ * \endcode
+ *
+ * \note The cursor must not be used after the client was disconnected or destroyed.
+ *
+ * \see RowCursor
+ */
+RowCursor Client::query(const Query& query, int bufferedRows) {
+  if (!p->connection) return RowCursor(Result(p->notConnected()).errorString());
+  RowCursor cursor;
+  cursor.p->start(p->nodes, query, p->defaultSchema, p->compression, bufferedRows);
+  return cursor;
+}
+
+/*!
+ * Returns a scanner that reads \a columns of all rows of \a table in pages of \a pageSize rows
+ * ordered by \a keyColumn. The first page is requested right away and every further page while the
+ * caller processes the previous one.
+ *
+ * Use this function for exporting tables that are too large for a single result. \a keyColumn must
+ * be unique and must be part of \a columns.
+ *
+ * \code
+ * TableScanner scanner = client.scan("players", "id");
+ * while (scanner.next()) {
+ *   std::cout << scanner.page().recordSize() << " rows received\n";
+ * }
+ * \endcode
+ *
+ * \note The scanner must not be used after the client was disconnected or destroyed.
+ *
+ * \see TableScanner
+ */
+TableScanner Client::scan(const std::string& table, const std::string& keyColumn, int pageSize,
+                          const std::string& columns) {
+  return TableScanner(*this, table, keyColumn, pageSize, columns);
+}
+#endif
+
 /*!
  * Refreshes the table \a table and returns if the refresh was successful.
  *
@@ -639,6 +708,52 @@ std::vector<Node> Client::clusterNodes() {
 
 #ifdef ENABLE_BLOB_SUPPORT
 
+/*!
+ * Sets the number of transfers uploadBlobs() and downloadBlobs() keep in flight at the same time
+ * to \a transfers. The default is 8, values less than 1 are treated as 1.
+ *
+ * \see uploadBlobs()
+ */
+void Client::setMaxBlobTransfers(int transfers) { p->maxBlobTransfers = std::max(transfers, 1); }
+
+/*!
+ * Returns the number of transfers uploadBlobs() and downloadBlobs() keep in flight at the same
+ * time.
+ */
+int Client::maxBlobTransfers() const { return p->maxBlobTransfers; }
+
+/*!
+ * Caches downloaded blobs in the directory \a directory, which is created if it does not exist,
+ * and keeps at most \a maxBytes bytes there. Returns \c false and disables the cache if the
+ * directory cannot be used or \a maxBytes is not positive.
+ *
+ * \code
+ * client.setBlobCache("/var/cache/textures", 10LL * 1024 * 1024 * 1024);
+ * client.downloadBlob("blobtable", "93390aa9ed64e1e96149ceb0262f34aa2aedcffc", stream);
+ * \endcode
+ *
+ * downloadBlob() and downloadBlobs() read cached blobs from the directory and add the blobs they
+ * download to it. deleteBlob() and removeBlobStorage() remove the blobs from the cache, but a blob
+ * deleted by another client is still served from the cache until it is evicted. A blob is only
+ * cached if its content matches its key. Once the cache is full, the least recently used blobs are
+ * deleted. Blobs cached earlier in \a directory are used as well, leftovers of interrupted
+ * downloads are deleted.
+ *
+ * \note A directory must not be used by two clients or pools at the same time.
+ *
+ * \see clearBlobCache()
+ */
+bool Client::setBlobCache(const std::string& directory, int64_t maxBytes) {
+  return p->setBlobCache(directory, maxBytes);
+}
+
+/*!
+ * Disables the blob cache. The cached files are kept.
+ *
+ * \see setBlobCache()
+ */
+void Client::clearBlobCache() { p->clearBlobCache(); }
+
 /*!
  * Creates a new blob table named \a tableName. Additionally the number of shards and replications
  * can be defined using \a shards and \a replicas. If \a shards or \a replicas is lesser than 0 it
@@ -696,7 +811,8 @@ RawResult Client::createBlobStorage(const std::string& tableName, const std::str
 
 /*!
  * Drops the blob table named \a tableName and returns the corresponding raw result that can be used
- * to determine if the action was successful.
+ * to determine if the action was successful. If it was, the blobs of the table are removed from the
+ * blob cache as well.
  *
  * \code
  * CppCrate::RawResult r = client.removeBlobStorage("images");
@@ -711,7 +827,9 @@ RawResult Client::createBlobStorage(const std::string& tableName, const std::str
  *
  */
 RawResult Client::removeBlobStorage(const std::string& tableName) {
-  return execRaw(Query("DROP BLOB TABLE " + tableName));
+  const RawResult r = execRaw(Query("DROP BLOB TABLE " + tableName));
+  if (r && p->cache) p->cache->removeTable(tableName);
+  return r;
 }
 
 /*!
@@ -747,13 +865,46 @@ BlobResult Client::uploadBlob(const std::string& tableName, std::istream& data)
  *   std::cout << "Key is " << result.key() << "\n";
  * }
  * \endcode
+ *
+ * The file is mapped into memory, so computing its key and sending it read the data right from the
+ * page cache without further copies. This is considerably faster than uploading a stream, in
+ * particular for large files. Files that cannot be mapped are read as stream.
+ *
+ * \note The file must not be changed during the upload.
  */
 BlobResult Client::uploadBlob(const std::string& tableName, const std::string& file) {
+  const MappedFile mapped(file);
+  if (mapped.isValid()) {
+    return p->uploadBlob(tableName, Crypto::sha1(mapped.data(), mapped.size()), mapped);
+  }
   std::ifstream stream(file.c_str(), std::ifstream::binary);
   return stream ? uploadBlob(tableName, stream)
                 : BlobResult("Could not open file.", BlobResult::OtherErrorType);
 }
 
+/*!
+ * Uploads each file of \a files to the table \a tableName and returns the results in the same
+ * order.
+ *
+ * \code
+ * std::vector<std::string> files;
+ * files.push_back("/path/to/first");
+ * files.push_back("/path/to/second");
+ * std::vector<CppCrate::BlobResult> results = client.uploadBlobs("blobtable", files);
+ * \endcode
+ *
+ * The files are mapped into memory like for uploadBlob() and their keys are computed together,
+ * hashing several files in parallel where the CPU supports it. Up to maxBlobTransfers() uploads
+ * are in flight at the same time, each on its own connection. Thus uploading many small files is
+ * bound by the bandwidth rather than by the round-trip time of each request.
+ *
+ * \note The files must not be changed during the upload.
+ */
+std::vector<BlobResult> Client::uploadBlobs(const std::string& tableName,
+                                         const std::vector<std::string>& files) {
+  return p->uploadBlobs(tableName, files);
+}
+
 /*!
  * Returns whether a blob identified by \a key exists in the table \a tableName.
  *
@@ -806,9 +957,82 @@ BlobResult Client::downloadBlob(const std::string& tableName, const std::string&
                 : BlobResult("Could not open file.", BlobResult::OtherErrorType);
 }
 
+/*!
+ * Downloads the blobs identified by \a keys of the table \a tableName to the directory
+ * \a directory and returns the results in the same order. Each blob is stored in a file named
+ * after its key.
+ *
+ * \code
+ * std::vector<std::string> keys;
+ * keys.push_back("93390aa9ed64e1e96149ceb0262f34aa2aedcffc");
+ * keys.push_back("7c4a8d09ca3762af61e59520943dc26494f8941b");
+ * std::vector<CppCrate::BlobResult> results = client.downloadBlobs("blobtable", keys, "/path/to");
+ * \endcode
+ *
+ * Like uploadBlobs(), up to maxBlobTransfers() downloads are performed at the same time.
+ */
+std::vector<BlobResult> Client::downloadBlobs(const std::string& tableName,
+                                              const std::vector<std::string>& keys,
+                                              const std::string& directory) {
+  BlobBatch::FileSinks sinks(directory);
+  return p->downloadBlobs(tableName, keys, sinks);
+}
+
+#ifdef ENABLE_CPP11_SUPPORT
+/*!
+ * Downloads the blobs identified by \a keys of the table \a tableName and returns the results in
+ * the same order. Right before a download starts, \a open is called with the blob's key and
+ * returns the stream the blob is written to. The stream is destroyed once the download finished.
+ * If \a open returns a null pointer, the blob is skipped and its result is an error.
+ *
+ * \code
+ * client.downloadBlobs("blobtable", keys, [](const std::string& key) {
+ *   return std::unique_ptr<std::ostream>(new std::ofstream("/path/to/" + key + ".jpg"));
+ * });
+ * \endcode
+ *
+ * \note Only available if %CppCrate is built with C++11 support.
+ *
+ * \see downloadBlobs()
+ */
+std::vector<BlobResult> Client::downloadBlobs(
+    const std::string& tableName, const std::vector<std::string>& keys,
+    const std::function<std::unique_ptr<std::ostream>(const std::string&)>& open) {
+  BlobBatch::FunctionSinks sinks(open);
+  return p->downloadBlobs(tableName, keys, sinks);
+}
+#endif
+
+/*!
+ * Downloads the blob identified by \a key of the table \a tableName to the file \a file using up
+ * to \a ranges connections at the same time.
+ *
+ * \code
+ * CppCrate::BlobResult result = client.downloadBlob(
+ *   "blobtable", "93390aa9ed64e1e96149ceb0262f34aa2aedcffc", "/path/to/store/the/blob", 8);
+ * \endcode
+ *
+ * A single connection rarely saturates a fast network for large blobs. Therefore the size of the
+ * blob is requested first and the file is allocated in full. Then the blob is split into \a ranges
+ * byte ranges of at least 1 MiB, which are fetched concurrently with HTTP range requests and
+ * written right to their offsets in the file. A range that fails is resumed after the bytes
+ * already received, so a broken connection does not restart the whole blob. If the server does
+ * not support ranges, the blob is downloaded as a whole.
+ *
+ * With \a ranges less than 2 this is equal to downloadBlob() without ranges. A blob found in the
+ * blob cache is copied from there, but blobs downloaded in ranges are not added to the cache.
+ *
+ * \note If the download fails, \a file may contain parts of the blob.
+ */
+BlobResult Client::downloadBlob(const std::string& tableName, const std::string& key,
+                                const std::string& file, int ranges) {
+  return ranges < 2 ? downloadBlob(tableName, key, file)
+                    : p->downloadBlob(tableName, key, file, ranges);
+}
+
 /*!
  * Deletes the blob identified by \a key of the table \a tableName and returns the action's
- * result.
+ * result. The blob is removed from the blob cache as well.
  */
 BlobResult Client::deleteBlob(const std::string& tableName, const std::string& key) {
   return p->deleteBlob(tableName, key);
@@ -0,0 +1,708 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cppcrate/clientpool.h>
+#include "connection.h"
+#include "global_p.h"
+#include "nodediscovery.h"
+#include "nodelist.h"
+
+#ifdef ENABLE_BLOB_SUPPORT
+#include <algorithm>
+#include <fstream>
+#include "blobbatch.h"
+#include "blobcache.h"
+#include "crypto.h"
+#include "mappedfile.h"
+#endif
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::ClientPool
+ *
+ * \brief Provides a thread-safe interface for accessing Crate using multiple connections.
+ *
+ * A Client owns exactly one connection and therefore must not be used by multiple threads at the
+ * same time. The class %ClientPool offers the same interface as Client but can be shared between
+ * threads. Each request leases a connection from a bounded pool and returns it once the request
+ * is done, so up to maxConnections() requests are in flight at the same time. If all connections
+ * are leased, further requests block until a connection becomes available.
+ *
+ * Connections are created on demand and are kept open afterwards, thus their TCP connections stay
+ * warm. All connections share the nodes defined by connect() including the failover state as
+ * described by Client::ConnectionOptions, as well as the default schema.
+ *
+ * \code
+ * ClientPool pool(16);
+ * pool.connect("http://localhost:4200");
+ * std::vector<std::thread> workers;
+ * for (int i = 0; i < 16; ++i) {
+ *   workers.emplace_back([&pool, i]() {
+ *     pool.exec(Query("INSERT INTO t (id) VALUES (?)", "[" + std::to_string(i) + "]"));
+ *   });
+ * }
+ * for (std::thread& worker : workers) worker.join();
+ * \endcode
+ *
+ * \note %ClientPool is only available if %CppCrate is build with C++11 support.
+ *
+ * \note The pool initializes curl globally, which is not thread-safe. Create the pool before
+ *       spawning the threads that use it.
+ */
+
+/// \cond INTERNAL
+class ClientPool::Private {
+ public:
+  class Lease {
+   public:
+    explicit Lease(Private* pool) : pool(pool), connection(pool->acquire()) {}
+    ~Lease() {
+      if (connection) pool->release(connection);
+    }
+
+    Private* pool;
+    Connection* connection;
+
+   private:
+    Lease(const Lease&);
+    Lease& operator=(const Lease&);
+  };
+
+  explicit Private(int maxConnections)
+      : maxConnections(maxConnections > 0 ? static_cast<std::size_t>(maxConnections) : 1),
+        leased(0),
+        connected(false),
+        refreshInterval(0),
+        maxBlobTransfers(8) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+  }
+
+  ~Private() {
+    disconnect();
+    curl_global_cleanup();
+  }
+
+  bool connect(const std::vector<Node>& newNodes, Client::ConnectionOptions options) {
+    disconnect();
+
+    Connection* connection = new Connection;
+    if (!connection->isValid()) {
+      delete connection;
+      return false;
+    }
+
+    // Declared before the lock, so the previous discovery is stopped after unlocking the mutex.
+    std::unique_ptr<NodeDiscovery> previous;
+    std::lock_guard<std::mutex> lock(mutex);
+    nodes.setNodes(newNodes, options);
+    seeds = newNodes;
+    idle.push_back(connection);
+    connected = true;
+    previous = startDiscovery();
+    return true;
+  }
+
+  void disconnect() {
+    std::unique_ptr<NodeDiscovery> previous;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      previous = std::move(discovery);
+      connected = false;
+      for (std::size_t i = 0, total = idle.size(); i < total; ++i) delete idle[i];
+      idle.clear();
+      available.notify_all();
+    }
+    // Stopping the discovery waits for a running refresh, which must not block the other threads.
+    // The nodes are cleared afterwards, so the refresh cannot add nodes after a disconnect.
+    previous.reset();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!connected) nodes.clear();
+  }
+
+  // Replaces the discovery according to the refresh interval and returns the previous one. Since
+  // stopping it waits for a running refresh, the caller destroys it after unlocking the mutex.
+  std::unique_ptr<NodeDiscovery> startDiscovery() {
+    std::unique_ptr<NodeDiscovery> previous(std::move(discovery));
+    if (connected && refreshInterval > 0) {
+      discovery.reset(new NodeDiscovery(nodes, seeds, refreshInterval));
+    }
+    return previous;
+  }
+
+  // Returns an idle connection, creates a new one if the pool limit allows it or waits until a
+  // leased connection is released. Returns a null pointer if the pool is not connected.
+  Connection* acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (connected) {
+      if (!idle.empty()) {
+        Connection* connection = idle.back();
+        idle.pop_back();
+        connection->setCompression(compression);
+        ++leased;
+        return connection;
+      }
+      if (leased < maxConnections) {
+        Connection* connection = new Connection;
+        if (!connection->isValid()) {
+          delete connection;
+          return CPPCRATE_NULLPTR;
+        }
+        connection->setCompression(compression);
+        ++leased;
+        return connection;
+      }
+      available.wait(lock);
+    }
+    return CPPCRATE_NULLPTR;
+  }
+
+  // Connections released after a disconnect are no longer needed.
+  void release(Connection* connection) {
+    std::lock_guard<std::mutex> lock(mutex);
+    --leased;
+    if (connected && idle.size() + leased < maxConnections) {
+      idle.push_back(connection);
+    } else {
+      delete connection;
+    }
+    available.notify_one();
+  }
+
+  RawResult exec(const Query& query) {
+    Lease lease(this);
+    if (lease.connection) return lease.connection->exec(nodes, query, schema());
+    return RawResult(
+        Connection::errorReply("CppCrate::ClientPool is not connected.", 0, "CppCrate"));
+  }
+
+  RawResult exec(const PreparedQuery& query, const std::string& args) {
+    Lease lease(this);
+    if (lease.connection) return lease.connection->exec(nodes, query, args);
+    return RawResult(
+        Connection::errorReply("CppCrate::ClientPool is not connected.", 0, "CppCrate"));
+  }
+
+  std::string schema() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return defaultSchema;
+  }
+
+#ifdef ENABLE_BLOB_SUPPORT
+  BlobResult uploadBlob(const std::string& tableName, const std::string& key, std::istream& data) {
+    Lease lease(this);
+    if (lease.connection) return lease.connection->uploadBlob(nodes, tableName, key, data);
+    return notConnected(key);
+  }
+
+  BlobResult uploadBlob(const std::string& tableName, const std::string& key,
+                        const MappedFile& file) {
+    Lease lease(this);
+    if (lease.connection) return lease.connection->uploadBlob(nodes, tableName, key, file);
+    return notConnected(key);
+  }
+
+  BlobResult existsBlob(const std::string& tableName, const std::string& key) {
+    Lease lease(this);
+    if (lease.connection) return lease.connection->existsBlob(nodes, tableName, key);
+    return notConnected(key);
+  }
+
+  BlobResult deleteBlob(const std::string& tableName, const std::string& key) {
+    Lease lease(this);
+    if (!lease.connection) return notConnected(key);
+    const std::shared_ptr<BlobCache> cache = blobCache();
+    if (cache) cache->remove(tableName, key);
+    return lease.connection->deleteBlob(nodes, tableName, key);
+  }
+
+  // Reads the blob from the cache if possible, without leasing a connection. Otherwise it is
+  // downloaded and added to the cache.
+  BlobResult downloadBlob(const std::string& tableName, const std::string& key,
+                          std::ostream& data) {
+    const std::shared_ptr<BlobCache> cache = blobCache();
+    if (cache && isConnected()) {
+      const BlobCache::ReadResult read = cache->read(tableName, key, data);
+      if (read == BlobCache::Read) return cached(key);
+      if (read == BlobCache::ReadError) {
+        BlobResult r("Could not read the cached blob.", BlobResult::OtherErrorType);
+        r.setKey(key);
+        return r;
+      }
+    }
+
+    Lease lease(this);
+    if (!lease.connection) return notConnected(key);
+    if (!cache) return lease.connection->downloadBlob(nodes, tableName, key, data);
+    BlobCache::Download download(*cache, tableName, key, data);
+    const BlobResult r = lease.connection->downloadBlob(nodes, tableName, key, download.stream());
+    if (r) download.commit();
+    return r;
+  }
+
+  // The transfers use their own connections, the pool's connections stay available meanwhile.
+  std::vector<BlobResult> uploadBlobs(const std::string& tableName,
+                                      const std::vector<std::string>& files) {
+    if (isConnected()) return BlobBatch(nodes, blobTransfers()).upload(tableName, files);
+    return std::vector<BlobResult>(files.size(), notConnected(std::string()));
+  }
+
+  std::vector<BlobResult> downloadBlobs(const std::string& tableName,
+                                        const std::vector<std::string>& keys,
+                                        BlobBatch::Sinks& sinks) {
+    if (isConnected()) {
+      return BlobBatch(nodes, blobTransfers(), blobCache().get()).download(tableName, keys, sinks);
+    }
+    std::vector<BlobResult> results;
+    for (std::size_t i = 0, total = keys.size(); i < total; ++i) {
+      results.push_back(notConnected(keys[i]));
+    }
+    return results;
+  }
+
+  bool isConnected() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return connected;
+  }
+
+  int blobTransfers() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return maxBlobTransfers;
+  }
+
+  // The cache stays alive while it is used, even if it is replaced meanwhile.
+  std::shared_ptr<BlobCache> blobCache() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cache;
+  }
+
+  BlobResult downloadBlob(const std::string& tableName, const std::string& key,
+                          const std::string& file, int ranges) {
+    if (isConnected()) {
+      const std::shared_ptr<BlobCache> cache = blobCache();
+      return BlobBatch(nodes, ranges, cache.get()).downloadRanges(tableName, key, file);
+    }
+    return notConnected(key);
+  }
+
+  static BlobResult cached(const std::string& key) {
+    BlobResult r;
+    r.setKey(key);
+    return r;
+  }
+
+  static BlobResult notConnected(const std::string& key) {
+    BlobResult r("ClientPool is not connected.", BlobResult::OtherErrorType);
+    r.setKey(key);
+    return r;
+  }
+#endif
+
+  const std::size_t maxConnections;
+  std::size_t leased;
+  bool connected;
+  std::vector<Connection*> idle;
+  NodeList nodes;
+  std::vector<Node> seeds;
+  int refreshInterval;
+  std::unique_ptr<NodeDiscovery> discovery;
+  std::string defaultSchema;
+  Compression compression;
+  int maxBlobTransfers;
+#ifdef ENABLE_BLOB_SUPPORT
+  std::shared_ptr<BlobCache> cache;
+#endif
+  mutable std::mutex mutex;
+  std::condition_variable available;
+};
+/// \endcond
+
+CPPCRATE_PIMPL_IMPLEMENT_PRIVATE(ClientPool)
+
+/*!
+ * Constructs a not connected pool that opens at most \a maxConnections connections at the same
+ * time. If \a maxConnections is lesser than 1, a single connection is used.
+ */
+ClientPool::ClientPool(int maxConnections) : p(new Private(maxConnections)) {}
+
+/*!
+ * Returns the maximal number of connections the pool opens at the same time.
+ */
+int ClientPool::maxConnections() const { return static_cast<int>(p->maxConnections); }
+
+/*!
+ * Returns the number of currently opened connections, either idle or leased.
+ */
+int ClientPool::openConnections() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return static_cast<int>(p->idle.size() + p->leased);
+}
+
+/*!
+ * Connects the pool to the Crate cluster node identified by the URL \a url.
+ *
+ * \see Client::connect()
+ */
+bool ClientPool::connect(const std::string& url) { return connect(Node(url)); }
+
+/*!
+ * Connects the pool to the Crate cluster node \a node.
+ *
+ * \see Client::connect()
+ */
+bool ClientPool::connect(const Node& node) {
+  std::vector<Node> nodes;
+  nodes.emplace_back(node);
+  return connect(nodes);
+}
+
+/*!
+ * Connects the pool to the Crate cluster using the provided Crate cluster nodes \a nodes. Which
+ * node is used is defined by \a options. The node order is shared by all connections of the pool.
+ *
+ * \see Client::ConnectionOptions
+ */
+bool ClientPool::connect(const std::vector<Node>& nodes, Client::ConnectionOptions options) {
+  return p->connect(nodes, options);
+}
+
+/*!
+ * Disconnects the pool from the Crate cluster. Requests that are currently in flight are finished,
+ * requests waiting for a connection fail.
+ */
+void ClientPool::disconnect() { p->disconnect(); }
+
+/*!
+ * Returns whether the pool is connected.
+ */
+bool ClientPool::isConnected() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->connected;
+}
+
+/*!
+ * Returns whether the pool is connected.
+ */
+CppCrate::ClientPool::operator bool() const { return isConnected(); }
+
+/*!
+ * Sets the default schema of all connections to \a schema.
+ *
+ * \see Client::setDefaultSchema()
+ */
+void ClientPool::setDefaultSchema(const std::string& schema) {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  p->defaultSchema = schema;
+}
+
+/*!
+ * Resets the default schema.
+ */
+void ClientPool::clearDefaultSchema() {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  p->defaultSchema.clear();
+}
+
+/*!
+ * Returns the default schema.
+ */
+std::string ClientPool::defaultSchema() const { return p->schema(); }
+
+/*!
+ * Sets whether all connections accept compressed replies to \a enabled. Connections that are
+ * currently leased apply the setting with their next request.
+ *
+ * \see Client::setReplyCompression()
+ */
+void ClientPool::setReplyCompression(bool enabled) {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  p->compression.replies = enabled;
+}
+
+/*!
+ * Returns whether compressed replies are accepted.
+ */
+bool ClientPool::replyCompression() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->compression.replies;
+}
+
+#ifdef ENABLE_COMPRESSION_SUPPORT
+/*!
+ * Sends the bodies of SQL requests with at least \a bytes bytes gzip compressed. A negative value
+ * disables compressing requests, which is the default.
+ *
+ * \see Client::setRequestCompressionThreshold()
+ */
+void ClientPool::setRequestCompressionThreshold(int bytes) {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  p->compression.requestThreshold = bytes < 0 ? -1 : bytes;
+}
+
+/*!
+ * Returns the minimal size of a request body to be sent compressed, or -1 if requests are not
+ * compressed.
+ */
+int ClientPool::requestCompressionThreshold() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->compression.requestThreshold;
+}
+#endif
+
+/*!
+ * Refreshes the nodes of the Crate cluster every \a milliseconds in the background. A value of zero
+ * or less disables the refresh, which is the default.
+ *
+ * \see Client::setNodeRefreshInterval()
+ */
+void ClientPool::setNodeRefreshInterval(int milliseconds) {
+  // Declared before the lock, so the previous discovery is stopped after unlocking the mutex.
+  std::unique_ptr<NodeDiscovery> previous;
+  std::lock_guard<std::mutex> lock(p->mutex);
+  p->refreshInterval = milliseconds > 0 ? milliseconds : 0;
+  previous = p->startDiscovery();
+}
+
+/*!
+ * Returns the interval in milliseconds the nodes are refreshed with, or 0 if they are not
+ * refreshed.
+ */
+int ClientPool::nodeRefreshInterval() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->refreshInterval;
+}
+
+/*!
+ * Executes the SQL statement \a sql and returns the result.
+ */
+Result ClientPool::exec(const std::string& sql) { return Result(p->exec(Query(sql))); }
+
+/*!
+ * Executes the query \a query and returns the result.
+ */
+Result ClientPool::exec(const Query& query) { return Result(p->exec(query)); }
+
+/*!
+ * Executes the SQL statement \a sql and returns the raw result.
+ */
+RawResult ClientPool::execRaw(const std::string& sql) { return p->exec(Query(sql)); }
+
+/*!
+ * Executes the query \a query and returns the raw result.
+ */
+RawResult ClientPool::execRaw(const Query& query) { return p->exec(query); }
+
+/*!
+ * Returns a prepared query for the SQL statement \a sql that is executed in the current default
+ * schema.
+ *
+ * \see Client::prepare()
+ */
+PreparedQuery ClientPool::prepare(const std::string& sql) const {
+  return PreparedQuery(sql, p->schema());
+}
+
+/*!
+ * Executes the prepared query \a query with the arguments \a args and returns the result.
+ *
+ * \see Client::exec(const PreparedQuery&, const std::string&)
+ */
+Result ClientPool::exec(const PreparedQuery& query, const std::string& args) {
+  return Result(p->exec(query, args));
+}
+
+/*!
+ * Executes the prepared query \a query with the arguments \a args and returns the raw result.
+ *
+ * \see Client::execRaw(const PreparedQuery&, const std::string&)
+ */
+RawResult ClientPool::execRaw(const PreparedQuery& query, const std::string& args) {
+  return p->exec(query, args);
+}
+
+#ifdef ENABLE_BLOB_SUPPORT
+
+/*!
+ * Sets the number of transfers uploadBlobs() and downloadBlobs() keep in flight at the same time
+ * to \a transfers. These transfers do not count against maxConnections().
+ *
+ * \see Client::setMaxBlobTransfers()
+ */
+void ClientPool::setMaxBlobTransfers(int transfers) {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  p->maxBlobTransfers = std::max(transfers, 1);
+}
+
+/*!
+ * Returns the number of transfers uploadBlobs() and downloadBlobs() keep in flight at the same
+ * time.
+ */
+int ClientPool::maxBlobTransfers() const { return p->blobTransfers(); }
+
+/*!
+ * Caches downloaded blobs in the directory \a directory and keeps at most \a maxBytes bytes there.
+ * Returns \c false and disables the cache if the directory cannot be used or \a maxBytes is not
+ * positive. Cached blobs are read by several threads at the same time and without leasing a
+ * connection.
+ *
+ * \see Client::setBlobCache()
+ */
+bool ClientPool::setBlobCache(const std::string& directory, int64_t maxBytes) {
+  std::shared_ptr<BlobCache> cache;
+  if (maxBytes > 0) {
+    cache = std::make_shared<BlobCache>(directory, static_cast<uint64_t>(maxBytes));
+    if (!cache->isValid()) cache.reset();
+  }
+  std::lock_guard<std::mutex> lock(p->mutex);
+  p->cache = cache;
+  return static_cast<bool>(cache);
+}
+
+/*!
+ * Disables the blob cache. The cached files are kept.
+ */
+void ClientPool::clearBlobCache() {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  p->cache.reset();
+}
+
+/*!
+ * Uploads \a data to the table \a tableName.
+ *
+ * \see Client::uploadBlob()
+ */
+BlobResult ClientPool::uploadBlob(const std::string& tableName, std::istream& data) {
+  const std::string key = Crypto::sha1(data);
+  return key.empty() ? BlobResult("Could not compute SHA1 key.", BlobResult::OtherErrorType)
+                     : p->uploadBlob(tableName, key, data);
+}
+
+/*!
+ * Uploads the file \a file to the table \a tableName.
+ *
+ * \see Client::uploadBlob()
+ */
+BlobResult ClientPool::uploadBlob(const std::string& tableName, const std::string& file) {
+  const MappedFile mapped(file);
+  if (mapped.isValid()) {
+    return p->uploadBlob(tableName, Crypto::sha1(mapped.data(), mapped.size()), mapped);
+  }
+  std::ifstream stream(file.c_str(), std::ifstream::binary);
+  return stream ? uploadBlob(tableName, stream)
+                : BlobResult("Could not open file.", BlobResult::OtherErrorType);
+}
+
+/*!
+ * Uploads each file of \a files to the table \a tableName.
+ *
+ * \see Client::uploadBlobs()
+ */
+std::vector<BlobResult> ClientPool::uploadBlobs(const std::string& tableName,
+                                             const std::vector<std::string>& files) {
+  return p->uploadBlobs(tableName, files);
+}
+
+/*!
+ * Returns whether a blob identified by \a key exists in the table \a tableName.
+ *
+ * \see Client::existsBlob()
+ */
+BlobResult ClientPool::existsBlob(const std::string& tableName, const std::string& key) {
+  return p->existsBlob(tableName, key);
+}
+
+/*!
+ * Downloads the blob identified by \a key of the table \a tableName and stores it to \a data.
+ *
+ * \see Client::downloadBlob()
+ */
+BlobResult ClientPool::downloadBlob(const std::string& tableName, const std::string& key,
+                                    std::ostream& data) {
+  return p->downloadBlob(tableName, key, data);
+}
+
+/*!
+ * Downloads the blob identified by \a key of the table \a tableName and stores it to the file
+ * \a file.
+ *
+ * \see Client::downloadBlob()
+ */
+BlobResult ClientPool::downloadBlob(const std::string& tableName, const std::string& key,
+                                    const std::string& file) {
+  std::ofstream stream(file.c_str(), std::ifstream::binary);
+  return stream ? downloadBlob(tableName, key, stream)
+                : BlobResult("Could not open file.", BlobResult::OtherErrorType);
+}
+
+/*!
+ * Downloads the blob identified by \a key of the table \a tableName to the file \a file using up
+ * to \a ranges connections at the same time.
+ *
+ * The download does not lease connections from the pool but opens its own: one to request the
+ * size of the blob and up to \a ranges for the byte ranges. They neither count against nor wait
+ * for maxConnections(), so concurrent downloads can open more connections to the cluster than
+ * maxConnections(). The connections are closed once the download finished.
+ *
+ * \see Client::downloadBlob()
+ */
+BlobResult ClientPool::downloadBlob(const std::string& tableName, const std::string& key,
+                                    const std::string& file, int ranges) {
+  return ranges < 2 ? downloadBlob(tableName, key, file)
+                    : p->downloadBlob(tableName, key, file, ranges);
+}
+
+/*!
+ * Downloads the blobs identified by \a keys of the table \a tableName to the directory
+ * \a directory.
+ *
+ * \see Client::downloadBlobs()
+ */
+std::vector<BlobResult> ClientPool::downloadBlobs(const std::string& tableName,
+                                                  const std::vector<std::string>& keys,
+                                                  const std::string& directory) {
+  BlobBatch::FileSinks sinks(directory);
+  return p->downloadBlobs(tableName, keys, sinks);
+}
+
+/*!
+ * Downloads the blobs identified by \a keys of the table \a tableName to the streams returned by
+ * \a open.
+ *
+ * \see Client::downloadBlobs()
+ */
+std::vector<BlobResult> ClientPool::downloadBlobs(
+    const std::string& tableName, const std::vector<std::string>& keys,
+    const std::function<std::unique_ptr<std::ostream>(const std::string&)>& open) {
+  BlobBatch::FunctionSinks sinks(open);
+  return p->downloadBlobs(tableName, keys, sinks);
+}
+
+/*!
+ * Deletes the blob identified by \a key of the table \a tableName and returns the action's
+ * result. The blob is removed from the blob cache as well.
+ */
+BlobResult ClientPool::deleteBlob(const std::string& tableName, const std::string& key) {
+  return p->deleteBlob(tableName, key);
+}
+
+#endif
+
+}  // namespace CppCrate
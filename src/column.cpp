@@ -0,0 +1,264 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cppcrate/column.h>
+#include "column_p.h"
+#include "global_p.h"
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::Column
+ *
+ * \brief Holds all values of a single column of a result in contiguous arrays.
+ *
+ * The class %Column provides column-oriented access to a Result. In contrast to Record, which holds
+ * the values of a single row, a column holds the values of all rows of one column. The values are
+ * stored in a single contiguous array whose element type is defined by the column's type, so that
+ * scanning a column is cache-friendly and can be vectorized by the compiler:
+ * \code
+ * Column score = result.column("score");
+ * const std::vector<double>& values = score.doubles();
+ * double sum = 0.0;
+ * for (std::size_t i = 0, total = values.size(); i < total; ++i) sum += values[i];
+ * \endcode
+ *
+ * The storage type is derived from the column's Crate data type:
+ *
+ * | %CrateDataType::Type             | %Column::Type | Storage                            |
+ * | -------------------------------- | ------------- | ---------------------------------- |
+ * | Boolean                          | BoolType      | bools(), 0 or 1                    |
+ * | Byte, Short, Integer, Long       | Int64Type     | int64s()                           |
+ * | Timestamp                        | Int64Type     | int64s()                           |
+ * | Double, Float                    | DoubleType    | doubles()                          |
+ * | String, Ip                       | StringType    | stringData() and stringOffsets()   |
+ * | all others                       | StringType    | as received by Crate               |
+ *
+ * Strings are concatenated in stringData(). The string of row \c i starts at
+ * <tt>stringOffsets()[i]</tt> and ends at <tt>stringOffsets()[i + 1]</tt>.
+ *
+ * \section sec_class_column_nulls Null values
+ *
+ * Null values and values that do not match the column's storage type are marked in nullBitmap() and
+ * hold a default value in the storage array. Bit <tt>i % 8</tt> of byte <tt>i / 8</tt> is set if
+ * row \c i is null. Use isNull() to check a single row or nullCount() to skip the check for columns
+ * without any null value.
+ */
+
+/*!
+ * \enum Column::Type
+ * Describes the %Column's storage type.
+ *
+ * \var Column::Type Column::InvalidType
+ * An invalid column.
+ *
+ * \var Column::Type Column::BoolType
+ * The values are stored in bools().
+ *
+ * \var Column::Type Column::Int64Type
+ * The values are stored in int64s().
+ *
+ * \var Column::Type Column::DoubleType
+ * The values are stored in doubles().
+ *
+ * \var Column::Type Column::StringType
+ * The values are stored in stringData() and stringOffsets().
+ */
+
+/// \cond INTERNAL
+namespace Internal {
+Column::Type columnType(CrateDataType::Type type) {
+  switch (type) {
+    case CrateDataType::Boolean:
+      return Column::BoolType;
+    case CrateDataType::Byte:
+    case CrateDataType::Short:
+    case CrateDataType::Integer:
+    case CrateDataType::Long:
+    case CrateDataType::Timestamp:
+      return Column::Int64Type;
+    case CrateDataType::Double:
+    case CrateDataType::Float:
+      return Column::DoubleType;
+    default:
+      return Column::StringType;
+  }
+}
+}
+
+// Decodes the value at \a index of every row in \a rows.
+Column Column::Private::decode(const rapidjson::Value* rows, std::size_t index,
+                               const std::string& name, const CrateDataType& crateType) {
+  ColumnData* d = new ColumnData;
+  Column column;
+  column.p->data = SharedDataPointer<ColumnData>(d);
+
+  d->name = name;
+  d->crateType = crateType;
+  d->type = Internal::columnType(crateType.type());
+  d->size = rows && rows->IsArray() ? rows->Size() : 0;
+  d->nulls.assign((d->size + 7) / 8, 0);
+
+  switch (d->type) {
+    case BoolType:
+      d->bools.resize(d->size, 0);
+      break;
+    case Int64Type:
+      d->int64s.resize(d->size, 0);
+      break;
+    case DoubleType:
+      d->doubles.resize(d->size, 0.0);
+      break;
+    default:
+      d->stringOffsets.reserve(d->size + 1);
+      d->stringOffsets.push_back(0);
+      break;
+  }
+
+  const rapidjson::SizeType pos = static_cast<rapidjson::SizeType>(index);
+  for (rapidjson::SizeType i = 0, total = static_cast<rapidjson::SizeType>(d->size); i < total;
+       ++i) {
+    const rapidjson::Value& row = (*rows)[i];
+    const rapidjson::Value* v = row.IsArray() && pos < row.Size() ? &row[pos] : CPPCRATE_NULLPTR;
+
+    bool valid = v && !v->IsNull();
+    if (valid) {
+      switch (d->type) {
+        case BoolType:
+          valid = v->IsBool();
+          if (valid) d->bools[i] = v->GetBool() ? 1 : 0;
+          break;
+        case Int64Type:
+          valid = v->IsInt64();
+          if (valid) d->int64s[i] = v->GetInt64();
+          break;
+        case DoubleType:
+          valid = v->IsNumber();
+          if (valid) d->doubles[i] = v->GetDouble();
+          break;
+        default:
+          if (v->IsString()) {
+            d->stringData.append(v->GetString(), v->GetStringLength());
+          } else {
+            rapidjson::StringBuffer sb;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+            v->Accept(writer);
+            d->stringData.append(sb.GetString(), sb.GetSize());
+          }
+          break;
+      }
+    }
+
+    if (d->type == StringType) d->stringOffsets.push_back(d->stringData.size());
+    if (!valid) {
+      d->nulls[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+      ++d->nullCount;
+    }
+  }
+
+  return column;
+}
+/// \endcond
+
+CPPCRATE_PIMPL_IMPLEMENT_ALL(Column)
+
+/*!
+ * Constructs an invalid column without any values.
+ */
+Column::Column() : p(new Private) {}
+
+/*!
+ * Returns the column's name.
+ */
+const std::string& Column::name() const { return p->data->name; }
+
+/*!
+ * Returns the column's data type inside Crate.
+ */
+const CrateDataType& Column::crateType() const { return p->data->crateType; }
+
+/*!
+ * Returns the column's storage type.
+ */
+Column::Type Column::type() const { return p->data->type; }
+
+/*!
+ * Returns the number of rows.
+ */
+int Column::size() const { return static_cast<int>(p->data->size); }
+
+/*!
+ * Returns whether the value of \a row is null. Returns \c true if \a row is out of range.
+ */
+bool Column::isNull(int row) const {
+  const std::size_t i = static_cast<std::size_t>(row);
+  if (row < 0 || i >= p->data->size) return true;
+  return (p->data->nulls[i / 8] & (1u << (i % 8))) != 0;
+}
+
+/*!
+ * Returns the number of null values.
+ */
+int Column::nullCount() const { return static_cast<int>(p->data->nullCount); }
+
+/*!
+ * Returns the null bitmap. Bit <tt>i % 8</tt> of byte <tt>i / 8</tt> is set if row \c i is null.
+ */
+const std::vector<uint8_t>& Column::nullBitmap() const { return p->data->nulls; }
+
+/*!
+ * Returns the values of a column of the type BoolType, otherwise an empty vector.
+ */
+const std::vector<uint8_t>& Column::bools() const { return p->data->bools; }
+
+/*!
+ * Returns the values of a column of the type Int64Type, otherwise an empty vector.
+ */
+const std::vector<int64_t>& Column::int64s() const { return p->data->int64s; }
+
+/*!
+ * Returns the values of a column of the type DoubleType, otherwise an empty vector.
+ */
+const std::vector<double>& Column::doubles() const { return p->data->doubles; }
+
+/*!
+ * Returns the concatenated strings of a column of the type StringType, otherwise an empty string.
+ *
+ * \sa stringOffsets()
+ */
+const std::string& Column::stringData() const { return p->data->stringData; }
+
+/*!
+ * Returns the offsets of the strings inside stringData() of a column of the type StringType,
+ * otherwise an empty vector. The vector holds size() + 1 offsets.
+ */
+const std::vector<std::size_t>& Column::stringOffsets() const { return p->data->stringOffsets; }
+
+/*!
+ * Returns the string of \a row of a column of the type StringType. Returns an empty string if
+ * the column has another type or \a row is out of range.
+ */
+std::string Column::string(int row) const {
+  const std::vector<std::size_t>& offsets = p->data->stringOffsets;
+  const std::size_t i = static_cast<std::size_t>(row);
+  if (row < 0 || i + 1 >= offsets.size()) return std::string();
+  return p->data->stringData.substr(offsets[i], offsets[i + 1] - offsets[i]);
+}
+
+}  // namespace CppCrate
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/column.h>
+
+#include "shareddata.h"
+
+#include <rapidjson/document.h>
+
+#include <string>
+#include <vector>
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+// The decoded values of a column. Copies of a column share them.
+class ColumnData : public SharedData {
+ public:
+  ColumnData() : type(Column::InvalidType), size(0), nullCount(0) {}
+
+  bool operator==(const ColumnData& other) const {
+    return name == other.name && crateType == other.crateType && type == other.type &&
+           size == other.size && nulls == other.nulls && bools == other.bools &&
+           int64s == other.int64s && doubles == other.doubles && stringData == other.stringData &&
+           stringOffsets == other.stringOffsets;
+  }
+
+  std::string name;
+  CrateDataType crateType;
+  Column::Type type;
+  std::size_t size;
+  std::size_t nullCount;
+  std::vector<uint8_t> nulls;
+  std::vector<uint8_t> bools;
+  std::vector<int64_t> int64s;
+  std::vector<double> doubles;
+  std::string stringData;
+  std::vector<std::size_t> stringOffsets;
+};
+
+class Column::Private {
+ public:
+  Private() : data(new ColumnData) {}
+
+  bool operator==(const Private& other) const {
+    return data.data() == other.data.data() || *data == *other.data;
+  }
+
+  static Column decode(const rapidjson::Value* rows, std::size_t index, const std::string& name,
+                       const CrateDataType& crateType);
+
+  SharedDataPointer<ColumnData> data;
+};
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compression.h"
+#include "global_p.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+#ifdef ENABLE_COMPRESSION_SUPPORT
+GzipReader::GzipReader(int level)
+    : valid(false),
+      finished(true),
+      error(false),
+      data(CPPCRATE_NULLPTR),
+      size(0),
+      consumed(0) {
+  stream.zalloc = Z_NULL;
+  stream.zfree = Z_NULL;
+  stream.opaque = Z_NULL;
+  // A window of 15 bits plus 16 selects the gzip format instead of a zlib stream.
+  valid = deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+GzipReader::~GzipReader() {
+  if (valid) deflateEnd(&stream);
+}
+
+bool GzipReader::isValid() const { return valid; }
+
+bool GzipReader::hasError() const { return error; }
+
+// Starts compressing \a size bytes of \a data, which have to stay valid until everything was read.
+void GzipReader::reset(const char* data, std::size_t size) {
+  this->data = data;
+  this->size = size;
+  rewind();
+}
+
+// Starts over with the data passed to reset().
+bool GzipReader::rewind() {
+  consumed = 0;
+  error = !valid || deflateReset(&stream) != Z_OK;
+  finished = error;
+  stream.next_in = Z_NULL;
+  stream.avail_in = 0;
+  return !error;
+}
+
+// Writes up to \a size compressed bytes to \a buffer and returns their number. Returns 0 once the
+// whole gzip stream was read or an error occurred.
+std::size_t GzipReader::read(char* buffer, std::size_t size) {
+  if (finished || size == 0) return 0;
+
+  stream.next_out = reinterpret_cast<Bytef*>(buffer);
+  stream.avail_out = static_cast<uInt>(std::min<std::size_t>(size, UINT_MAX));
+  while (stream.avail_out > 0) {
+    if (stream.avail_in == 0 && consumed < this->size) {
+      const std::size_t chunk = std::min<std::size_t>(this->size - consumed, UINT_MAX);
+      stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + consumed));
+      stream.avail_in = static_cast<uInt>(chunk);
+      consumed += chunk;
+    }
+    const int flush = consumed < this->size ? Z_NO_FLUSH : Z_FINISH;
+    const int code = deflate(&stream, flush);
+    if (code == Z_STREAM_END) {
+      finished = true;
+      break;
+    }
+    if (code != Z_OK && code != Z_BUF_ERROR) {
+      error = finished = true;
+      return 0;
+    }
+  }
+  return static_cast<std::size_t>(reinterpret_cast<char*>(stream.next_out) - buffer);
+}
+#endif
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+
+#include <cstddef>
+
+#ifdef ENABLE_COMPRESSION_SUPPORT
+#include <zlib.h>
+#endif
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+// Compression settings of a client, applied to every connection it uses.
+struct Compression {
+  Compression() : replies(false), requestThreshold(-1) {}
+
+  bool operator==(const Compression& other) const {
+    return replies == other.replies && requestThreshold == other.requestThreshold;
+  }
+  bool operator!=(const Compression& other) const { return !(*this == other); }
+
+  // Whether gzip or deflate compressed replies are accepted.
+  bool replies;
+  // Minimal size in bytes of a request body to be sent gzip compressed, negative disables it.
+  int requestThreshold;
+};
+
+#ifdef ENABLE_COMPRESSION_SUPPORT
+// Compresses a buffer in gzip format piece by piece while it is read, so the compressed data never
+// has to be held as a whole. It is exported for the tests and the compression benchmark.
+class CPPCRATE_EXPORT GzipReader {
+ public:
+  explicit GzipReader(int level = Z_BEST_SPEED);
+  ~GzipReader();
+
+  bool isValid() const;
+  bool hasError() const;
+
+  void reset(const char* data, std::size_t size);
+  bool rewind();
+  std::size_t read(char* buffer, std::size_t size);
+
+ private:
+  GzipReader(const GzipReader&);
+  GzipReader& operator=(const GzipReader&);
+
+  z_stream stream;
+  bool valid;
+  bool finished;
+  bool error;
+  const char* data;
+  std::size_t size;
+  std::size_t consumed;
+};
+#endif
+/// \endcond
+
+}  // namespace CppCrate
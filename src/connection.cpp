@@ -0,0 +1,674 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "connection.h"
+#include "global_p.h"
+#include "nodelist.h"
+#include "preparedquery_p.h"
+
+#ifdef ENABLE_BLOB_SUPPORT
+#include "crypto.h"
+#include "filewriter.h"
+#include "mappedfile.h"
+
+#include <sstream>
+#endif
+
+#include <rapidjson/writer.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+namespace Internal {
+std::size_t writeStringFunction(void* ptr, std::size_t size, std::size_t nmemb, std::string* data) {
+  const std::size_t total = size * nmemb;
+  data->append(static_cast<char*>(ptr), total);
+  return total;
+}
+
+#ifdef ENABLE_BLOB_SUPPORT
+std::size_t writeStreamFunction(void* ptr, std::size_t size, std::size_t nmemb,
+                                BlobDownload* download) {
+  const std::size_t total = size * nmemb;
+  download->stream->write(static_cast<char*>(ptr), static_cast<std::streamsize>(total));
+  download->written += total;
+  return total;
+}
+
+// Curl takes a short read for the end of the data, so the buffer has to be filled. Unlike read(),
+// readsome() may return nothing as long as the stream has not filled its own buffer.
+std::size_t readFunction(void* ptr, std::size_t size, std::size_t nmemb, std::istream* stream) {
+  stream->read(static_cast<char*>(ptr), static_cast<std::streamsize>(size * nmemb));
+  return static_cast<std::size_t>(stream->gcount());
+}
+
+// Writes a range at its offset. Aborts if the server sent anything but the requested range, e.g.
+// the whole blob because it ignored the range.
+std::size_t rangeWriteFunction(void* ptr, std::size_t size, std::size_t nmemb, BlobRange* range) {
+  long responseCode = 0;
+  curl_easy_getinfo(range->curl, CURLINFO_RESPONSE_CODE, &responseCode);
+  const std::size_t total = size * nmemb;
+  if (responseCode != 206 || total > range->end - range->begin - range->written) {
+    range->partial = responseCode == 206;
+    return 0;
+  }
+  if (!range->file->write(static_cast<char*>(ptr), total, range->begin + range->written)) {
+    range->failed = true;
+    return 0;
+  }
+  range->written += total;
+  return total;
+}
+
+int seekFunction(std::istream* stream, curl_off_t offset, int origin) {
+  if (origin != SEEK_SET) return CURL_SEEKFUNC_CANTSEEK;
+  stream->clear();
+  stream->seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+  return stream->fail() ? CURL_SEEKFUNC_FAIL : CURL_SEEKFUNC_OK;
+}
+
+std::size_t memoryReadFunction(void* ptr, std::size_t size, std::size_t nmemb,
+                               BlobUpload* upload) {
+  const std::size_t read = std::min(size * nmemb, upload->size - upload->offset);
+  std::memcpy(ptr, upload->data + upload->offset, read);
+  upload->offset += read;
+  return read;
+}
+
+// Curl rewinds the body if it has to be sent again, e.g. after a redirect.
+int memorySeekFunction(BlobUpload* upload, curl_off_t offset, int origin) {
+  if (origin != SEEK_SET || offset < 0 || static_cast<std::size_t>(offset) > upload->size) {
+    return CURL_SEEKFUNC_CANTSEEK;
+  }
+  upload->offset = static_cast<std::size_t>(offset);
+  return CURL_SEEKFUNC_OK;
+}
+#endif
+
+#ifdef ENABLE_COMPRESSION_SUPPORT
+std::size_t gzipReadFunction(void* ptr, std::size_t size, std::size_t nmemb, GzipReader* reader) {
+  const std::size_t read = reader->read(static_cast<char*>(ptr), size * nmemb);
+  return reader->hasError() ? CURL_READFUNC_ABORT : read;
+}
+
+// Curl rewinds the body if it has to be sent again, e.g. after an authentication challenge.
+int gzipSeekFunction(GzipReader* reader, curl_off_t offset, int origin) {
+  if (offset != 0 || origin != SEEK_SET) return CURL_SEEKFUNC_CANTSEEK;
+  return reader->rewind() ? CURL_SEEKFUNC_OK : CURL_SEEKFUNC_FAIL;
+}
+#endif
+
+#ifdef ENABLE_BLOB_SUPPORT
+// Returns the scheme and authority of \a url without user information, e.g. "http://host:4200" for
+// "http://user@host:4200/_blobs/table/key?x=1".
+std::string baseUrl(const std::string& url) {
+  const std::string::size_type scheme = url.find("://");
+  const std::string::size_type begin = scheme == std::string::npos ? 0 : scheme + 3;
+  const std::string::size_type end = url.find_first_of("/?#", begin);
+  const std::string authority =
+      url.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+  const std::string::size_type at = authority.rfind('@');
+  return url.substr(0, begin) + (at == std::string::npos ? authority : authority.substr(at + 1));
+}
+#endif
+}
+
+Connection::Connection()
+    : curl(curl_easy_init()),
+#ifdef ENABLE_COMPRESSION_SUPPORT
+      gzip(CPPCRATE_NULLPTR),
+#endif
+      headers(CPPCRATE_NULLPTR),
+      headersGzip(false) {
+  curlError[0] = '\0';
+  if (!curl) return;
+
+  curl_easy_setopt(curl, CURLOPT_USERAGENT, "CppCrate");
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 25L);
+  curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, curlError);
+  curl_easy_setopt(curl, CURLOPT_COOKIEFILE, "");
+
+#ifdef CURL_AT_LEAST_VERSION
+#if CURL_AT_LEAST_VERSION(7, 25, 0)
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+#endif
+#endif
+
+#ifndef ENABLE_BLOB_SUPPORT
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Internal::writeStringFunction);
+#endif
+}
+
+Connection::~Connection() {
+  curl_slist_free_all(headers);
+#ifdef ENABLE_COMPRESSION_SUPPORT
+  delete gzip;
+#endif
+  if (curl) curl_easy_cleanup(curl);
+}
+
+bool Connection::isValid() const { return curl != CPPCRATE_NULLPTR; }
+
+void Connection::setCompression(const Compression& compression) {
+  if (!curl || compression == this->compression) return;
+  this->compression = compression;
+  // An empty string lets curl offer every encoding it supports and decode the reply on the fly.
+  curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, compression.replies ? "" : CPPCRATE_NULLPTR);
+}
+
+void Connection::reset() {
+  curlError[0] = '\0';
+  curl_easy_setopt(curl, CURLOPT_NOBODY, 0L);
+  curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, CPPCRATE_NULLPTR);
+  curl_easy_setopt(curl, CURLOPT_UPLOAD, 0L);
+  curl_easy_setopt(curl, CURLOPT_PUT, 0L);
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, CPPCRATE_NULLPTR);
+
+#ifdef ENABLE_BLOB_SUPPORT
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CPPCRATE_NULLPTR);
+  curl_easy_setopt(curl, CURLOPT_HTTPGET, 0L);
+  curl_easy_setopt(curl, CURLOPT_RANGE, CPPCRATE_NULLPTR);
+#endif
+  curl_easy_setopt(curl, CURLOPT_READDATA, CPPCRATE_NULLPTR);
+  curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, CPPCRATE_NULLPTR);
+  curl_easy_setopt(curl, CURLOPT_SEEKDATA, CPPCRATE_NULLPTR);
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, CPPCRATE_NULLPTR);
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0L);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, CPPCRATE_NULLPTR);
+  curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, 0L);
+}
+
+void Connection::setAuthentication(const Node& node) {
+  if (node.hasHttpAuthenticationInformation()) {
+    curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_ANY);
+    curl_easy_setopt(curl, CURLOPT_USERNAME, node.httpUser().c_str());
+    curl_easy_setopt(curl, CURLOPT_PASSWORD, node.httpPassword().c_str());
+  } else {
+    curl_easy_setopt(curl, CURLOPT_HTTPAUTH, 0L);
+    curl_easy_setopt(curl, CURLOPT_USERNAME, "");
+    curl_easy_setopt(curl, CURLOPT_PASSWORD, "");
+  }
+}
+
+std::string Connection::errorReply(const std::string& message, int code,
+                                   const std::string& component) {
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartObject();
+  writer.Key("error");
+  writer.StartObject();
+  writer.Key("message");
+  writer.String(message);
+  writer.Key("code");
+  writer.Int(code);
+  writer.Key("component");
+  writer.String(component);
+  writer.EndObject();
+  writer.EndObject();
+  return std::string(sb.GetString(), sb.GetSize());
+}
+
+CURL* Connection::handle() const { return curl; }
+
+void Connection::writeBody(const Query& query) {
+  body.Clear();
+  rapidjson::Writer<rapidjson::StringBuffer> writer(body);
+  writer.StartObject();
+  writer.Key("stmt");
+  writer.String(query.statement());
+  if (query.hasArguments()) {
+    writer.Key("args");
+    const std::string& args = query.arguments();
+    writer.RawValue(args.data(), args.size(), rapidjson::kArrayType);
+  } else if (query.hasBulkArguments()) {
+    writer.Key("bulk_args");
+    const std::string& bulkArgs = query.bulkArgumentBatch().json();
+    writer.RawValue(bulkArgs.data(), bulkArgs.size(), rapidjson::kArrayType);
+  }
+  writer.EndObject();
+}
+
+// Completes the serialized statement \a head of a prepared query by the arguments \a args.
+void Connection::writeBody(const std::string& head, const std::string& args) {
+  static const char argsKey[] = ",\"args\":";
+  const std::size_t argsKeySize = sizeof(argsKey) - 1;
+
+  body.Clear();
+  const std::size_t size = head.size() + (args.empty() ? 0 : argsKeySize + args.size()) + 1;
+  char* data = body.Push(size);
+  data = std::copy(head.begin(), head.end(), data);
+  if (!args.empty()) {
+    data = std::copy(argsKey, argsKey + argsKeySize, data);
+    data = std::copy(args.begin(), args.end(), data);
+  }
+  *data = '}';
+}
+
+// Prepares the handle for sending the current body to \a node. Bodies reaching the compression
+// threshold are compressed while curl sends them.
+void Connection::prepareRequest(const Node& node, const std::string& defaultSchema) {
+  reset();
+
+  bool useGzip = false;
+#ifdef ENABLE_COMPRESSION_SUPPORT
+  if (compression.requestThreshold >= 0 &&
+      body.GetSize() >= static_cast<std::size_t>(compression.requestThreshold)) {
+    if (!gzip) gzip = new GzipReader;
+    useGzip = gzip->isValid();
+  }
+#endif
+
+  if (!headers || headersSchema != defaultSchema || headersGzip != useGzip) {
+    curl_slist_free_all(headers);
+    headers = CPPCRATE_NULLPTR;
+    headersSchema = defaultSchema;
+    headersGzip = useGzip;
+    if (!defaultSchema.empty()) {
+      const std::string header = "Default-Schema: " + defaultSchema;
+      headers = curl_slist_append(headers, header.data());
+    }
+    if (useGzip) {
+      headers = curl_slist_append(headers, "Content-Encoding: gzip");
+      // The compressed size is unknown, so the body is sent chunked. Don't wait for a
+      // "100 Continue" before sending it.
+      headers = curl_slist_append(headers, "Expect:");
+    }
+  }
+  if (headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+#ifdef ENABLE_COMPRESSION_SUPPORT
+  if (useGzip) {
+    gzip->reset(body.GetString(), body.GetSize());
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, -1L);
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, Internal::gzipReadFunction);
+    curl_easy_setopt(curl, CURLOPT_READDATA, gzip);
+    curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, Internal::gzipSeekFunction);
+    curl_easy_setopt(curl, CURLOPT_SEEKDATA, gzip);
+  }
+#endif
+  if (!useGzip) {
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, body.GetSize());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.GetString());
+  }
+
+  reply.clear();
+#ifdef ENABLE_BLOB_SUPPORT
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Internal::writeStringFunction);
+#endif
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &reply);
+
+  setAuthentication(node);
+  if (url.empty() || urlNode != node.url()) {
+    urlNode = node.url();
+    url = node.url("/_sql?types");
+  }
+  curl_easy_setopt(curl, CURLOPT_URL, url.data());
+}
+
+void Connection::prepareExec(const Node& node, const Query& query,
+                             const std::string& defaultSchema) {
+  writeBody(query);
+  prepareRequest(node, defaultSchema);
+}
+
+RawResult Connection::finishExec(CURLcode code) {
+  RawResult r;
+  long responseCode;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+  r.setHttpStatusCode(static_cast<int>(responseCode));
+  r.setReply(code == CURLE_OK ? reply : errorReply(curlError, code, "curl"));
+  return r;
+}
+
+// Returns the time until the first byte of the reply was received, or the total time of the last
+// request if nothing was received.
+double Connection::responseTime() const {
+  double seconds = 0.0;
+  curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME, &seconds);
+  if (seconds <= 0.0) curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &seconds);
+  return seconds;
+}
+
+// Performs the prepared request on \a node and records its response time.
+CURLcode Connection::send(NodeList& nodes, const Node& node) {
+  nodes.setNodeStarted(node);
+  const CURLcode code = curl_easy_perform(curl);
+  nodes.setNodeFinished(node, responseTime());
+  return code;
+}
+
+// Fails a request for which no node is left.
+CURLcode Connection::noNode() {
+  static const char message[] = "No node is available.";
+  std::memcpy(curlError, message, sizeof(message));
+  return CURLE_COULDNT_CONNECT;
+}
+
+// Sends the current body to the nodes until one of them answers. Each node is tried at most once,
+// nodes that failed recently are skipped. The body is kept on retries, only the node changes.
+RawResult Connection::perform(NodeList& nodes, const std::string& defaultSchema) {
+  NodeList::Tries tries;
+  Node node;
+  CURLcode code = noNode();
+  while (nodes.next(tries, node)) {
+    prepareRequest(node, defaultSchema);
+    code = send(nodes, node);
+    if (code == CURLE_OK) {
+      nodes.setNodeSuccess(node, tries);
+      break;
+    }
+    nodes.setNodeError(node);
+  }
+  return finishExec(code);
+}
+
+RawResult Connection::exec(NodeList& nodes, const Query& query, const std::string& defaultSchema) {
+  writeBody(query);
+  return perform(nodes, defaultSchema);
+}
+
+RawResult Connection::exec(NodeList& nodes, const PreparedQuery& query, const std::string& args) {
+  // An empty prepared query has no head, so the body would not even be valid JSON.
+  if (query.isEmpty()) {
+    return RawResult(errorReply("The prepared query is empty.", 0, "CppCrate"));
+  }
+  writeBody(query.p->head, args);
+  return perform(nodes, query.p->defaultSchema);
+}
+
+#ifdef ENABLE_BLOB_SUPPORT
+std::string Connection::blobPath(const std::string& tableName, const std::string& key) {
+  return "/_blobs/" + tableName + "/" + key;
+}
+
+// Sends the prepared blob \a request to the nodes until one of them answers.
+CURLcode Connection::performBlob(NodeList& nodes, BlobRequest& request) {
+  bool attempt = startBlob(nodes, request);
+  while (attempt) attempt = finishBlobAttempt(nodes, request, curl_easy_perform(curl));
+  return request.code;
+}
+
+// Prepares the first attempt of \a request. Returns \c false if no node is available.
+//
+// Crate redirects blob requests to the node owning the blob's shard. The node a request was
+// redirected to is remembered, so the next request for the same blob is sent there directly. If
+// that node fails, it is forgotten and the request is sent to the nodes as usual. Requests to the
+// remembered node are accounted like any other, so its circuit breaker and load apply as well.
+bool Connection::startBlob(NodeList& nodes, BlobRequest& request) {
+  request.cached = nodes.blobNode(request.path, request.node);
+  if (!request.cached && !nodes.next(request.tries, request.node)) {
+    request.code = noNode();
+    return false;
+  }
+  prepareBlob(request.node, request.path, request.upload);
+  nodes.setNodeStarted(request.node);
+  return true;
+}
+
+// Records the result \a code of the current attempt of \a request. Returns \c true if the request
+// has to be performed again because the next node is tried. Each node is tried at most once, nodes
+// that failed recently are skipped. \a upload is rewound for every try. Once data was written to
+// \a download, no other node is tried.
+bool Connection::finishBlobAttempt(NodeList& nodes, BlobRequest& request, CURLcode code) {
+  request.code = code;
+  nodes.setNodeFinished(request.node, responseTime());
+  if (code == CURLE_OK) {
+    nodes.setNodeSuccess(request.node, request.tries);
+    setBlobNode(nodes, request.path);
+    return false;
+  }
+  nodes.setNodeError(request.node);
+  if (request.cached) {
+    request.cached = false;
+    nodes.removeBlobNode(request.path);
+  }
+
+  if (request.download && request.download->written > 0) return false;
+  if (!nodes.next(request.tries, request.node)) {
+    // Keeps the error of the last attempt, unless no node was tried at all.
+    if (request.tries.count == 0) request.code = noNode();
+    return false;
+  }
+  prepareBlob(request.node, request.path, request.upload);
+  nodes.setNodeStarted(request.node);
+  return true;
+}
+
+void Connection::prepareBlob(const Node& node, const std::string& path, BlobUpload* upload) {
+  if (upload) upload->rewind();
+  setAuthentication(node);
+  const std::string url = node.url(path);
+  curl_easy_setopt(curl, CURLOPT_URL, url.data());
+}
+
+// Remembers the node the last request for \a path was redirected to. Only a node of \a nodes is
+// remembered, together with its own credentials. A host known only from a redirect is never sent
+// any credentials.
+void Connection::setBlobNode(NodeList& nodes, const std::string& path) {
+  long redirects = 0;
+  curl_easy_getinfo(curl, CURLINFO_REDIRECT_COUNT, &redirects);
+  char* effectiveUrl = CPPCRATE_NULLPTR;
+  curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &effectiveUrl);
+  if (redirects == 0 || !effectiveUrl) return;
+
+  const std::string owner = Internal::baseUrl(effectiveUrl);
+  const std::vector<Node> configured = nodes.nodes();
+  for (std::size_t i = 0, total = configured.size(); i < total; ++i) {
+    if (Internal::baseUrl(configured[i].url()) == owner) {
+      nodes.setBlobNode(path, configured[i]);
+      return;
+    }
+  }
+}
+
+void BlobUpload::rewind() {
+  if (stream) {
+    stream->clear();
+    stream->seekg(0, std::ios::beg);
+  }
+  offset = 0;
+}
+
+BlobResult Connection::uploadBlob(NodeList& nodes, const std::string& tableName,
+                                  const std::string& key, std::istream& data) {
+  BlobUpload upload;
+  upload.stream = &data;
+  upload.size = static_cast<std::size_t>(Crypto::fileSize(data));
+  return uploadBlob(nodes, tableName, key, upload);
+}
+
+// Uploads the mapped \a file. Curl copies the data right from the mapping into its send buffer.
+BlobResult Connection::uploadBlob(NodeList& nodes, const std::string& tableName,
+                                  const std::string& key, const MappedFile& file) {
+  BlobUpload upload;
+  upload.data = file.data();
+  upload.size = file.size();
+  return uploadBlob(nodes, tableName, key, upload);
+}
+
+BlobResult Connection::uploadBlob(NodeList& nodes, const std::string& tableName,
+                                  const std::string& key, BlobUpload& upload) {
+  prepareUploadBlob(upload);
+  BlobRequest request(blobPath(tableName, key));
+  request.upload = &upload;
+  return finishUploadBlob(key, performBlob(nodes, request));
+}
+
+// Prepares sending the body \a upload, which is read from its stream or from memory.
+void Connection::prepareUploadBlob(BlobUpload& upload) {
+  reset();
+  if (upload.stream) {
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, Internal::readFunction);
+    curl_easy_setopt(curl, CURLOPT_READDATA, upload.stream);
+    curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, Internal::seekFunction);
+    curl_easy_setopt(curl, CURLOPT_SEEKDATA, upload.stream);
+  } else {
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, Internal::memoryReadFunction);
+    curl_easy_setopt(curl, CURLOPT_READDATA, &upload);
+    curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, Internal::memorySeekFunction);
+    curl_easy_setopt(curl, CURLOPT_SEEKDATA, &upload);
+  }
+  curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(upload.size));
+
+  curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+  curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+  curl_easy_setopt(curl, CURLOPT_PUT, 1L);
+}
+
+BlobResult Connection::finishUploadBlob(const std::string& key, CURLcode code) {
+  BlobResult r;
+  r.setKey(key);
+
+  long responseCode;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+
+  if (code == CURLE_OK) {
+    if (responseCode != 201) {
+      r.setErrorString("Blob with the key '" + key + "' already exists.",
+                       BlobResult::CrateErrorType);
+    }
+  } else {
+    r.setErrorString(curlError, BlobResult::HttpErrorType);
+  }
+
+  return r;
+}
+
+BlobResult Connection::existsBlob(NodeList& nodes, const std::string& tableName,
+                                  const std::string& key) {
+  BlobResult r;
+  r.setKey(key);
+
+  reset();
+  curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+  curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "HEAD");
+
+  BlobRequest request(blobPath(tableName, key));
+  const CURLcode code = performBlob(nodes, request);
+  long responseCode;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+
+  if (code == CURLE_OK) {
+    if (responseCode != 200) {
+      r.setErrorString("Blob with the key '" + key + "' does not exist.",
+                       BlobResult::CrateErrorType);
+    }
+  } else {
+    r.setErrorString(curlError, BlobResult::HttpErrorType);
+  }
+
+  return r;
+}
+
+BlobResult Connection::deleteBlob(NodeList& nodes, const std::string& tableName,
+                                  const std::string& key) {
+  BlobResult r;
+  r.setKey(key);
+
+  reset();
+  curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+  curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+
+  BlobRequest request(blobPath(tableName, key));
+  const CURLcode code = performBlob(nodes, request);
+  long responseCode;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+
+  if (code == CURLE_OK) {
+    if (responseCode != 204) {
+      r.setErrorString("Blob with the key '" + key + "' does not exist.",
+                       BlobResult::CrateErrorType);
+    }
+  } else {
+    r.setErrorString(curlError, BlobResult::HttpErrorType);
+  }
+
+  return r;
+}
+
+BlobResult Connection::downloadBlob(NodeList& nodes, const std::string& tableName,
+                                    const std::string& key, std::ostream& data) {
+  BlobDownload download;
+  download.stream = &data;
+  prepareDownloadBlob(download);
+  BlobRequest request(blobPath(tableName, key));
+  request.download = &download;
+  return finishDownloadBlob(key, performBlob(nodes, request));
+}
+
+void Connection::prepareDownloadBlob(BlobDownload& download) {
+  reset();
+  curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Internal::writeStreamFunction);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &download);
+}
+
+// Prepares downloading the remaining bytes of \a range.
+void Connection::prepareDownloadBlob(BlobRange& range) {
+  reset();
+  curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+
+  range.curl = curl;
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Internal::rangeWriteFunction);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &range);
+  std::ostringstream bytes;
+  bytes << range.begin + range.written << '-' << range.end - 1;
+  curl_easy_setopt(curl, CURLOPT_RANGE, bytes.str().c_str());
+}
+
+// Returns the content length of the last response, or -1 if it is unknown.
+int64_t Connection::contentLength() const {
+#ifdef CPPCRATE_HAS_CONTENT_LENGTH_T
+  curl_off_t length = -1;
+  curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+  return static_cast<int64_t>(length);
+#else
+  double length = -1.0;
+  curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length);
+  return static_cast<int64_t>(length);
+#endif
+}
+
+BlobResult Connection::finishDownloadBlob(const std::string& key, CURLcode code) {
+  BlobResult r;
+  r.setKey(key);
+
+  long responseCode;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+
+  if (code == CURLE_OK) {
+    if (responseCode == 404) {
+      r.setErrorString("Blob with the key '" + key + "' was not found.",
+                       BlobResult::CrateErrorType);
+    }
+  } else {
+    r.setErrorString(curlError, BlobResult::HttpErrorType);
+  }
+
+  return r;
+}
+#endif
+/// \endcond
+
+}  // namespace CppCrate
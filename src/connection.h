@@ -0,0 +1,199 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+#include <cppcrate/node.h>
+#include <cppcrate/preparedquery.h>
+#include <cppcrate/query.h>
+#include <cppcrate/rawresult.h>
+#include "compression.h"
+#include "nodelist.h"
+
+#ifdef ENABLE_BLOB_SUPPORT
+#include <cppcrate/blobresult.h>
+
+#include <iostream>
+#endif
+
+#include <curl/curl.h>
+
+#ifdef CURL_AT_LEAST_VERSION
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+#define CPPCRATE_HAS_MULTI_WAKEUP
+#endif
+#if CURL_AT_LEAST_VERSION(7, 55, 0)
+#define CPPCRATE_HAS_CONTENT_LENGTH_T
+#endif
+#endif
+
+#include <rapidjson/stringbuffer.h>
+
+#include <string>
+
+namespace CppCrate {
+
+class FileWriter;
+class MappedFile;
+
+/// \cond INTERNAL
+#ifdef ENABLE_BLOB_SUPPORT
+namespace Internal {
+CPPCRATE_EXPORT std::string baseUrl(const std::string& url);
+}
+
+// The body of a blob upload, read either from a stream or from memory.
+struct BlobUpload {
+  BlobUpload() : stream(CPPCRATE_NULLPTR), data(CPPCRATE_NULLPTR), size(0), offset(0) {}
+  void rewind();
+
+  std::istream* stream;
+  const char* data;
+  std::size_t size;
+  std::size_t offset;
+};
+
+// The body of a blob download written to a stream. The written bytes are counted, since the
+// position of a stream that cannot seek is unknown.
+struct BlobDownload {
+  BlobDownload() : stream(CPPCRATE_NULLPTR), written(0) {}
+
+  std::ostream* stream;
+  uint64_t written;
+};
+
+// A byte range of a blob downloaded into a file. A failed range resumes after the written bytes.
+struct BlobRange {
+  BlobRange()
+      : file(CPPCRATE_NULLPTR),
+        curl(CPPCRATE_NULLPTR),
+        begin(0),
+        end(0),
+        written(0),
+        partial(true),
+        failed(false) {}
+
+  FileWriter* file;
+  CURL* curl;
+  uint64_t begin;    // Offset of the first byte.
+  uint64_t end;      // Offset after the last byte.
+  uint64_t written;  // Number of bytes written to the file.
+  bool partial;      // Whether the server answered with the requested range.
+  bool failed;       // Whether writing to the file failed.
+};
+
+// A blob request and its attempts on the nodes.
+struct BlobRequest {
+  explicit BlobRequest(const std::string& path)
+      : path(path),
+        upload(CPPCRATE_NULLPTR),
+        download(CPPCRATE_NULLPTR),
+        cached(false),
+        code(CURLE_OK) {}
+
+  std::string path;
+  BlobUpload* upload;
+  BlobDownload* download;
+  Node node;    // Node of the current attempt.
+  bool cached;  // Whether node is the remembered owner of the blob.
+  NodeList::Tries tries;
+  CURLcode code;  // Result of the last attempt.
+};
+#endif
+
+class Connection {
+ public:
+  Connection();
+  ~Connection();
+
+  bool isValid() const;
+  CURL* handle() const;
+
+  void setCompression(const Compression& compression);
+
+  void prepareExec(const Node& node, const Query& query, const std::string& defaultSchema);
+  RawResult finishExec(CURLcode code);
+  double responseTime() const;
+  RawResult exec(NodeList& nodes, const Query& query, const std::string& defaultSchema);
+  RawResult exec(NodeList& nodes, const PreparedQuery& query, const std::string& args);
+
+#ifdef ENABLE_BLOB_SUPPORT
+  BlobResult uploadBlob(NodeList& nodes, const std::string& tableName, const std::string& key,
+                        std::istream& data);
+  BlobResult uploadBlob(NodeList& nodes, const std::string& tableName, const std::string& key,
+                        const MappedFile& file);
+  BlobResult existsBlob(NodeList& nodes, const std::string& tableName, const std::string& key);
+  BlobResult deleteBlob(NodeList& nodes, const std::string& tableName, const std::string& key);
+  BlobResult downloadBlob(NodeList& nodes, const std::string& tableName, const std::string& key,
+                          std::ostream& data);
+
+  void prepareUploadBlob(BlobUpload& upload);
+  BlobResult finishUploadBlob(const std::string& key, CURLcode code);
+  void prepareDownloadBlob(BlobDownload& download);
+  void prepareDownloadBlob(BlobRange& range);
+  int64_t contentLength() const;
+  BlobResult finishDownloadBlob(const std::string& key, CURLcode code);
+  bool startBlob(NodeList& nodes, BlobRequest& request);
+  bool finishBlobAttempt(NodeList& nodes, BlobRequest& request, CURLcode code);
+
+  static std::string blobPath(const std::string& tableName, const std::string& key);
+#endif
+
+  static std::string errorReply(const std::string& message, int code,
+                                const std::string& component);
+
+ private:
+  Connection(const Connection&);
+  Connection& operator=(const Connection&);
+
+  void reset();
+  void setAuthentication(const Node& node);
+  void writeBody(const Query& query);
+  void writeBody(const std::string& head, const std::string& args);
+  void prepareRequest(const Node& node, const std::string& defaultSchema);
+  RawResult perform(NodeList& nodes, const std::string& defaultSchema);
+  CURLcode send(NodeList& nodes, const Node& node);
+  CURLcode noNode();
+#ifdef ENABLE_BLOB_SUPPORT
+  BlobResult uploadBlob(NodeList& nodes, const std::string& tableName, const std::string& key,
+                        BlobUpload& upload);
+  CURLcode performBlob(NodeList& nodes, BlobRequest& request);
+  void prepareBlob(const Node& node, const std::string& path, BlobUpload* upload);
+  void setBlobNode(NodeList& nodes, const std::string& path);
+#endif
+
+  CURL* curl;
+  char curlError[CURL_ERROR_SIZE];
+
+  Compression compression;
+#ifdef ENABLE_COMPRESSION_SUPPORT
+  GzipReader* gzip;
+#endif
+
+  // State of the current SQL request. Headers and URL are kept for the next request, so they are
+  // only rebuilt if the default schema, the body's encoding or the node changes.
+  curl_slist* headers;
+  std::string headersSchema;
+  bool headersGzip;
+  rapidjson::StringBuffer body;
+  std::string reply;
+  std::string url;
+  std::string urlNode;
+};
+/// \endcond
+
+}  // namespace CppCrate
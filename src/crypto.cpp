@@ -16,15 +16,14 @@
 
 #include "crypto.h"
 
-#include <sha1/sha1.hpp>
-
-#include <iomanip>
-#include <sstream>
+#include <vector>
 
 namespace CppCrate {
 
 /// \cond INTERNAL
+// Returns the size of \a data and rewinds it, even if it was read to its end before.
 int64_t Crypto::fileSize(std::istream& data) {
+  data.clear();
   data.seekg(0, std::ios::beg);
   std::istream::pos_type size = data.tellg();
   data.seekg(0, std::ios::end);
@@ -34,10 +33,44 @@ int64_t Crypto::fileSize(std::istream& data) {
 }
 
 std::string Crypto::sha1(std::istream& data) {
-  SHA1 gen;
-  gen.update(data);
+  std::vector<char> buffer(65536);
+  Sha1 gen;
+  while (data) {
+    data.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+    gen.update(&buffer[0], static_cast<std::size_t>(data.gcount()));
+  }
+  return gen.final();
+}
+
+std::string Crypto::sha1(const char* data, std::size_t size) {
+  Sha1 gen;
+  gen.update(data, size);
   return gen.final();
 }
+
+// Returns the SHA-1 digests of \a buffers, hashing the small ones in parallel lanes. A large buffer
+// would keep a single lane busy long after the others are done, so it is hashed on its own.
+std::vector<std::string> Crypto::sha1Batch(const std::vector<Sha1::Buffer>& buffers) {
+  static const std::size_t maxLaneSize = 1024 * 1024;
+  std::vector<std::string> digests(buffers.size());
+  std::vector<Sha1::Buffer> small;
+  std::vector<std::size_t> smallIndexes;
+  for (std::size_t i = 0, total = buffers.size(); i < total; ++i) {
+    if (buffers[i].size > maxLaneSize) {
+      digests[i] = sha1(buffers[i].data, buffers[i].size);
+    } else {
+      small.push_back(buffers[i]);
+      smallIndexes.push_back(i);
+    }
+  }
+
+  const std::vector<std::string> smallDigests =
+      Sha1::hash(small, small.size() > 1 ? Sha1::fastestBatch() : Sha1::fastest());
+  for (std::size_t i = 0, total = small.size(); i < total; ++i) {
+    digests[smallIndexes[i]] = smallDigests[i];
+  }
+  return digests;
+}
 /// \endcond
 
 }  // namespace CppCrate
@@ -18,8 +18,12 @@
 
 #include <cppcrate/global.h>
 
+#include "sha1.h"
+
+#include <cstddef>
 #include <istream>
 #include <string>
+#include <vector>
 
 namespace CppCrate {
 
@@ -28,6 +32,8 @@ class Crypto {
  public:
   static int64_t fileSize(std::istream& data);
   static std::string sha1(std::istream& data);
+  static std::string sha1(const char* data, std::size_t size);
+  static std::vector<std::string> sha1Batch(const std::vector<Sha1::Buffer>& buffers);
 };
 /// \endcond
 
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "filewriter.h"
+#include "global_p.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+// Creates or truncates the file \a path for writing at arbitrary offsets. Writes at different
+// offsets may be issued concurrently.
+#ifdef _WIN32
+FileWriter::FileWriter(const std::string& path) {
+  file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, CPPCRATE_NULLPTR, CREATE_ALWAYS,
+                     FILE_ATTRIBUTE_NORMAL, CPPCRATE_NULLPTR);
+}
+
+FileWriter::~FileWriter() {
+  if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+}
+
+bool FileWriter::isValid() const { return file != INVALID_HANDLE_VALUE; }
+
+bool FileWriter::resize(uint64_t size) {
+  LARGE_INTEGER end;
+  end.QuadPart = static_cast<LONGLONG>(size);
+  return SetFilePointerEx(file, end, CPPCRATE_NULLPTR, FILE_BEGIN) && SetEndOfFile(file);
+}
+
+bool FileWriter::write(const char* data, std::size_t size, uint64_t offset) {
+  while (size > 0) {
+    OVERLAPPED position = OVERLAPPED();
+    position.Offset = static_cast<DWORD>(offset);
+    position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD written = 0;
+    const DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+    if (!WriteFile(file, data, chunk, &written, &position) || written == 0) return false;
+    data += written;
+    size -= written;
+    offset += written;
+  }
+  return true;
+}
+#else
+FileWriter::FileWriter(const std::string& path)
+    : fd(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666)) {}
+
+FileWriter::~FileWriter() {
+  if (fd >= 0) close(fd);
+}
+
+bool FileWriter::isValid() const { return fd >= 0; }
+
+bool FileWriter::resize(uint64_t size) { return ftruncate(fd, static_cast<off_t>(size)) == 0; }
+
+bool FileWriter::write(const char* data, std::size_t size, uint64_t offset) {
+  while (size > 0) {
+    const ssize_t written = pwrite(fd, data, size, static_cast<off_t>(offset));
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    data += written;
+    size -= static_cast<std::size_t>(written);
+    offset += static_cast<uint64_t>(written);
+  }
+  return true;
+}
+#endif
+/// \endcond
+
+}  // namespace CppCrate
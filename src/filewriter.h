@@ -0,0 +1,54 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+
+#include <cstddef>
+#include <string>
+
+#ifdef ENABLE_CPP11_SUPPORT
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+class FileWriter {
+ public:
+  explicit FileWriter(const std::string& path);
+  ~FileWriter();
+
+  bool isValid() const;
+  bool resize(uint64_t size);
+  bool write(const char* data, std::size_t size, uint64_t offset);
+
+ private:
+  FileWriter(const FileWriter&);
+  FileWriter& operator=(const FileWriter&);
+
+#ifdef _WIN32
+  void* file;
+#else
+  int fd;
+#endif
+};
+/// \endcond
+
+}  // namespace CppCrate
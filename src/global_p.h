@@ -16,13 +16,20 @@
 
 #pragma once
 
+#include <memory>
+
 #ifdef ENABLE_CPP11_SUPPORT
+#include <mutex>
+#define CPPCRATE_LOCK_GUARD(m) std::lock_guard<std::mutex> lockGuard(m)
+#define CPPCRATE_UNIQUE_PTR(T) std::unique_ptr<T>
 #define CPPCRATE_PIMPL_IMPLEMENT_ALL(Class) \
   CPPCRATE_PIMPL_IMPLEMENT_PRIVATE(Class)   \
   CPPCRATE_PIMPL_IMPLEMENT_COPY(Class)      \
   CPPCRATE_PIMPL_IMPLEMENT_MOVE(Class)      \
   CPPCRATE_PIMPL_IMPLEMENT_COMPARISON(Class)
 #else
+#define CPPCRATE_LOCK_GUARD(m)
+#define CPPCRATE_UNIQUE_PTR(T) std::auto_ptr<T>
 #include <sstream>
 namespace CppCrate {
 template <class T>
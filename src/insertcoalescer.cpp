@@ -0,0 +1,382 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cppcrate/insertcoalescer.h>
+#include "global_p.h"
+
+#include <cppcrate/clientpool.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::InsertCoalescer
+ *
+ * \brief Collects single-row statements from many threads and sends them as bulk operations.
+ *
+ * The class %InsertCoalescer collects rows of arguments per statement and sends them as a single
+ * bulk operation once a batch holds maxRows() rows or maxBytes() bytes, or once its oldest row is
+ * older than maxDelay() milliseconds. The batches are sent by a background thread via a
+ * ClientPool, so thousands of single-row INSERTs result in a few bulk requests:
+ * \code
+ * ClientPool pool;
+ * pool.connect("http://localhost:4200");
+ * InsertCoalescer coalescer(pool);
+ *
+ * // In any thread
+ * coalescer.insert("INSERT INTO events (id, name) VALUES (?, ?)", "[1, \"start\"]");
+ * \endcode
+ *
+ * If more than highWaterMark() rows are waiting to be sent, insert() blocks until the background
+ * thread caught up, or rejects the row, depending on overflowPolicy().
+ *
+ * Since the rows are sent later, insert() cannot report errors. Use setErrorHandler() to get the
+ * rows of every failed bulk operation. flush() sends all rows and waits until they are sent. The
+ * destructor flushes as well.
+ *
+ * \note The coalescer must be destroyed before the pool it uses.
+ */
+
+/*!
+ * \enum InsertCoalescer::OverflowPolicy
+ * Describes how insert() behaves if the high-water mark is reached.
+ *
+ * \var InsertCoalescer::OverflowPolicy InsertCoalescer::BlockOnOverflow
+ * insert() blocks until enough rows were sent.
+ *
+ * \var InsertCoalescer::OverflowPolicy InsertCoalescer::RejectOnOverflow
+ * insert() returns \c false without queueing the row.
+ */
+
+/*!
+ * \typedef InsertCoalescer::ErrorHandler
+ * Function called from the background thread with the statement, the rows and the result of a
+ * bulk operation in which at least one row failed.
+ */
+
+/// \cond INTERNAL
+class InsertCoalescer::Private {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Batch {
+    RowBatch rows;
+    Clock::time_point since;
+  };
+
+  explicit Private(ClientPool &pool)
+      : pool(pool),
+        maxRows(1000),
+        maxBytes(4 * 1024 * 1024),
+        maxDelay(100),
+        highWaterMark(100000),
+        policy(BlockOnOverflow),
+        queued(0),
+        flushRequests(0),
+        flushesDone(0),
+        stopped(false) {}
+
+  // Returns whether the batch has to be sent regardless of its age.
+  bool isFull(const Batch &batch) const {
+    return batch.rows.size() >= maxRows || batch.rows.json().size() >= maxBytes;
+  }
+
+  bool enqueue(const std::string &sql, const RowBatch &rows);
+  void run();
+
+  ClientPool &pool;
+  int maxRows;
+  std::size_t maxBytes;
+  int maxDelay;
+  int highWaterMark;
+  OverflowPolicy policy;
+  ErrorHandler errorHandler;
+
+  mutable std::mutex mutex;
+  std::condition_variable work;   // Signals the background thread.
+  std::condition_variable space;  // Signals producers and flush() that rows were sent.
+  std::map<std::string, Batch> batches;
+  // Rows that are waiting or being sent.
+  int queued;
+  // Every flush() call gets a number. The rows queued before the call were sent once flushesDone
+  // reached that number.
+  int64_t flushRequests;
+  int64_t flushesDone;
+  bool stopped;
+  std::thread thread;
+  std::thread::id worker;  // Id of the background thread, which runs the error handler.
+};
+
+bool InsertCoalescer::Private::enqueue(const std::string &sql, const RowBatch &rows) {
+  const int count = rows.size();
+  if (count == 0) return true;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  // A single insert larger than the high-water mark is accepted once everything else was sent. The
+  // error handler runs on the background thread, which must not wait for itself.
+  while (queued > 0 && queued + count > highWaterMark) {
+    if (policy == RejectOnOverflow) return false;
+    if (std::this_thread::get_id() == worker) break;
+    space.wait(lock);
+  }
+
+  std::map<std::string, Batch>::iterator it = batches.find(sql);
+  const bool added = it == batches.end();
+  if (added) {
+    it = batches.insert(std::make_pair(sql, Batch())).first;
+    it->second.since = Clock::now();
+  }
+  it->second.rows.append(rows);
+  queued += count;
+  // The background thread has to learn about the new batch's deadline.
+  if (added || isFull(it->second)) work.notify_one();
+  return true;
+}
+
+// Sends every batch that is full, too old or requested by flush(). Runs until stopped and all rows
+// were sent.
+void InsertCoalescer::Private::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  worker = std::this_thread::get_id();
+  while (true) {
+    const int64_t flush = flushRequests;
+    const bool flushAll = flush > flushesDone || stopped;
+    const Clock::time_point now = Clock::now();
+    Clock::time_point wakeUp = Clock::time_point::max();
+
+    std::vector<std::pair<std::string, RowBatch> > ready;
+    for (std::map<std::string, Batch>::iterator it = batches.begin(); it != batches.end();) {
+      const Clock::time_point due = it->second.since + std::chrono::milliseconds(maxDelay);
+      if (flushAll || isFull(it->second) || due <= now) {
+        ready.push_back(std::make_pair(it->first, it->second.rows));
+        batches.erase(it++);
+      } else {
+        if (due < wakeUp) wakeUp = due;
+        ++it;
+      }
+    }
+
+    if (ready.empty()) {
+      if (stopped) return;
+      if (flushAll) {
+        flushesDone = flush;
+        space.notify_all();
+      } else if (wakeUp == Clock::time_point::max()) {
+        work.wait(lock);
+      } else {
+        work.wait_until(lock, wakeUp);
+      }
+      continue;
+    }
+
+    const ErrorHandler handler = errorHandler;
+    lock.unlock();
+    for (std::size_t i = 0, total = ready.size(); i < total; ++i) {
+      const RowBatch &rows = ready[i].second;
+      BulkResult result(rows.size());
+      result.setChunkResult(0, rows.size(), pool.execRaw(Query(ready[i].first, rows)));
+      // The rows are released before the handler runs, so it can queue them again.
+      lock.lock();
+      queued -= rows.size();
+      lock.unlock();
+      space.notify_all();
+      if (result.hasError() && handler) handler(ready[i].first, rows, result);
+    }
+    lock.lock();
+
+    if (flushAll) flushesDone = flush;
+    space.notify_all();
+  }
+}
+/// \endcond
+
+/*!
+ * Constructs a coalescer that sends the collected rows via \a pool and starts its background
+ * thread.
+ */
+InsertCoalescer::InsertCoalescer(ClientPool &pool) : p(new Private(pool)) {
+  p->thread = std::thread(&Private::run, p);
+}
+
+// Sends all remaining rows before the background thread is stopped.
+InsertCoalescer::~InsertCoalescer() {
+  {
+    std::lock_guard<std::mutex> lock(p->mutex);
+    p->stopped = true;
+  }
+  p->work.notify_one();
+  p->thread.join();
+  delete p;
+}
+
+/*!
+ * Returns the number of rows after which a batch is sent. The default is 1000.
+ */
+int InsertCoalescer::maxRows() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->maxRows;
+}
+
+/*!
+ * Sets the number of rows after which a batch is sent to \a rows. Values smaller than 1 are
+ * ignored.
+ */
+void InsertCoalescer::setMaxRows(int rows) {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  if (rows > 0) p->maxRows = rows;
+}
+
+/*!
+ * Returns the size of the JSON encoded rows after which a batch is sent. The default is 4 MiB.
+ */
+std::size_t InsertCoalescer::maxBytes() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->maxBytes;
+}
+
+/*!
+ * Sets the size of the JSON encoded rows after which a batch is sent to \a bytes. A value of 0 is
+ * ignored.
+ */
+void InsertCoalescer::setMaxBytes(std::size_t bytes) {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  if (bytes > 0) p->maxBytes = bytes;
+}
+
+/*!
+ * Returns the time in milliseconds a row waits at most before its batch is sent. The default is
+ * 100 milliseconds.
+ */
+int InsertCoalescer::maxDelay() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->maxDelay;
+}
+
+/*!
+ * Sets the time in milliseconds a row waits at most before its batch is sent to \a milliseconds.
+ * Negative values are ignored.
+ */
+void InsertCoalescer::setMaxDelay(int milliseconds) {
+  {
+    std::lock_guard<std::mutex> lock(p->mutex);
+    if (milliseconds >= 0) p->maxDelay = milliseconds;
+  }
+  p->work.notify_one();
+}
+
+/*!
+ * Returns the number of waiting rows at which insert() blocks or rejects further rows. The default
+ * is 100000.
+ */
+int InsertCoalescer::highWaterMark() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->highWaterMark;
+}
+
+/*!
+ * Sets the number of waiting rows at which insert() blocks or rejects further rows to \a rows.
+ * Values smaller than 1 are ignored.
+ */
+void InsertCoalescer::setHighWaterMark(int rows) {
+  {
+    std::lock_guard<std::mutex> lock(p->mutex);
+    if (rows > 0) p->highWaterMark = rows;
+  }
+  p->space.notify_all();
+}
+
+/*!
+ * Returns how insert() behaves if the high-water mark is reached. The default is BlockOnOverflow.
+ */
+InsertCoalescer::OverflowPolicy InsertCoalescer::overflowPolicy() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->policy;
+}
+
+/*!
+ * Sets how insert() behaves if the high-water mark is reached to \a policy.
+ */
+void InsertCoalescer::setOverflowPolicy(OverflowPolicy policy) {
+  {
+    std::lock_guard<std::mutex> lock(p->mutex);
+    p->policy = policy;
+  }
+  p->space.notify_all();
+}
+
+/*!
+ * Sets the function that is called for every bulk operation with failed rows to \a handler. The
+ * handler runs on the background thread. The failed rows no longer count as pending when it is
+ * called, so it can retry them with insert(). Since the background thread cannot wait for itself,
+ * insert() called from the handler never blocks, even with BlockOnOverflow, and flush() returns
+ * right away. The rows are sent after the handler returned.
+ */
+void InsertCoalescer::setErrorHandler(const ErrorHandler &handler) {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  p->errorHandler = handler;
+}
+
+/*!
+ * Queues the row of arguments \a args for the statement \a sql. Returns \c false if the row was
+ * rejected because the high-water mark was reached.
+ *
+ * \pre \a args must be a well-formed JSON array.
+ */
+bool InsertCoalescer::insert(const std::string &sql, const std::string &args) {
+  RowBatch rows;
+  rows.append(args);
+  return p->enqueue(sql, rows);
+}
+
+/*!
+ * Queues the arguments of \a query, or all its bulk arguments, for the statement of \a query.
+ * Returns \c false if the rows were rejected because the high-water mark was reached.
+ */
+bool InsertCoalescer::insert(const Query &query) {
+  if (query.hasBulkArguments()) return p->enqueue(query.statement(), query.bulkArgumentBatch());
+  return insert(query.statement(), query.hasArguments() ? query.arguments() : "[]");
+}
+
+/*!
+ * Sends all queued rows and blocks until they were sent. Rows inserted by other threads meanwhile
+ * are not waited for. Called from the error handler, it does not block.
+ */
+void InsertCoalescer::flush() {
+  std::unique_lock<std::mutex> lock(p->mutex);
+  if (p->queued == 0) return;
+  const int64_t flush = ++p->flushRequests;
+  p->work.notify_one();
+  if (std::this_thread::get_id() == p->worker) return;
+  while (p->flushesDone < flush) p->space.wait(lock);
+}
+
+/*!
+ * Returns the number of rows that are waiting or being sent. Failed rows no longer count once the
+ * error handler is called.
+ */
+int InsertCoalescer::pendingRows() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->queued;
+}
+
+}  // namespace CppCrate
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mappedfile.h"
+#include "global_p.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+// Maps the file \a path read-only into memory. Empty files are valid but have no data.
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path)
+    : address(CPPCRATE_NULLPTR),
+      length(0),
+      valid(false),
+      file(INVALID_HANDLE_VALUE),
+      mapping(CPPCRATE_NULLPTR) {
+  file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, CPPCRATE_NULLPTR, OPEN_EXISTING,
+                     FILE_FLAG_SEQUENTIAL_SCAN, CPPCRATE_NULLPTR);
+  if (file == INVALID_HANDLE_VALUE) return;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) return;
+  length = static_cast<std::size_t>(size.QuadPart);
+  if (length == 0) {
+    valid = true;
+    return;
+  }
+  mapping = CreateFileMappingA(file, CPPCRATE_NULLPTR, PAGE_READONLY, 0, 0, CPPCRATE_NULLPTR);
+  if (!mapping) return;
+  address = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  valid = address != CPPCRATE_NULLPTR;
+}
+
+MappedFile::~MappedFile() {
+  if (address) UnmapViewOfFile(address);
+  if (mapping) CloseHandle(mapping);
+  if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+}
+#else
+MappedFile::MappedFile(const std::string& path)
+    : address(CPPCRATE_NULLPTR), length(0), valid(false) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat info;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+    length = static_cast<std::size_t>(info.st_size);
+    if (length == 0) {
+      valid = true;
+    } else {
+      void* mapped = mmap(CPPCRATE_NULLPTR, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED) {
+        // The file is read front to back twice: once for the key and once for the upload.
+        madvise(mapped, length, MADV_SEQUENTIAL);
+        address = static_cast<const char*>(mapped);
+        valid = true;
+      }
+    }
+  }
+  // The mapping stays valid after closing the file.
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (address) munmap(const_cast<char*>(address), length);
+}
+#endif
+
+bool MappedFile::isValid() const { return valid; }
+
+const char* MappedFile::data() const { return address; }
+
+std::size_t MappedFile::size() const { return length; }
+/// \endcond
+
+}  // namespace CppCrate
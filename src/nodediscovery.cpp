@@ -0,0 +1,92 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nodediscovery.h"
+#include "global_p.h"
+#include "nodelist.h"
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+namespace Internal {
+// A refresh must not keep the client waiting on disconnect for long.
+const long discoveryTimeout = 10000;
+}
+
+// Starts refreshing \a nodes from the cluster every \a interval milliseconds. The first refresh is
+// done right away. If a refresh fails, the \a seeds are added again.
+NodeDiscovery::NodeDiscovery(NodeList& nodes, const std::vector<Node>& seeds, int interval)
+    : nodes(nodes), seeds(seeds), interval(interval), stopped(false) {
+  if (!connection.isValid()) return;
+  curl_easy_setopt(connection.handle(), CURLOPT_TIMEOUT_MS, Internal::discoveryTimeout);
+  thread = std::thread(&NodeDiscovery::run, this);
+}
+
+NodeDiscovery::~NodeDiscovery() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopped = true;
+  }
+  wakeUp.notify_all();
+  if (thread.joinable()) thread.join();
+}
+
+// Returns the nodes listed by \a result of querying the column rest_url of sys.nodes. Since Crate
+// reports them without scheme and credentials, both are taken from the first seed.
+std::vector<Node> NodeDiscovery::discoveredNodes(const Result& result,
+                                                 const std::vector<Node>& seeds) {
+  std::vector<Node> discovered;
+  if (result.hasError()) return discovered;
+
+  const Node seed = seeds.empty() ? Node() : seeds.front();
+  const std::string& seedUrl = seed.url();
+  const std::string::size_type schemeEnd = seedUrl.find("://");
+  const std::string scheme =
+      schemeEnd == std::string::npos ? "http://" : seedUrl.substr(0, schemeEnd + 3);
+
+  for (int i = 0, total = result.recordSize(); i < total; ++i) {
+    const Value value = result.record(i).value(0);
+    if (value.isNull()) continue;
+    const std::string restUrl = value.asString();
+    if (restUrl.empty()) continue;
+
+    Node node(restUrl.find("://") == std::string::npos ? scheme + restUrl : restUrl);
+    if (seed.hasHttpAuthenticationInformation()) {
+      node.setHttpAuthentication(seed.httpUser(), seed.httpPassword());
+    }
+    discovered.push_back(node);
+  }
+  return discovered;
+}
+
+void NodeDiscovery::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopped) {
+    lock.unlock();
+    refresh();
+    lock.lock();
+    wakeUp.wait_for(lock, interval, [this]() { return stopped; });
+  }
+}
+
+void NodeDiscovery::refresh() {
+  const Result result(connection.exec(nodes, Query("SELECT rest_url FROM sys.nodes"), ""));
+  const std::vector<Node> discovered = discoveredNodes(result, seeds);
+  nodes.updateNodes(discovered.empty() ? seeds : discovered, discovered.empty());
+}
+/// \endcond
+
+}  // namespace CppCrate
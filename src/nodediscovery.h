@@ -0,0 +1,61 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+#include <cppcrate/node.h>
+#include <cppcrate/result.h>
+
+#include "connection.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CppCrate {
+
+class NodeList;
+
+/// \cond INTERNAL
+class NodeDiscovery {
+ public:
+  NodeDiscovery(NodeList& nodes, const std::vector<Node>& seeds, int interval);
+  ~NodeDiscovery();
+
+  static std::vector<Node> discoveredNodes(const Result& result, const std::vector<Node>& seeds);
+
+ private:
+  NodeDiscovery(const NodeDiscovery&);
+  NodeDiscovery& operator=(const NodeDiscovery&);
+
+  void run();
+  void refresh();
+
+  NodeList& nodes;
+  const std::vector<Node> seeds;
+  const std::chrono::milliseconds interval;
+  Connection connection;
+  std::mutex mutex;
+  std::condition_variable wakeUp;
+  bool stopped;
+  std::thread thread;
+};
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,310 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nodelist.h"
+#include "global_p.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#ifdef ENABLE_CPP11_SUPPORT
+#include <chrono>
+#else
+#include <ctime>
+#endif
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+namespace Internal {
+// Weight of a new response time in the moving average of a node's latency.
+const double latencyWeight = 0.3;
+// Without new requests, a node's latency decays by 1/e within this time in seconds, so slow or
+// failed nodes get another chance.
+const double latencyDecay = 10.0;
+// A failed node is skipped for this time in seconds, doubled with every further failure up to
+// maxBackoff.
+const double minBackoff = 0.5;
+const double maxBackoff = 30.0;
+#ifdef ENABLE_BLOB_SUPPORT
+// Number of blobs whose owning node is remembered.
+const std::size_t maxBlobNodes = 4096;
+#endif
+
+// Returns a monotonic time in seconds.
+double monotonicTime() {
+#ifdef ENABLE_CPP11_SUPPORT
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#else
+  return static_cast<double>(std::time(CPPCRATE_NULLPTR));
+#endif
+}
+
+double backoff(int failures) {
+  const int doublings = std::min(failures - 1, 16);
+  return std::min(minBackoff * static_cast<double>(1 << doublings), maxBackoff);
+}
+}
+
+NodeList::NodeList()
+    : list(new Snapshot(std::vector<Node>())), options(Client::ConnectToFirstNodeAlways) {}
+
+void NodeList::setNodes(const std::vector<Node>& nodes, Client::ConnectionOptions options) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  list = SharedDataPointer<Snapshot>(new Snapshot(nodes));
+  this->options = options;
+  pruneStates();
+}
+
+// Replaces the nodes by \a nodes without changing the options. Nodes that are still present keep
+// their position and state, new nodes are appended. If \a keepOthers is true, no node is removed.
+void NodeList::updateNodes(const std::vector<Node>& nodes, bool keepOthers) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  const std::vector<Node>& current = list->nodes;
+  std::vector<Node> updated;
+  for (std::size_t i = 0, total = current.size(); i < total; ++i) {
+    if (keepOthers || std::find(nodes.begin(), nodes.end(), current[i]) != nodes.end()) {
+      updated.push_back(current[i]);
+    }
+  }
+  for (std::size_t i = 0, total = nodes.size(); i < total; ++i) {
+    if (std::find(updated.begin(), updated.end(), nodes[i]) == updated.end()) {
+      updated.push_back(nodes[i]);
+    }
+  }
+  list = SharedDataPointer<Snapshot>(new Snapshot(updated));
+  pruneStates();
+}
+
+std::vector<Node> NodeList::nodes() const {
+  CPPCRATE_LOCK_GUARD(mutex);
+  return list->nodes;
+}
+
+void NodeList::clear() {
+  CPPCRATE_LOCK_GUARD(mutex);
+  list = SharedDataPointer<Snapshot>(new Snapshot(std::vector<Node>()));
+  states.clear();
+#ifdef ENABLE_BLOB_SUPPORT
+  blobNodes.clear();
+  blobNodesByPath.clear();
+#endif
+}
+
+std::size_t NodeList::size() const {
+  CPPCRATE_LOCK_GUARD(mutex);
+  return list->nodes.size();
+}
+
+// Sets \a node to the node for the next try of a request and returns true, or returns false if
+// every node was tried. Nodes whose circuit is open are skipped. If the circuit of every node is
+// open, the first try goes to the node that is due next instead of failing right away. All tries
+// iterate over the nodes as of the first one, so reordering the list by other requests neither
+// repeats nor skips a node.
+bool NodeList::next(Tries& tries, Node& node) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  if (tries.visited == 0) tries.nodes = list;
+  const std::vector<Node>& nodes = tries.nodes->nodes;
+  const std::size_t size = nodes.size();
+  if (size == 0) return false;
+
+  const double now = Internal::monotonicTime();
+  if (tries.visited == 0) tries.first = pick(nodes, now);
+  while (tries.visited < size) {
+    const Node& candidate = nodes[(tries.first + tries.visited++) % size];
+    if (isAvailable(candidate, now)) {
+      node = candidate;
+      ++tries.count;
+      return true;
+    }
+  }
+  if (tries.count > 0) return false;
+
+  std::size_t due = 0;
+  for (std::size_t i = 1; i < size; ++i) {
+    if (states[nodes[i].url()].retryAt < states[nodes[due].url()].retryAt) due = i;
+  }
+  State& state = states[nodes[due].url()];
+  state.retryAt = now + Internal::backoff(state.failures);
+  node = nodes[due];
+  ++tries.count;
+  return true;
+}
+
+// Closes the circuit of \a node and reorders the nodes according to the connection options. Since
+// other requests might have reordered the list in the meantime, the node is looked up instead of
+// relying on a position.
+void NodeList::setNodeSuccess(const Node& node, const Tries& tries) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  const std::map<std::string, State>::iterator state = states.find(node.url());
+  if (state != states.end()) state->second.failures = 0;
+  if (tries.visited <= 1) return;
+
+  switch (options) {
+    case Client::ConnectToFirstNodeAlways:
+      break;
+    case Client::ConnectToLastAccessedNode: {
+      std::vector<Node> nodes = list->nodes;
+      const std::vector<Node>::iterator it = std::find(nodes.begin(), nodes.end(), node);
+      if (it == nodes.end()) break;
+      std::rotate(nodes.begin(), it, nodes.end());
+      list = SharedDataPointer<Snapshot>(new Snapshot(nodes));
+      break;
+    }
+    case Client::ConnectToRandomNode: {
+      std::vector<Node> nodes = list->nodes;
+      std::random_shuffle(nodes.begin(), nodes.end());
+      list = SharedDataPointer<Snapshot>(new Snapshot(nodes));
+      break;
+    }
+    case Client::ConnectToLeastLoadedNode:
+      break;
+  }
+}
+
+// Opens the circuit of \a node after a network error, so it is skipped until its backoff expired.
+void NodeList::setNodeError(const Node& node) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  State& state = states[node.url()];
+  ++state.failures;
+  state.retryAt = Internal::monotonicTime() + Internal::backoff(state.failures);
+}
+
+// Marks that a request was sent to \a node.
+void NodeList::setNodeStarted(const Node& node) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  if (options != Client::ConnectToLeastLoadedNode) return;
+  ++states[node.url()].inFlight;
+}
+
+// Marks that a request sent to \a node finished after \a seconds, regardless of its success.
+void NodeList::setNodeFinished(const Node& node, double seconds) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  if (options != Client::ConnectToLeastLoadedNode) return;
+
+  State& state = states[node.url()];
+  if (state.inFlight > 0) --state.inFlight;
+  const double now = Internal::monotonicTime();
+  if (state.updated > 0.0) {
+    const double latency = state.latency * std::exp((state.updated - now) / Internal::latencyDecay);
+    state.latency = latency + Internal::latencyWeight * (seconds - latency);
+  } else {
+    state.latency = seconds;
+  }
+  state.updated = now;
+}
+
+// Returns the position in \a nodes of the node a new request starts with. With
+// ConnectToLeastLoadedNode the less loaded of two random nodes is picked ("power of two choices"),
+// otherwise it is the first node.
+std::size_t NodeList::pick(const std::vector<Node>& nodes, double now) {
+  const std::size_t size = nodes.size();
+  if (options != Client::ConnectToLeastLoadedNode || size < 2) return 0;
+
+  const std::size_t a = static_cast<std::size_t>(std::rand()) % size;
+  std::size_t b = static_cast<std::size_t>(std::rand()) % (size - 1);
+  if (b >= a) ++b;
+  return cost(nodes[b], now) < cost(nodes[a], now) ? b : a;
+}
+
+#ifdef ENABLE_BLOB_SUPPORT
+// Sets \a node to the node a blob request for \a path was redirected to last time and returns
+// true, or returns false if the node owning the blob is not known or its circuit is open.
+bool NodeList::blobNode(const std::string& path, Node& node) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  const std::map<std::string, BlobNodes::iterator>::iterator it = blobNodesByPath.find(path);
+  if (it == blobNodesByPath.end()) return false;
+  if (!isAvailable(it->second->second, Internal::monotonicTime())) return false;
+  blobNodes.splice(blobNodes.begin(), blobNodes, it->second);
+  node = it->second->second;
+  return true;
+}
+
+// Remembers that the blob \a path is owned by \a node. If too many blobs are remembered, the least
+// recently used one is forgotten.
+void NodeList::setBlobNode(const std::string& path, const Node& node) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  const std::map<std::string, BlobNodes::iterator>::iterator it = blobNodesByPath.find(path);
+  if (it != blobNodesByPath.end()) {
+    it->second->second = node;
+    blobNodes.splice(blobNodes.begin(), blobNodes, it->second);
+    return;
+  }
+  blobNodes.push_front(std::make_pair(path, node));
+  blobNodesByPath[path] = blobNodes.begin();
+  if (blobNodes.size() > Internal::maxBlobNodes) {
+    blobNodesByPath.erase(blobNodes.back().first);
+    blobNodes.pop_back();
+  }
+}
+
+void NodeList::removeBlobNode(const std::string& path) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  const std::map<std::string, BlobNodes::iterator>::iterator it = blobNodesByPath.find(path);
+  if (it == blobNodesByPath.end()) return;
+  blobNodes.erase(it->second);
+  blobNodesByPath.erase(it);
+}
+#endif
+
+// Forgets the state of nodes that are no longer used and the blobs they owned.
+void NodeList::pruneStates() {
+  const std::vector<Node>& nodes = list->nodes;
+  std::map<std::string, State> kept;
+  for (std::size_t i = 0, total = nodes.size(); i < total; ++i) {
+    const std::map<std::string, State>::const_iterator it = states.find(nodes[i].url());
+    if (it != states.end()) kept.insert(*it);
+  }
+  states.swap(kept);
+
+#ifdef ENABLE_BLOB_SUPPORT
+  for (BlobNodes::iterator it = blobNodes.begin(); it != blobNodes.end();) {
+    if (std::find(nodes.begin(), nodes.end(), it->second) != nodes.end()) {
+      ++it;
+    } else {
+      blobNodesByPath.erase(it->first);
+      it = blobNodes.erase(it);
+    }
+  }
+#endif
+}
+
+// Returns whether a request may be sent to \a node. If the backoff of an open circuit expired, a
+// single request is let through as a probe and the next one has to wait for another backoff.
+bool NodeList::isAvailable(const Node& node, double now) {
+  const std::map<std::string, State>::iterator it = states.find(node.url());
+  if (it == states.end() || it->second.failures == 0) return true;
+  State& state = it->second;
+  if (state.retryAt > now) return false;
+  state.retryAt = now + Internal::backoff(state.failures);
+  return true;
+}
+
+// Returns the cost of sending a request to \a node at \a now. Nodes without any finished request
+// cost the least, so they are tried first.
+double NodeList::cost(const Node& node, double now) const {
+  const std::map<std::string, State>::const_iterator it = states.find(node.url());
+  if (it == states.end()) return 0.0;
+  const State& state = it->second;
+  const double latency = state.latency * std::exp((state.updated - now) / Internal::latencyDecay);
+  // Requests in flight count even for nodes that answer in no time.
+  return (latency + 0.001) * (state.inFlight + 1);
+}
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/client.h>
+#include <cppcrate/global.h>
+#include <cppcrate/node.h>
+
+#include "shareddata.h"
+
+#ifdef ENABLE_CPP11_SUPPORT
+#include <mutex>
+#endif
+
+#ifdef ENABLE_BLOB_SUPPORT
+#include <list>
+#endif
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+class NodeList {
+ public:
+  // The nodes in the order of the list at some point in time. The list is replaced instead of
+  // modified, so a request keeps iterating over the nodes it started with.
+  struct Snapshot : public SharedData {
+    explicit Snapshot(const std::vector<Node>& nodes) : nodes(nodes) {}
+    const std::vector<Node> nodes;
+  };
+
+  // The nodes a single request was sent to.
+  struct Tries {
+    Tries() : first(0), visited(0), count(0) {}
+    SharedDataPointer<Snapshot> nodes;  // The list as of the first try.
+    std::size_t first;                  // Position of the node the request starts with.
+    std::size_t visited;                // Number of positions looked at.
+    std::size_t count;                  // Number of tries.
+  };
+
+  NodeList();
+
+  void setNodes(const std::vector<Node>& nodes, Client::ConnectionOptions options);
+  void updateNodes(const std::vector<Node>& nodes, bool keepOthers = false);
+  std::vector<Node> nodes() const;
+  void clear();
+  std::size_t size() const;
+
+  bool next(Tries& tries, Node& node);
+  void setNodeSuccess(const Node& node, const Tries& tries);
+  void setNodeError(const Node& node);
+  void setNodeStarted(const Node& node);
+  void setNodeFinished(const Node& node, double seconds);
+
+#ifdef ENABLE_BLOB_SUPPORT
+  bool blobNode(const std::string& path, Node& node);
+  void setBlobNode(const std::string& path, const Node& node);
+  void removeBlobNode(const std::string& path);
+#endif
+
+ private:
+  NodeList(const NodeList&);
+  NodeList& operator=(const NodeList&);
+
+  struct State {
+    State() : latency(0.0), updated(0.0), inFlight(0), failures(0), retryAt(0.0) {}
+    // Load used by ConnectToLeastLoadedNode
+    double latency;  // Moving average of the response time in seconds.
+    double updated;  // Time of the last update of latency.
+    int inFlight;
+    // Circuit breaker: closed without failures, otherwise open until retryAt.
+    int failures;    // Number of consecutive failures.
+    double retryAt;  // Time at which the next try is allowed.
+  };
+  void pruneStates();
+  std::size_t pick(const std::vector<Node>& nodes, double now);
+  bool isAvailable(const Node& node, double now);
+  double cost(const Node& node, double now) const;
+
+  SharedDataPointer<Snapshot> list;
+  Client::ConnectionOptions options;
+  std::map<std::string, State> states;
+#ifdef ENABLE_BLOB_SUPPORT
+  // Nodes owning a blob by its path, the most recently used path comes first.
+  typedef std::list<std::pair<std::string, Node> > BlobNodes;
+  BlobNodes blobNodes;
+  std::map<std::string, BlobNodes::iterator> blobNodesByPath;
+#endif
+#ifdef ENABLE_CPP11_SUPPORT
+  mutable std::mutex mutex;
+#endif
+};
+/// \endcond
+
+}  // namespace CppCrate
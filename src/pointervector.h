@@ -0,0 +1,62 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "global_p.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+// Vector of pointers that owns the objects they point to. The objects are deleted together with the
+// vector, so they are not leaked on early returns or exceptions. Unlike a vector of unique pointers
+// it works without C++11 support.
+template <class T>
+class PointerVector {
+ public:
+  PointerVector() {}
+  ~PointerVector() {
+    for (std::size_t i = 0, total = items.size(); i < total; ++i) delete items[i];
+  }
+
+  // Takes ownership of \a item, even if it cannot be appended.
+  void push_back(T* item) {
+    CPPCRATE_UNIQUE_PTR(T) owner(item);
+    items.push_back(item);
+    owner.release();
+  }
+  void pop_back() {
+    delete items.back();
+    items.pop_back();
+  }
+
+  T* operator[](std::size_t i) const { return items[i]; }
+  T* back() const { return items.back(); }
+  std::size_t size() const { return items.size(); }
+  bool empty() const { return items.empty(); }
+
+ private:
+  PointerVector(const PointerVector&);
+  PointerVector& operator=(const PointerVector&);
+
+  std::vector<T*> items;
+};
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cppcrate/preparedquery.h>
+#include "global_p.h"
+#include "preparedquery_p.h"
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::PreparedQuery
+ *
+ * \brief Holds a SQL statement that is serialized once and executed many times.
+ *
+ * The class %PreparedQuery holds a SQL statement together with the default schema it is executed
+ * in. The statement is escaped and serialized into the beginning of the request body when the
+ * prepared query is constructed, so executing it only appends the arguments:
+ * \code
+ * PreparedQuery byId = client.prepare("SELECT name FROM players WHERE id = ?");
+ * for (int id = 0; id < 1000; ++id) {
+ *   Result result = client.exec(byId, "[" + std::to_string(id) + "]");
+ * }
+ * \endcode
+ *
+ * A prepared query does not depend on the client that created it. It can be executed by any Client
+ * or ClientPool and can be shared between threads.
+ *
+ * \note Crate has no server-side prepared statements. The statement is still parsed by Crate on
+ *       every execution, only the client-side work is done once.
+ *
+ * \sa Client::prepare()
+ */
+
+CPPCRATE_PIMPL_IMPLEMENT_ALL(PreparedQuery)
+
+/*!
+ * Constructs an empty prepared query.
+ */
+PreparedQuery::PreparedQuery() : p(new Private) {}
+
+/*!
+ * Constructs a prepared query for the SQL statement \a sql that is executed in the schema
+ * \a defaultSchema. If \a defaultSchema is empty Crate's default schema is used.
+ */
+PreparedQuery::PreparedQuery(const std::string &sql, const std::string &defaultSchema)
+    : p(new Private) {
+  p->sql = sql;
+  p->defaultSchema = defaultSchema;
+
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartObject();
+  writer.Key("stmt");
+  writer.String(sql);
+  // The object is closed by Connection after the arguments were appended.
+  p->head.assign(sb.GetString(), sb.GetSize());
+}
+
+/*!
+ * Returns \c true if the prepared query has no statement.
+ */
+bool PreparedQuery::isEmpty() const { return p->sql.empty(); }
+
+/*!
+ * Returns the SQL statement.
+ */
+const std::string &PreparedQuery::statement() const { return p->sql; }
+
+/*!
+ * Returns the schema the statement is executed in.
+ */
+const std::string &PreparedQuery::defaultSchema() const { return p->defaultSchema; }
+
+}  // namespace CppCrate
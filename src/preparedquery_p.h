@@ -0,0 +1,40 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/preparedquery.h>
+
+#include <string>
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+class PreparedQuery::Private {
+ public:
+  bool operator==(const Private& other) const {
+    return sql == other.sql && defaultSchema == other.defaultSchema;
+  }
+
+  std::string sql;
+  std::string defaultSchema;
+
+  // The beginning of the request body holding the escaped statement: {"stmt":"<sql>"
+  std::string head;
+};
+/// \endcond
+
+}  // namespace CppCrate
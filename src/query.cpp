@@ -17,6 +17,8 @@
 #include <cppcrate/query.h>
 #include "global_p.h"
 
+#include <rapidjson/writer.h>
+
 namespace CppCrate {
 
 /*!
@@ -59,6 +61,30 @@ namespace CppCrate {
  * newPlayers.push_back("[2, ’Hobbes’]");
  * q.bulkArguments(newPlayers);
  * \endcode
+ *
+ * For large bulk operations use a RowBatch instead of a \c std::vector<std::string>. It keeps all
+ * rows in a single buffer that is sent to Crate as is.
+ *
+ * \section sec_class_query_bind Binding arguments
+ *
+ * Instead of formatting the arguments as JSON yourself they can be bound one after another. The
+ * values are written directly into the query's arguments, strings are escaped as needed:
+ * \code
+ * Query q("SELECT * FROM players WHERE age > ? AND name = ?");
+ * q.bind(42).bind("Calvin");  // arguments(): [42,"Calvin"]
+ * \endcode
+ *
+ * For a bulk operation call nextRow() after each row:
+ * \code
+ * Query q("INSERT INTO players (id, name) VALUES (?,?)");
+ * q.bind(1).bind("Calvin").nextRow();
+ * q.bind(2).bind("Hobbes").nextRow();  // bulkArguments(): [1,"Calvin"] and [2,"Hobbes"]
+ * \endcode
+ *
+ * Use clearArguments() to reuse the query with other arguments.
+ *
+ * Arguments set by setArguments() are continued as long as they end with a JSON array. Otherwise,
+ * e.g. for a malformed array, bound values are ignored and the arguments are left untouched.
  */
 
 /*!
@@ -79,12 +105,56 @@ namespace CppCrate {
 class Query::Private {
  public:
   bool operator==(const Private &other) const {
-    return sql == other.sql && args == other.args && bulkArgs == other.bulkArgs;
+    return sql == other.sql && args == other.args && bulkArgs == other.bulkArgs &&
+           row == other.row;
   }
+
   std::string sql;
   std::string args;
-  std::vector<std::string> bulkArgs;
+  RowBatch bulkArgs;
+  // The row values are bound to once the query has bulk arguments. It is kept apart from args, so
+  // an unfinished row does not turn the bulk operation into a query with arguments.
+  std::string row;
+
+  // Returns the row values are bound to.
+  std::string &current() { return bulkArgs.isEmpty() ? args : row; }
+
+  // Opens the JSON array of the current row for another value. If it returns true, it must be
+  // followed by a value and closeRow(). Returns false and leaves the row untouched if it does not
+  // end with an array.
+  bool openRow() {
+    static const char whitespace[] = " \t\n\r";
+    std::string &args = current();
+    const std::size_t end = args.find_last_not_of(whitespace);
+    if (end == std::string::npos) {
+      args = "[";
+      return true;
+    }
+    if (args[end] != ']' || end == 0) return false;
+    const std::size_t last = args.find_last_not_of(whitespace, end - 1);
+    if (last == std::string::npos) return false;
+    args.erase(last + 1);
+    if (args[last] != '[') args.push_back(',');
+    return true;
+  }
+  void closeRow() { current().push_back(']'); }
+};
+
+namespace Internal {
+// Output stream for rapidjson::Writer appending to a std::string.
+class StringOutputStream {
+ public:
+  typedef char Ch;
+  explicit StringOutputStream(std::string &string) : string(string) {}
+  void Put(char c) { string.push_back(c); }
+  void Flush() {}
+
+ private:
+  std::string &string;
 };
+
+typedef rapidjson::Writer<StringOutputStream> StringWriter;
+}
 /// \endcond
 
 CPPCRATE_PIMPL_IMPLEMENT_ALL(Query)
@@ -111,6 +181,14 @@ Query::Query(const std::string &sql, const std::string &args) : p(new Private) {
  *      character.
  */
 Query::Query(const std::string &sql, const std::vector<std::string> &bulkArgs) : p(new Private) {
+  p->sql = sql;
+  p->bulkArgs = RowBatch(bulkArgs);
+}
+
+/*!
+ * Constructs a query with the SQL statement \a sql and the bulk arguments \a bulkArgs.
+ */
+Query::Query(const std::string &sql, const RowBatch &bulkArgs) : p(new Private) {
   p->sql = sql;
   p->bulkArgs = bulkArgs;
 }
@@ -118,7 +196,9 @@ Query::Query(const std::string &sql, const std::vector<std::string> &bulkArgs) :
 /*!
  * Returns \c true if neither statement, nor arguments, nor bulk arguments are defined.
  */
-bool Query::isEmpty() const { return p->sql.empty() && p->args.empty() && p->bulkArgs.empty(); }
+bool Query::isEmpty() const {
+  return p->sql.empty() && p->args.empty() && p->bulkArgs.isEmpty();
+}
 
 /*!
  * Returns the query's type. An empty query is considered a simple type (SimpleType).
@@ -152,6 +232,7 @@ bool Query::hasStatement() const { return !p->sql.empty(); }
 void Query::setArguments(const std::string &args) {
   p->args = args;
   p->bulkArgs.clear();
+  p->row.clear();
 }
 
 /*!
@@ -173,18 +254,181 @@ bool Query::hasArguments() const { return !p->args.empty(); }
  * \note The simple arguments are implicitly cleared.
  */
 void Query::setBulkArguments(const std::vector<std::string> &bulkArgs) {
+  p->bulkArgs = RowBatch(bulkArgs);
+  p->args.clear();
+  p->row.clear();
+}
+
+/*!
+ * \overload
+ */
+void Query::setBulkArguments(const RowBatch &bulkArgs) {
   p->bulkArgs = bulkArgs;
   p->args.clear();
+  p->row.clear();
 }
 
 /*!
  * Returns the bulk arguments.
+ *
+ * \note The bulk arguments are split into rows on every call. Use bulkArgumentBatch() to access
+ *       them without copying.
+ */
+std::vector<std::string> Query::bulkArguments() const { return p->bulkArgs.rows(); }
+
+/*!
+ * Returns the bulk arguments as they are sent to Crate.
  */
-const std::vector<std::string> &Query::bulkArguments() const { return p->bulkArgs; }
+const RowBatch &Query::bulkArgumentBatch() const { return p->bulkArgs; }
 
 /*!
  * Returns whether the query has bulk arguments defined.
  */
-bool Query::hasBulkArguments() const { return !p->bulkArgs.empty(); }
+bool Query::hasBulkArguments() const { return !p->bulkArgs.isEmpty(); }
+
+/*!
+ * Appends the boolean \a value to the current row of arguments and returns a reference to this
+ * query.
+ *
+ * \sa nextRow()
+ */
+Query &Query::bind(bool value) {
+  if (!p->openRow()) return *this;
+  Internal::StringOutputStream os(p->current());
+  Internal::StringWriter(os).Bool(value);
+  p->closeRow();
+  return *this;
+}
+
+/*!
+ * Appends the integer \a value to the current row of arguments and returns a reference to this
+ * query.
+ *
+ * There is an overload for every integer type, so fixed width types like \c int64_t and \c size_t
+ * bind without ambiguity.
+ */
+Query &Query::bind(int value) {
+  if (!p->openRow()) return *this;
+  Internal::StringOutputStream os(p->current());
+  Internal::StringWriter(os).Int(value);
+  p->closeRow();
+  return *this;
+}
+
+/*!
+ * \overload
+ */
+Query &Query::bind(unsigned int value) {
+  if (!p->openRow()) return *this;
+  Internal::StringOutputStream os(p->current());
+  Internal::StringWriter(os).Uint(value);
+  p->closeRow();
+  return *this;
+}
+
+/*!
+ * \overload
+ */
+Query &Query::bind(long value) { return bind(static_cast<long long>(value)); }
+
+/*!
+ * \overload
+ */
+Query &Query::bind(unsigned long value) { return bind(static_cast<unsigned long long>(value)); }
+
+/*!
+ * \overload
+ */
+Query &Query::bind(long long value) {
+  if (!p->openRow()) return *this;
+  Internal::StringOutputStream os(p->current());
+  Internal::StringWriter(os).Int64(value);
+  p->closeRow();
+  return *this;
+}
+
+/*!
+ * \overload
+ */
+Query &Query::bind(unsigned long long value) {
+  if (!p->openRow()) return *this;
+  Internal::StringOutputStream os(p->current());
+  Internal::StringWriter(os).Uint64(value);
+  p->closeRow();
+  return *this;
+}
+
+/*!
+ * Appends the floating point number \a value to the current row of arguments and returns a
+ * reference to this query. Since JSON cannot represent them, NaN and infinity are bound as null.
+ */
+Query &Query::bind(double value) {
+  if (!p->openRow()) return *this;
+  Internal::StringOutputStream os(p->current());
+  if (!Internal::StringWriter(os).Double(value)) p->current().append("null");
+  p->closeRow();
+  return *this;
+}
+
+/*!
+ * Appends the null-terminated string \a value to the current row of arguments and returns a
+ * reference to this query.
+ */
+Query &Query::bind(const char *value) {
+  if (!value) return bindNull();
+  return bind(value, std::char_traits<char>::length(value));
+}
+
+/*!
+ * Appends the string \a value of \a length characters to the current row of arguments and returns
+ * a reference to this query. The string may contain null characters.
+ */
+Query &Query::bind(const char *value, std::size_t length) {
+  if (!p->openRow()) return *this;
+  Internal::StringOutputStream os(p->current());
+  Internal::StringWriter(os).String(value, static_cast<rapidjson::SizeType>(length));
+  p->closeRow();
+  return *this;
+}
+
+/*!
+ * \overload
+ */
+Query &Query::bind(const std::string &value) { return bind(value.data(), value.size()); }
+
+/*!
+ * Appends null to the current row of arguments and returns a reference to this query.
+ */
+Query &Query::bindNull() {
+  if (!p->openRow()) return *this;
+  p->current().append("null");
+  p->closeRow();
+  return *this;
+}
+
+/*!
+ * Finishes the current row of arguments and moves it to the bulk arguments, which turns the query
+ * into a bulk operation. Returns a reference to this query.
+ *
+ * Call this function after each row of a bulk operation, including the last one. Values bound
+ * after the last call form an unfinished row. It is neither part of the bulk arguments nor
+ * reported by arguments(), so it is not sent.
+ */
+Query &Query::nextRow() {
+  std::string &row = p->current();
+  if (row.empty()) row = "[]";
+  p->bulkArgs.append(row);
+  row.clear();
+  return *this;
+}
+
+/*!
+ * Clears the arguments and the bulk arguments.
+ */
+void Query::clearArguments() {
+  p->args.clear();
+  p->bulkArgs.clear();
+  p->row.clear();
+}
 
 }  // namespace CppCrate
@@ -16,6 +16,7 @@
 
 #include <cppcrate/record.h>
 #include "global_p.h"
+#include "record_p.h"
 
 #include <cppcrate/value.h>
 
@@ -46,11 +47,75 @@ namespace CppCrate {
  */
 
 /// \cond INTERNAL
-class Record::Private {
- public:
-  bool operator==(const Private &other) const { return values == other.values; }
-  std::vector<Value> values;
-};
+bool Record::Private::operator==(const Private &other) const {
+  const std::size_t total = size();
+  if (total != other.size()) return false;
+  for (std::size_t i = 0; i < total; ++i) {
+    if (value(i) != other.value(i)) return false;
+  }
+  return true;
+}
+
+Record Record::Private::create(const SharedDataPointer<ReplyData> &data,
+                               const rapidjson::Value *row,
+                               const SharedDataPointer<ColumnSchema> &schema) {
+  Record r;
+  *r.p = Private(data, row, schema);
+  return r;
+}
+
+// Creates the value at position \a pos from the JSON document. The value shares the column's meta
+// information, so that only strings longer than Value::SmallStringSize need an allocation.
+Value Record::Private::value(std::size_t pos) const {
+  const rapidjson::Value &v = (*row)[static_cast<rapidjson::SizeType>(pos)];
+  const ValueMeta *meta = schema->meta(pos);
+  const CrateDataType::Type type = meta ? meta->type.type() : CrateDataType::NotSupported;
+
+  // Because numbers are most likely the standard value process them prioritized.
+  if (v.IsNumber()) {
+    switch (type) {
+      case CppCrate::CrateDataType::Byte:
+      case CppCrate::CrateDataType::Short:
+        if (v.IsInt()) return Value(meta, static_cast<int16_t>(v.GetInt()));
+        break;
+      case CppCrate::CrateDataType::Integer:
+        if (v.IsInt()) return Value(meta, static_cast<int32_t>(v.GetInt()));
+        break;
+      case CppCrate::CrateDataType::Long:
+      case CppCrate::CrateDataType::Timestamp:
+        if (v.IsInt64()) return Value(meta, static_cast<int64_t>(v.GetInt64()));
+        break;
+      case CppCrate::CrateDataType::Double:
+        if (v.IsDouble()) return Value(meta, v.GetDouble());
+        break;
+      case CppCrate::CrateDataType::Float:
+        if (v.IsDouble()) return Value(meta, v.GetFloat());
+        break;
+      default:
+        break;
+    }
+    // Fall trough in order to add an invalid value.
+  } else {
+    if (v.IsNull()) return Value(meta, Value::NullType);
+    if (v.IsString()) return Value(meta, v.GetString(), v.GetStringLength());
+    if (v.IsBool()) return Value(meta, v.GetBool());
+    // Objects and arrays are returned as received by Crate, which is also the fall back.
+  }
+
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  v.Accept(writer);
+  return Value(meta, sb.GetString(), sb.GetSize());
+}
+
+// Creates all values at once. Needed only for the iterator based access.
+void Record::Private::materialize() {
+  const std::size_t total = size();
+  if (values.size() == total) return;
+  values.clear();
+  values.reserve(total);
+  for (std::size_t i = 0; i < total; ++i) values.push_back(value(i));
+}
 /// \endcond
 
 CPPCRATE_PIMPL_IMPLEMENT_ALL(Record)
@@ -63,192 +128,77 @@ Record::Record() : p(new Private) {}
 /*!
  * Constructs a record holding the values as defined in \a data. The values' names are defined by
  * \a names and their types by \a types.
+ *
+ * \note Records obtained from a Result do not use this constructor. They refer to the result's
+ *       reply directly and create their values only when accessed.
  */
 Record::Record(const std::string &data, const std::vector<std::string> &names,
                const std::vector<CrateDataType> &types)
     : p(new Private) {
-  rapidjson::Document doc;
-  doc.Parse(data);
-  if (doc.HasParseError() || !doc.IsArray()) {
-    return;
-  }
-
-  for (unsigned int i = 0; i < doc.Size(); ++i) {
-    const rapidjson::Value &v = doc[i];
-    const std::string name = i < names.size() ? names[i] : "";
-    const CrateDataType type =
-        i < types.size() ? types[i] : CrateDataType(CrateDataType::NotSupported);
-
-    // Because numbers are most likely the standard value process them prioritized.
-    if (v.IsNumber()) {
-      switch (type.type()) {
-        case CppCrate::CrateDataType::Byte:
-        case CppCrate::CrateDataType::Short:
-          if (v.IsInt()) {
-#ifdef ENABLE_CPP11_SUPPORT
-            p->values.emplace_back(name, type, static_cast<int16_t>(v.GetInt()));
-#else
-            p->values.push_back(Value(name, type, static_cast<int16_t>(v.GetInt())));
-#endif
-            continue;
-          }
-          break;
-        case CppCrate::CrateDataType::Integer:
-          if (v.IsInt()) {
-#ifdef ENABLE_CPP11_SUPPORT
-            p->values.emplace_back(name, type, static_cast<int32_t>(v.GetInt()));
-#else
-            p->values.push_back(Value(name, type, static_cast<int32_t>(v.GetInt())));
-#endif
-            continue;
-          }
-          break;
-        case CppCrate::CrateDataType::Long:
-          if (v.IsInt64()) {
-#ifdef ENABLE_CPP11_SUPPORT
-            p->values.emplace_back(name, type, static_cast<int64_t>(v.GetInt64()));
-#else
-            p->values.push_back(Value(name, type, static_cast<int64_t>(v.GetInt64())));
-#endif
-            continue;
-          }
-          break;
-        case CppCrate::CrateDataType::Double:
-          if (v.IsDouble()) {
-#ifdef ENABLE_CPP11_SUPPORT
-            p->values.emplace_back(name, type, v.GetDouble());
-#else
-            p->values.push_back(Value(name, type, v.GetDouble()));
-#endif
-            continue;
-          }
-          break;
-        case CppCrate::CrateDataType::Float:
-          if (v.IsDouble()) {
-#ifdef ENABLE_CPP11_SUPPORT
-            p->values.emplace_back(name, type, v.GetFloat());
-#else
-            p->values.push_back(Value(name, type, v.GetFloat()));
-#endif
-            continue;
-          }
-          break;
-        case CppCrate::CrateDataType::Timestamp:
-          if (v.IsInt64()) {
-#ifdef ENABLE_CPP11_SUPPORT
-            p->values.emplace_back(name, type, static_cast<int64_t>(v.GetInt64()));
-#else
-            p->values.push_back(Value(name, type, static_cast<int64_t>(v.GetInt64())));
-#endif
-            continue;
-          }
-          break;
-        default:
-          break;
-      }
-      // Fall trough in order to add an invalid value.
-    } else {
-      if (v.IsNull()) {
-#ifdef ENABLE_CPP11_SUPPORT
-        p->values.emplace_back(type, true);
-#else
-        p->values.push_back(Value(type, true));
-#endif
-        continue;
-      }
-
-      if (v.IsString()) {
-#ifdef ENABLE_CPP11_SUPPORT
-        p->values.emplace_back(name, type, std::string(v.GetString(), v.GetStringLength()));
-#else
-        p->values.push_back(Value(name, type, std::string(v.GetString(), v.GetStringLength())));
-#endif
-        continue;
-      }
-
-      if (v.IsBool()) {
-#ifdef ENABLE_CPP11_SUPPORT
-        p->values.emplace_back(name, type, v.GetBool());
-#else
-        p->values.push_back(Value(name, type, v.GetBool()));
-#endif
-        continue;
-      }
-
-      if (v.IsObject() || v.IsArray()) {
-        rapidjson::StringBuffer sb;
-        rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-        v.Accept(writer);
-#ifdef ENABLE_CPP11_SUPPORT
-        p->values.emplace_back(name, type, std::string(sb.GetString(), sb.GetSize()));
-#else
-        p->values.push_back(Value(name, type, std::string(sb.GetString(), sb.GetSize())));
-#endif
-        continue;
-      }
-      // Fall trough in order to add an invalid value.
-    }
-
-    // Fall back: Add "invalid" node
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    v.Accept(writer);
-#ifdef ENABLE_CPP11_SUPPORT
-    p->values.emplace_back(name, type, std::string(sb.GetString(), sb.GetSize()));
-#else
-    p->values.push_back(Value(name, type, std::string(sb.GetString(), sb.GetSize())));
-#endif
-  }
+  const SharedDataPointer<ReplyData> reply(new ReplyData(data));
+  if (reply->document.HasParseError()) return;
+  *p = Private(reply, &reply->document,
+               SharedDataPointer<ColumnSchema>(new ColumnSchema(names, types)));
 }
 
 /*!
  * Returns a const iterator to the first value contained in this result.
  */
-Record::const_iterator Record::begin() { return p->values.begin(); }
+Record::const_iterator Record::begin() {
+  p->materialize();
+  return p->values.begin();
+}
 
 /*!
  * Returns a const iterator positioned after the last value contained in this result.
  */
-Record::const_iterator Record::end() { return p->values.end(); }
+Record::const_iterator Record::end() {
+  p->materialize();
+  return p->values.end();
+}
 
 #ifdef ENABLE_CPP11_SUPPORT
 /*!
  * Returns a const iterator to the first value contained in this result.
  */
-Record::const_iterator Record::cbegin() { return p->values.cbegin(); }
+Record::const_iterator Record::cbegin() {
+  p->materialize();
+  return p->values.cbegin();
+}
 
 /*!
  * Returns a const iterator positioned after the last value contained in this result.
  */
-Record::const_iterator Record::cend() { return p->values.cend(); }
+Record::const_iterator Record::cend() {
+  p->materialize();
+  return p->values.cend();
+}
 #endif
 
 /*!
  * Returns the size of the values contained in the record.
  */
-int Record::size() const { return int(p->values.size()); }
+int Record::size() const { return int(p->size()); }
 
 /*!
  * Returns the value at position \a pos or an empty value if \a pos is invalid.
  */
 Value Record::value(int pos) const {
   unsigned upos = unsigned(pos);
-  if (upos < p->values.size()) return p->values[upos];
+  if (upos < p->size()) return p->value(upos);
   return Value();
 }
 
 /*!
  * Returns the value with the name \a name or an empty value if \a name does not exists.
  *
- * \note This value is slower than the index based variant. So if you know the value's position
- *       you might want to use value() with the index.
+ * The name is looked up in a hash table shared by all records of a result. If you access the same
+ * column in many records resolve its position once using Result::columnIndex() and pass it to
+ * value(int).
  */
 Value Record::value(const std::string &name) const {
-  for (std::vector<Value>::const_iterator it = p->values.begin(), end = p->values.end(); it != end;
-       ++it) {
-    if (it->name() == name) return *it;
-  }
-  return Value();
+  if (!p->row) return Value();
+  return value(p->schema->indexOf(name));
 }
 
 }  // namespace CppCrate
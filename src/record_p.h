@@ -0,0 +1,132 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/cratedatatype.h>
+#include <cppcrate/record.h>
+#include <cppcrate/value.h>
+
+#include "shareddata.h"
+#include "value_p.h"
+
+#include <rapidjson/document.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#ifdef ENABLE_CPP11_SUPPORT
+#include <unordered_map>
+#else
+#include <map>
+#endif
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+// Column names and types that are shared by all records of a result.
+class ColumnSchema : public SharedData {
+#ifdef ENABLE_CPP11_SUPPORT
+  typedef std::unordered_map<std::string, int> IndexMap;
+#else
+  typedef std::map<std::string, int> IndexMap;
+#endif
+
+ public:
+  ColumnSchema() {}
+  ColumnSchema(const std::vector<std::string>& cols, const std::vector<CrateDataType>& colTypes)
+      : cols(cols), colTypes(colTypes) {
+    update();
+  }
+
+  // Creates the meta information of the values and the name index. Must be called after changing
+  // cols or colTypes.
+  void update() {
+    index.clear();
+    for (std::size_t i = 0, total = cols.size(); i < total; ++i) {
+      // For duplicated names the first column wins.
+      index.insert(IndexMap::value_type(cols[i], static_cast<int>(i)));
+    }
+    metas.clear();
+    for (std::size_t i = 0, total = std::max(cols.size(), colTypes.size()); i < total; ++i) {
+      metas.push_back(SharedDataPointer<ValueMeta>(new ValueMeta(
+          i < cols.size() ? cols[i] : std::string(),
+          i < colTypes.size() ? colTypes[i] : CrateDataType(CrateDataType::NotSupported))));
+    }
+  }
+
+  const ValueMeta* meta(std::size_t pos) const {
+    return pos < metas.size() ? metas[pos].data() : CPPCRATE_NULLPTR;
+  }
+
+  // Returns the position of the column \a name or -1 if there is no such column.
+  int indexOf(const std::string& name) const {
+    const IndexMap::const_iterator it = index.find(name);
+    return it != index.end() ? it->second : -1;
+  }
+
+  std::vector<std::string> cols;
+  std::vector<CrateDataType> colTypes;
+  std::vector<SharedDataPointer<ValueMeta> > metas;
+  IndexMap index;
+};
+
+// A JSON document that is parsed in situ if it is constructed from a JSON text. All strings of the
+// document then point into buffer, so the reply is neither copied again nor re-serialized as long
+// as the document is in use. A default constructed document is left to be parsed by the caller.
+class ReplyData : public SharedData {
+ public:
+  ReplyData() {}
+  explicit ReplyData(const std::string& json) : buffer(json.begin(), json.end()) { parse(); }
+  ReplyData(const char* json, std::size_t length) : buffer(json, json + length) { parse(); }
+
+  std::vector<char> buffer;
+  rapidjson::Document document;
+
+ private:
+  void parse() {
+    buffer.push_back('\0');
+    document.ParseInsitu(&buffer[0]);
+  }
+};
+
+class Record::Private {
+ public:
+  Private() : row(CPPCRATE_NULLPTR) {}
+  Private(const SharedDataPointer<ReplyData>& data, const rapidjson::Value* row,
+          const SharedDataPointer<ColumnSchema>& schema)
+      : data(data), row(row && row->IsArray() ? row : CPPCRATE_NULLPTR), schema(schema) {}
+
+  bool operator==(const Private& other) const;
+
+  static Record create(const SharedDataPointer<ReplyData>& data, const rapidjson::Value* row,
+                       const SharedDataPointer<ColumnSchema>& schema);
+
+  std::size_t size() const { return row ? row->Size() : 0; }
+  Value value(std::size_t pos) const;
+  void materialize();
+
+  SharedDataPointer<ReplyData> data;
+  const rapidjson::Value* row;
+  SharedDataPointer<ColumnSchema> schema;
+
+  // Values are only created if the record is iterated.
+  std::vector<Value> values;
+};
+/// \endcond
+
+}  // namespace CppCrate
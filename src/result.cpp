@@ -15,7 +15,9 @@
  */
 
 #include <cppcrate/result.h>
+#include "column_p.h"
 #include "global_p.h"
+#include "record_p.h"
 
 #include <rapidjson/document.h>
 #include <rapidjson/error/en.h>
@@ -24,6 +26,10 @@
 
 #include <iostream>
 
+#ifdef ENABLE_CPP11_SUPPORT
+#include <mutex>
+#endif
+
 namespace CppCrate {
 
 /*!
@@ -51,23 +57,44 @@ namespace CppCrate {
  */
 
 /// \cond INTERNAL
-class Result::Private {
+// The rows serialized on demand by Result::rows(). They are shared by all copies of a result, so
+// they are serialized at most once.
+class SerializedRows : public SharedData {
  public:
-  Private() : duration(0.0), rowCount(0) {}
+  SerializedRows() : done(false) {}
 
+  std::vector<std::string> rows;
+  bool done;
+#ifdef ENABLE_CPP11_SUPPORT
+  std::mutex mutex;
+#endif
+};
+
+class Result::Private {
+ public:
+  Private()
+      : duration(0.0),
+        rowCount(0),
+        schema(new ColumnSchema),
+        rows(CPPCRATE_NULLPTR),
+        serializedRows(new SerializedRows) {}
+
+  // All other members are derived from the raw result.
   bool operator==(const Private& other) const {
-    return rawResult == other.rawResult && errorString == other.errorString &&
-           duration == other.duration && rowCount == other.rowCount && cols == other.cols &&
-           colTypes == other.colTypes && rows == other.rows;
+    return rawResult == other.rawResult && errorString == other.errorString;
   }
 
   RawResult rawResult;
   std::string errorString;
   double duration;
   int rowCount;
-  std::vector<std::string> cols;
-  std::vector<CrateDataType> colTypes;
-  std::vector<std::string> rows;
+  SharedDataPointer<ColumnSchema> schema;
+
+  // The parsed reply, rows points into it. Records share the reply.
+  SharedDataPointer<ReplyData> reply;
+  const rapidjson::Value* rows;
+
+  SharedDataPointer<SerializedRows> serializedRows;
 };
 /// \endcond
 
@@ -78,9 +105,13 @@ CPPCRATE_PIMPL_IMPLEMENT_ALL(Result)
  */
 Result::Result(const RawResult& raw) : p(new Private) {
   p->rawResult = raw;
+  // The reply is kept by the raw result anyway, so it is not parsed in situ, which would need a
+  // second copy of it.
+  const std::string& reply = p->rawResult.reply();
+  p->reply = SharedDataPointer<ReplyData>(new ReplyData);
+  p->reply->document.Parse(reply.c_str(), reply.size());
 
-  rapidjson::Document doc;
-  doc.Parse(raw.reply());
+  const rapidjson::Document& doc = p->reply->document;
   if (doc.HasParseError()) {
     p->errorString = "[json] Parse error at offset " + CPPCRATE_TO_STRING(doc.GetErrorOffset()) +
                      ": " + rapidjson::GetParseError_En(doc.GetParseError());
@@ -92,9 +123,9 @@ Result::Result(const RawResult& raw) : p(new Private) {
 
   if (doc.HasMember("error")) {
     if (doc["error"].IsObject()) {
-      rapidjson::Value& error = doc["error"];
+      const rapidjson::Value& error = doc["error"];
       if (error.HasMember("component")) {
-        rapidjson::Value& component = error["component"];
+        const rapidjson::Value& component = error["component"];
         if (component.IsString()) {
           p->errorString.append(
               "[" + std::string(component.GetString(), component.GetStringLength()) + "] ");
@@ -105,7 +136,7 @@ Result::Result(const RawResult& raw) : p(new Private) {
         p->errorString.append("[crate] ");
       }
       if (error.HasMember("message")) {
-        rapidjson::Value& message = error["message"];
+        const rapidjson::Value& message = error["message"];
         if (message.IsString()) {
           p->errorString.append(std::string(message.GetString(), message.GetStringLength()));
         } else {
@@ -113,7 +144,7 @@ Result::Result(const RawResult& raw) : p(new Private) {
         }
       }
       if (error.HasMember("code")) {
-        rapidjson::Value& code = error["code"];
+        const rapidjson::Value& code = error["code"];
         if (code.IsInt()) {
           p->errorString.append(" (" + CPPCRATE_TO_STRING(code.GetInt()) + ")");
         }
@@ -166,6 +197,7 @@ Result::Result(const RawResult& raw) : p(new Private) {
     }
   }
 
+  ColumnSchema* schema = p->schema.data();
   if (doc.HasMember("cols")) {
     const rapidjson::Value& cols = doc["cols"];
     if (cols.IsArray()) {
@@ -173,15 +205,15 @@ Result::Result(const RawResult& raw) : p(new Private) {
            ++it) {
         if (it->IsString()) {
 #ifdef ENABLE_CPP11_SUPPORT
-          p->cols.emplace_back(it->GetString(), it->GetStringLength());
+          schema->cols.emplace_back(it->GetString(), it->GetStringLength());
 #else
-          p->cols.push_back(std::string(it->GetString(), it->GetStringLength()));
+          schema->cols.push_back(std::string(it->GetString(), it->GetStringLength()));
 #endif
         } else {
 #ifdef ENABLE_CPP11_SUPPORT
-          p->cols.emplace_back("");
+          schema->cols.emplace_back("");
 #else
-          p->cols.push_back("");
+          schema->cols.push_back("");
 #endif
         }
       }
@@ -208,29 +240,19 @@ Result::Result(const RawResult& raw) : p(new Private) {
           }
         }
 #ifdef ENABLE_CPP11_SUPPORT
-        p->colTypes.emplace_back(type, definition);
+        schema->colTypes.emplace_back(type, definition);
 #else
-        p->colTypes.push_back(CrateDataType(type, definition));
+        schema->colTypes.push_back(CrateDataType(type, definition));
 #endif
       }
     }
   }
 
+  schema->update();
+
   if (doc.HasMember("rows")) {
     const rapidjson::Value& rows = doc["rows"];
-    if (rows.IsArray()) {
-      for (rapidjson::Value::ConstValueIterator it = rows.Begin(), total = rows.End(); it != total;
-           ++it) {
-        rapidjson::StringBuffer sb;
-        rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-        it->Accept(writer);
-#ifdef ENABLE_CPP11_SUPPORT
-        p->rows.emplace_back(sb.GetString(), sb.GetSize());
-#else
-        p->rows.push_back(std::string(sb.GetString(), sb.GetSize()));
-#endif
-      }
-    }
+    if (rows.IsArray()) p->rows = &rows;
   }
 }
 
@@ -272,22 +294,46 @@ int Result::rowCount() const { return p->rowCount; }
 /*!
  * Returns the query's column names.
  */
-const std::vector<std::string>& Result::cols() const { return p->cols; }
+const std::vector<std::string>& Result::cols() const { return p->schema->cols; }
 
 /*!
  * Returns the query's column types.
  */
-const std::vector<CrateDataType>& Result::colTypes() const { return p->colTypes; }
+const std::vector<CrateDataType>& Result::colTypes() const { return p->schema->colTypes; }
 
 /*!
- * Returns the query's rows.
+ * Returns the query's rows as JSON arrays.
+ *
+ * \note The rows are serialized on the first call. To access the rows' values use record(), which
+ *       reads them directly from the parsed reply.
  */
-const std::vector<std::string>& Result::rows() const { return p->rows; }
+const std::vector<std::string>& Result::rows() const {
+  SerializedRows& serialized = *p->serializedRows;
+  CPPCRATE_LOCK_GUARD(serialized.mutex);
+  if (!serialized.done) {
+    serialized.done = true;
+    if (p->rows) {
+      serialized.rows.reserve(p->rows->Size());
+      for (rapidjson::Value::ConstValueIterator it = p->rows->Begin(), end = p->rows->End();
+           it != end; ++it) {
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+        it->Accept(writer);
+#ifdef ENABLE_CPP11_SUPPORT
+        serialized.rows.emplace_back(sb.GetString(), sb.GetSize());
+#else
+        serialized.rows.push_back(std::string(sb.GetString(), sb.GetSize()));
+#endif
+      }
+    }
+  }
+  return serialized.rows;
+}
 
 /*!
  * Returns the amount of records that can be fetched using record().
  */
-int Result::recordSize() const { return static_cast<int>(p->rows.size()); }
+int Result::recordSize() const { return p->rows ? static_cast<int>(p->rows->Size()) : 0; }
 
 /*!
  * Returns the record on the position \a pos. If \a pos is outside the record's boundaries an empty
@@ -298,9 +344,70 @@ Record Result::record(int pos) const {
     return Record();
   }
 
-  const std::size_t index = static_cast<std::size_t>(pos);
-  if (index >= p->rows.size()) return Record();
-  return Record(p->rows[index], p->cols, p->colTypes);
+  const rapidjson::SizeType index = static_cast<rapidjson::SizeType>(pos);
+  if (!p->rows || index >= p->rows->Size()) return Record();
+  return Record::Private::create(p->reply, &(*p->rows)[index], p->schema);
 }
 
+/*!
+ * Returns the cell of the column at position \a column in the row \a row. If \a row or \a column
+ * are outside the result's boundaries an invalid cell is returned.
+ *
+ * The cell refers to the reply of this result, so it must not outlive the result.
+ *
+ * \sa Mapping
+ */
+Cell Result::cell(int row, int column) const {
+  if (row < 0 || column < 0 || !p->rows) return Cell();
+  const rapidjson::SizeType r = static_cast<rapidjson::SizeType>(row);
+  if (r >= p->rows->Size()) return Cell();
+  const rapidjson::Value& values = (*p->rows)[r];
+  const rapidjson::SizeType c = static_cast<rapidjson::SizeType>(column);
+  if (!values.IsArray() || c >= values.Size()) return Cell();
+  return Cell(&values[c]);
+}
+
+/*!
+ * Returns the values of the column at position \a index of all rows. If \a index is outside the
+ * columns' boundaries an invalid column is returned.
+ *
+ * The column is decoded from the reply on every call, so keep the returned column instead of
+ * calling this function repeatedly.
+ *
+ * \sa Column
+ */
+Column Result::column(int index) const {
+  const std::vector<std::string>& cols = p->schema->cols;
+  const std::size_t i = static_cast<std::size_t>(index);
+  if (index < 0 || i >= cols.size()) return Column();
+
+  const std::vector<CrateDataType>& colTypes = p->schema->colTypes;
+  return Column::Private::decode(p->rows, i, cols[i],
+                                 i < colTypes.size() ? colTypes[i] : CrateDataType());
+}
+
+/*!
+ * Returns the values of the column named \a name of all rows. If there is no such column an
+ * invalid column is returned.
+ *
+ * \sa column(int)
+ */
+Column Result::column(const std::string& name) const {
+  return column(p->schema->indexOf(name));
+}
+
+/*!
+ * Returns the position of the column named \a name or -1 if there is no such column. If the name
+ * is used by more than one column the first position is returned.
+ *
+ * The position is valid for all records of this result, so resolve it once before iterating:
+ * \code
+ * const int name = result.columnIndex("name");
+ * for (int i = 0, total = result.recordSize(); i < total; ++i) {
+ *   std::cout << result.record(i).value(name).asString() << "\n";
+ * }
+ * \endcode
+ */
+int Result::columnIndex(const std::string& name) const { return p->schema->indexOf(name); }
+
 }  // namespace CppCrate
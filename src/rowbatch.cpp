@@ -0,0 +1,196 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cppcrate/rowbatch.h>
+#include "global_p.h"
+
+#include <algorithm>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::RowBatch
+ *
+ * \brief Holds the rows of a bulk operation in a single buffer.
+ *
+ * The class %RowBatch holds the argument rows of a bulk operation. In contrast to a
+ * \c std::vector<std::string> all rows are stored in one growing buffer that already is the JSON
+ * array sent to Crate, so appending a row is a single copy and executing the query does not need to
+ * join the rows again:
+ * \code
+ * RowBatch batch;
+ * batch.append("[1,\"Calvin\"]");
+ * batch.append("[2,\"Hobbes\"]");
+ * batch.json();  // [[1,"Calvin"],[2,"Hobbes"]]
+ * client.exec(Query("INSERT INTO players (id, name) VALUES (?,?)", batch));
+ * \endcode
+ *
+ * The position of every row inside the buffer is kept, so single rows can still be accessed with
+ * row() and consecutive rows can be copied with slice().
+ *
+ * \sa Query::bind()
+ */
+
+/// \cond INTERNAL
+class RowBatch::Private {
+ public:
+  bool operator==(const Private &other) const { return json == other.json; }
+
+  // Returns the end of the row at pos, which is the position of the following comma or of the
+  // closing bracket.
+  std::size_t end(std::size_t pos) const {
+    return pos + 1 < offsets.size() ? offsets[pos + 1] - 1 : json.size() - 1;
+  }
+
+  // The rows as JSON array, or empty if there are no rows.
+  std::string json;
+  // The position of every row in json.
+  std::vector<std::size_t> offsets;
+};
+/// \endcond
+
+CPPCRATE_PIMPL_IMPLEMENT_ALL(RowBatch)
+
+/*!
+ * Constructs an empty batch.
+ */
+RowBatch::RowBatch() : p(new Private) {}
+
+/*!
+ * Constructs a batch holding \a rows.
+ *
+ * \pre The elements of \a rows must be well-formed JSON arrays.
+ */
+RowBatch::RowBatch(const std::vector<std::string> &rows) : p(new Private) {
+  std::size_t bytes = 1;
+  for (std::size_t i = 0, total = rows.size(); i < total; ++i) bytes += rows[i].size() + 1;
+  reserve(bytes);
+  for (std::size_t i = 0, total = rows.size(); i < total; ++i) append(rows[i]);
+}
+
+/*!
+ * Returns \c true if the batch has no rows.
+ */
+bool RowBatch::isEmpty() const { return p->offsets.empty(); }
+
+/*!
+ * Returns the number of rows.
+ */
+int RowBatch::size() const { return static_cast<int>(p->offsets.size()); }
+
+/*!
+ * Reserves \a bytes characters for the buffer. Use it to avoid reallocations if the size of all
+ * rows is known in advance.
+ */
+void RowBatch::reserve(std::size_t bytes) { p->json.reserve(bytes); }
+
+/*!
+ * Removes all rows. The buffer keeps its capacity.
+ */
+void RowBatch::clear() {
+  p->json.clear();
+  p->offsets.clear();
+}
+
+/*!
+ * Appends \a row.
+ *
+ * \pre \a row must be a well-formed JSON array.
+ */
+void RowBatch::append(const std::string &row) { append(row.data(), row.size()); }
+
+/*!
+ * Appends \a row of \a length characters.
+ *
+ * \pre \a row must be a well-formed JSON array.
+ */
+void RowBatch::append(const char *row, std::size_t length) {
+  if (p->json.empty()) {
+    p->json.push_back('[');
+  } else {
+    p->json[p->json.size() - 1] = ',';
+  }
+  p->offsets.push_back(p->json.size());
+  p->json.append(row, length);
+  p->json.push_back(']');
+}
+
+/*!
+ * Appends all rows of \a other.
+ */
+void RowBatch::append(const RowBatch &other) {
+  if (other.isEmpty()) return;
+  if (isEmpty()) {
+    *this = other;
+    return;
+  }
+  const std::size_t shift = p->json.size();
+  p->json[shift - 1] = ',';
+  p->json.append(other.p->json, 1, std::string::npos);
+  for (std::size_t i = 0, total = other.p->offsets.size(); i < total; ++i) {
+    p->offsets.push_back(other.p->offsets[i] - 1 + shift);
+  }
+}
+
+/*!
+ * Returns the row at position \a pos or an empty string if \a pos is invalid.
+ */
+std::string RowBatch::row(int pos) const {
+  const std::size_t i = static_cast<std::size_t>(pos);
+  if (pos < 0 || i >= p->offsets.size()) return std::string();
+  return p->json.substr(p->offsets[i], p->end(i) - p->offsets[i]);
+}
+
+/*!
+ * Returns all rows as separate strings.
+ */
+std::vector<std::string> RowBatch::rows() const {
+  std::vector<std::string> rows;
+  rows.reserve(p->offsets.size());
+  for (int i = 0, total = size(); i < total; ++i) rows.push_back(row(i));
+  return rows;
+}
+
+/*!
+ * Returns a batch holding \a count rows starting at position \a pos. The range is limited to the
+ * rows of this batch.
+ */
+RowBatch RowBatch::slice(int pos, int count) const {
+  RowBatch batch;
+  if (pos < 0) {
+    count += pos;
+    pos = 0;
+  }
+  if (count <= 0 || pos >= size()) return batch;
+  const std::size_t first = static_cast<std::size_t>(pos);
+  const std::size_t last = std::min(first + static_cast<std::size_t>(count), p->offsets.size()) - 1;
+
+  const std::size_t begin = p->offsets[first];
+  const std::size_t end = p->end(last);
+  batch.p->json.reserve(end - begin + 2);
+  batch.p->json.push_back('[');
+  batch.p->json.append(p->json, begin, end - begin);
+  batch.p->json.push_back(']');
+  for (std::size_t i = first; i <= last; ++i) batch.p->offsets.push_back(p->offsets[i] - begin + 1);
+  return batch;
+}
+
+/*!
+ * Returns all rows as a single JSON array or an empty string if the batch has no rows.
+ */
+const std::string &RowBatch::json() const { return p->json; }
+
+}  // namespace CppCrate
@@ -0,0 +1,584 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cppcrate/result.h>
+#include <cppcrate/rowcursor.h>
+#include "connection.h"
+#include "global_p.h"
+#include "record_p.h"
+#include "rowcursor_p.h"
+
+#include <rapidjson/error/en.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::RowCursor
+ *
+ * \brief Provides the rows of a query one at a time while they are still being received.
+ *
+ * In contrast to Result, which needs the complete reply in memory, a %RowCursor decodes the reply
+ * of Crate's HTTP endpoint incrementally as it arrives. Every decoded row is handed out as a Record
+ * and dropped as soon as the next row is requested. This way arbitrarily large result sets can be
+ * processed with bounded memory and the processing starts before the transfer has finished.
+ *
+ * A cursor is obtained by Client::query(). Use next() to advance to the next row and record() to
+ * access it:
+ * \code
+ * RowCursor cursor = client.query("SELECT name FROM players");
+ * while (cursor.next()) {
+ *   std::cout << cursor.record().value("name").asString() << "\n";
+ * }
+ * if (cursor.hasError()) {
+ *   std::cout << cursor.errorString() << "\n";
+ * }
+ * \endcode
+ *
+ * The reply is received and decoded by a background thread that stays at most a configurable
+ * number of rows ahead of the caller. If the caller does not keep up, the transfer is paused until
+ * rows are consumed.
+ *
+ * \note A cursor uses the nodes of the client that created it. Thus the client must neither be
+ *       disconnected nor destroyed while a cursor is in use.
+ *
+ * \note %RowCursor is only available if %CppCrate is build with C++11 support.
+ */
+
+/// \cond INTERNAL
+RowCursor::Private::~Private() {
+  {
+    CPPCRATE_LOCK_GUARD(mutex);
+    cancelled = true;
+  }
+  space.notify_all();
+#ifdef CPPCRATE_HAS_MULTI_WAKEUP
+  if (multi) curl_multi_wakeup(multi);
+#endif
+  if (thread.joinable()) thread.join();
+
+  if (multi) {
+    curl_multi_remove_handle(multi, connection->handle());
+    curl_multi_cleanup(multi);
+  }
+  delete connection;
+}
+
+// Input stream for rapidjson::Reader that pulls the reply from the transfer on demand.
+class RowCursor::Private::ReplyStream {
+ public:
+  typedef char Ch;
+
+  explicit ReplyStream(RowCursor::Private& cursor)
+      : cursor(cursor), chunk(cursor.chunk), pos(0), offset(0) {}
+
+  Ch Peek() { return available() ? chunk[pos] : '\0'; }
+  Ch Take() {
+    if (!available()) return '\0';
+    ++offset;
+    return chunk[pos++];
+  }
+  std::size_t Tell() const { return offset; }
+
+  Ch* PutBegin() {
+    RAPIDJSON_ASSERT(false);
+    return CPPCRATE_NULLPTR;
+  }
+  void Put(Ch) { RAPIDJSON_ASSERT(false); }
+  void Flush() { RAPIDJSON_ASSERT(false); }
+  std::size_t PutEnd(Ch*) {
+    RAPIDJSON_ASSERT(false);
+    return 0;
+  }
+
+ private:
+  bool available() {
+    if (pos < chunk.size()) return true;
+    chunk.clear();
+    pos = 0;
+    return cursor.receive();
+  }
+
+  RowCursor::Private& cursor;
+  std::string& chunk;
+  std::size_t pos;
+  std::size_t offset;
+};
+
+// SAX handler that collects the reply's meta information and hands out every row as soon as it is
+// complete. Rows and column types are captured by forwarding their events to a writer.
+class RowCursor::Private::ReplyHandler {
+ public:
+  explicit ReplyHandler(RowCursor::Private& cursor)
+      : rowCount(0),
+        duration(0.0),
+        cursor(cursor),
+        section(OtherSection),
+        depth(0),
+        capturing(false),
+        captureDepth(0),
+        children(0),
+        first(false),
+        type(CrateDataType::NotSupported) {}
+
+  bool Null() {
+    if (!enter()) return plain();
+    writer.Null();
+    return leave();
+  }
+  bool Bool(bool b) {
+    if (!enter()) return plain();
+    writer.Bool(b);
+    return leave();
+  }
+  bool Int(int i) {
+    number(i);
+    if (!enter()) return plain();
+    setType(i);
+    writer.Int(i);
+    return leave();
+  }
+  bool Uint(unsigned u) {
+    number(u);
+    if (!enter()) return plain();
+    setType(u);
+    writer.Uint(u);
+    return leave();
+  }
+  bool Int64(int64_t i) {
+    number(static_cast<double>(i));
+    if (!enter()) return plain();
+    writer.Int64(i);
+    return leave();
+  }
+  bool Uint64(uint64_t u) {
+    number(static_cast<double>(u));
+    if (!enter()) return plain();
+    writer.Uint64(u);
+    return leave();
+  }
+  bool Double(double d) {
+    number(d);
+    if (!enter()) return plain();
+    writer.Double(d);
+    return leave();
+  }
+  bool RawNumber(const char* str, rapidjson::SizeType length, bool copy) {
+    if (!enter()) return plain();
+    writer.RawNumber(str, length, copy);
+    return leave();
+  }
+  bool String(const char* str, rapidjson::SizeType length, bool copy) {
+    if (!enter()) return plain(std::string(str, length));
+    writer.String(str, length, copy);
+    return leave();
+  }
+  bool StartObject() {
+    if (enter()) {
+      writer.StartObject();
+    } else {
+      plain();
+    }
+    ++depth;
+    return true;
+  }
+  bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+    if (capturing) return writer.Key(str, length, copy);
+    if (depth == 1) {
+      const std::string key(str, length);
+      if (key == "cols") {
+        section = ColsSection;
+      } else if (key == "col_types") {
+        section = ColTypesSection;
+      } else if (key == "rows") {
+        section = RowsSection;
+        schema = SharedDataPointer<ColumnSchema>(new ColumnSchema(names, types));
+        cursor.setColumns(names, types);
+      } else if (key == "rowcount") {
+        section = RowCountSection;
+      } else if (key == "duration") {
+        section = DurationSection;
+      } else if (key == "error") {
+        section = ErrorSection;
+      } else {
+        section = OtherSection;
+      }
+    }
+    return true;
+  }
+  bool EndObject(rapidjson::SizeType memberCount) {
+    --depth;
+    if (!capturing) return true;
+    writer.EndObject(memberCount);
+    return leave();
+  }
+  bool StartArray() {
+    if (enter()) {
+      writer.StartArray();
+    } else {
+      plain();
+    }
+    ++depth;
+    return true;
+  }
+  bool EndArray(rapidjson::SizeType elementCount) {
+    --depth;
+    if (!capturing) return true;
+    writer.EndArray(elementCount);
+    return leave();
+  }
+
+  const std::vector<std::string>& cols() const { return names; }
+  const std::vector<CrateDataType>& colTypes() const { return types; }
+  const std::string& errorString() const { return error; }
+
+  int rowCount;
+  double duration;
+
+ private:
+  enum Section {
+    OtherSection,
+    ColsSection,
+    ColTypesSection,
+    RowsSection,
+    RowCountSection,
+    DurationSection,
+    ErrorSection
+  };
+
+  // Called before every value. Returns whether the value is part of a captured element.
+  bool enter() {
+    if (capturing) {
+      first = depth == captureDepth + 1 && children++ == 0;
+      return true;
+    }
+
+    if (section == ColTypesSection || section == RowsSection) {
+      if (depth != 2) return false;
+    } else if (section == ErrorSection) {
+      if (depth != 1) return false;
+    } else {
+      return false;
+    }
+
+    capturing = true;
+    captureDepth = depth;
+    children = 0;
+    first = true;
+    type = CrateDataType::NotSupported;
+    buffer.Clear();
+    writer.Reset(buffer);
+    return true;
+  }
+
+  // Called after every value. Finishes the captured element once it is complete.
+  bool leave() {
+    if (depth != captureDepth) return true;
+    capturing = false;
+
+    switch (section) {
+      case ColTypesSection:
+        types.emplace_back(type, std::string(buffer.GetString(), buffer.GetSize()));
+        break;
+      case RowsSection: {
+        const SharedDataPointer<ReplyData> row(
+            new ReplyData(buffer.GetString(), buffer.GetSize()));
+        return cursor.push(Record::Private::create(row, &row->document, schema));
+      }
+      case ErrorSection: {
+        std::string reply = "{\"error\":";
+        reply.append(buffer.GetString(), buffer.GetSize()).append("}");
+        error = Result(RawResult(reply)).errorString();
+        break;
+      }
+      default:
+        break;
+    }
+    return true;
+  }
+
+  // Handles values that are not captured.
+  bool plain(const std::string& text = std::string()) {
+    if (section == ColsSection && depth == 2) {
+      names.emplace_back(text);
+    }
+    return true;
+  }
+
+  void number(double value) {
+    if (capturing || depth != 1) return;
+    if (section == RowCountSection) {
+      rowCount = static_cast<int>(value);
+    } else if (section == DurationSection) {
+      duration = value;
+    }
+  }
+
+  void setType(int value) {
+    if (section == ColTypesSection && first) type = CrateDataType::convert(value);
+  }
+
+  RowCursor::Private& cursor;
+  Section section;
+  int depth;
+  bool capturing;
+  int captureDepth;
+  int children;
+  bool first;
+  CrateDataType::Type type;
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer;
+  std::vector<std::string> names;
+  std::vector<CrateDataType> types;
+  SharedDataPointer<ColumnSchema> schema;
+  std::string error;
+};
+
+void RowCursor::Private::start(NodeList& nodes, const Query& query,
+                               const std::string& defaultSchema, const Compression& compression,
+                               int bufferedRows) {
+  this->nodes = &nodes;
+  this->query = query;
+  this->defaultSchema = defaultSchema;
+  capacity = bufferedRows > 1 ? static_cast<std::size_t>(bufferedRows) : 1;
+
+  connection = new Connection;
+  connection->setCompression(compression);
+  if (connection->isValid()) multi = curl_multi_init();
+  if (!multi) {
+    finish(Result(RawResult(Connection::errorReply("Could not create a curl handle.", 0, "curl")))
+               .errorString());
+    return;
+  }
+
+  // Without any node the request fails on the empty URL.
+  nodes.next(tries, node);
+  prepare();
+  curl_multi_add_handle(multi, connection->handle());
+
+  finished = false;
+  thread = std::thread(&RowCursor::Private::run, this);
+}
+
+void RowCursor::Private::prepare() {
+  chunk.clear();
+  connection->prepareExec(node, query, defaultSchema);
+  curl_easy_setopt(connection->handle(), CURLOPT_WRITEDATA, &chunk);
+  nodes->setNodeStarted(node);
+}
+
+void RowCursor::Private::finish(const std::string& error) {
+  {
+    CPPCRATE_LOCK_GUARD(mutex);
+    errorString = error;
+    finished = true;
+  }
+  ready.notify_all();
+}
+
+void RowCursor::Private::run() {
+  ReplyStream stream(*this);
+  ReplyHandler handler(*this);
+  rapidjson::Reader reader;
+  const rapidjson::ParseResult result = reader.Parse(stream, handler);
+  // A cancelled transfer is not in flight anymore.
+  if (!done) nodes->setNodeFinished(node, connection->responseTime());
+
+  setColumns(handler.cols(), handler.colTypes());
+  {
+    CPPCRATE_LOCK_GUARD(mutex);
+    rowCount = handler.rowCount;
+    duration = handler.duration;
+  }
+
+  if (done && code != CURLE_OK) {
+    finish(Result(connection->finishExec(code)).errorString());
+  } else if (result.IsError()) {
+    finish("[json] Parse error at offset " + CPPCRATE_TO_STRING(result.Offset()) + ": " +
+           rapidjson::GetParseError_En(result.Code()));
+  } else {
+    finish(handler.errorString());
+  }
+}
+
+// Drives the transfer until new data was received into chunk. Returns false if the transfer is
+// finished or the cursor was cancelled.
+bool RowCursor::Private::receive() {
+  while (!done) {
+    {
+      CPPCRATE_LOCK_GUARD(mutex);
+      if (cancelled) return false;
+    }
+
+    int running = 0;
+    curl_multi_perform(multi, &running);
+
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+      if (msg->msg != CURLMSG_DONE) continue;
+      code = msg->data.result;
+      curl_multi_remove_handle(multi, connection->handle());
+      nodes->setNodeFinished(node, connection->responseTime());
+      if (code == CURLE_OK) {
+        nodes->setNodeSuccess(node, tries);
+      } else if (tries.count > 0) {
+        nodes->setNodeError(node);
+      }
+
+      // Another node may only be tried as long as nothing was handed to the parser.
+      if (code != CURLE_OK && received == 0 && chunk.empty() && tries.count > 0 &&
+          nodes->next(tries, node)) {
+        prepare();
+        curl_multi_add_handle(multi, connection->handle());
+      } else {
+        done = true;
+      }
+    }
+
+    if (!chunk.empty()) {
+      received += chunk.size();
+      return true;
+    }
+    if (done) break;
+
+#ifdef CPPCRATE_HAS_MULTI_WAKEUP
+    curl_multi_poll(multi, CPPCRATE_NULLPTR, 0, 1000, CPPCRATE_NULLPTR);
+#else
+    // Without curl_multi_wakeup() a cancellation is only noticed after the timeout.
+    curl_multi_wait(multi, CPPCRATE_NULLPTR, 0, 100, CPPCRATE_NULLPTR);
+#endif
+  }
+  return false;
+}
+
+// Blocks while the buffer is full. Returns false if the cursor was cancelled.
+bool RowCursor::Private::push(Record&& record) {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (rows.size() >= capacity && !cancelled) space.wait(lock);
+  if (cancelled) return false;
+  rows.push_back(std::move(record));
+  lock.unlock();
+  ready.notify_one();
+  return true;
+}
+
+void RowCursor::Private::setColumns(const std::vector<std::string>& names,
+                                    const std::vector<CrateDataType>& types) {
+  CPPCRATE_LOCK_GUARD(mutex);
+  cols = names;
+  colTypes = types;
+}
+/// \endcond
+
+CPPCRATE_PIMPL_IMPLEMENT_PRIVATE(RowCursor)
+CPPCRATE_PIMPL_IMPLEMENT_MOVE(RowCursor)
+
+/*!
+ * Constructs an empty cursor without any rows.
+ */
+RowCursor::RowCursor() : p(new Private) {}
+
+// Constructs a cursor that failed with \a errorString.
+RowCursor::RowCursor(const std::string& errorString) : p(new Private) {
+  p->finish(errorString);
+}
+
+/*!
+ * Returns whether the cursor is valid.
+ */
+RowCursor::operator bool() const { return !hasError(); }
+
+/*!
+ * Returns whether the cursor has an error. Errors that occur while the rows are received can only
+ * be detected after next() returned \c false.
+ */
+bool RowCursor::hasError() const {
+  CPPCRATE_LOCK_GUARD(p->mutex);
+  return !p->errorString.empty();
+}
+
+/*!
+ * Returns the error string.
+ */
+std::string RowCursor::errorString() const {
+  CPPCRATE_LOCK_GUARD(p->mutex);
+  return p->errorString;
+}
+
+/*!
+ * Advances the cursor to the next row and returns \c true if there is one. Blocks until the next
+ * row is received. Returns \c false if all rows were consumed or an error occurred.
+ *
+ * \sa record()
+ */
+bool RowCursor::next() {
+  std::unique_lock<std::mutex> lock(p->mutex);
+  while (p->rows.empty() && !p->finished) p->ready.wait(lock);
+  if (p->rows.empty()) {
+    p->record = Record();
+    return false;
+  }
+
+  p->record = std::move(p->rows.front());
+  p->rows.pop_front();
+  lock.unlock();
+  p->space.notify_one();
+  return true;
+}
+
+/*!
+ * Returns the current record. The record is empty if next() was not called yet or returned
+ * \c false.
+ */
+const Record& RowCursor::record() const { return p->record; }
+
+/*!
+ * Returns the query's column names. They are available after the first call of next().
+ */
+std::vector<std::string> RowCursor::cols() const {
+  CPPCRATE_LOCK_GUARD(p->mutex);
+  return p->cols;
+}
+
+/*!
+ * Returns the query's column types. They are available after the first call of next().
+ */
+std::vector<CrateDataType> RowCursor::colTypes() const {
+  CPPCRATE_LOCK_GUARD(p->mutex);
+  return p->colTypes;
+}
+
+/*!
+ * Returns the query's row count. Since Crate sends it after the rows, it is only available after
+ * next() returned \c false.
+ */
+int RowCursor::rowCount() const {
+  CPPCRATE_LOCK_GUARD(p->mutex);
+  return p->rowCount;
+}
+
+/*!
+ * Returns the query's duration. Since Crate sends it after the rows, it is only available after
+ * next() returned \c false.
+ */
+double RowCursor::duration() const {
+  CPPCRATE_LOCK_GUARD(p->mutex);
+  return p->duration;
+}
+
+}  // namespace CppCrate
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/query.h>
+#include <cppcrate/record.h>
+#include <cppcrate/rowcursor.h>
+
+#include "compression.h"
+#include "nodelist.h"
+
+#include <curl/curl.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace CppCrate {
+
+class Connection;
+
+/// \cond INTERNAL
+class RowCursor::Private {
+ public:
+  Private()
+      : capacity(1),
+        finished(true),
+        cancelled(false),
+        rowCount(0),
+        duration(0.0),
+        nodes(CPPCRATE_NULLPTR),
+        connection(CPPCRATE_NULLPTR),
+        multi(CPPCRATE_NULLPTR),
+        received(0),
+        done(false),
+        code(CURLE_OK) {}
+
+  ~Private();
+
+  void start(NodeList& nodes, const Query& query, const std::string& defaultSchema,
+             const Compression& compression, int bufferedRows);
+  void finish(const std::string& error);
+  void run();
+
+  // Called on the background thread
+  bool receive();
+  bool push(Record&& record);
+  void setColumns(const std::vector<std::string>& names, const std::vector<CrateDataType>& types);
+
+  // State shared with the background thread
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::condition_variable space;
+  std::deque<Record> rows;
+  std::size_t capacity;
+  bool finished;
+  bool cancelled;
+  std::string errorString;
+  std::vector<std::string> cols;
+  std::vector<CrateDataType> colTypes;
+  int rowCount;
+  double duration;
+
+  // The current record
+  Record record;
+
+  // State of the transfer, only accessed by the background thread
+  NodeList* nodes;
+  Query query;
+  std::string defaultSchema;
+  Connection* connection;
+  CURLM* multi;
+  Node node;
+  NodeList::Tries tries;
+  std::string chunk;
+  std::size_t received;
+  bool done;
+  CURLcode code;
+  std::thread thread;
+
+ private:
+  class ReplyStream;
+  class ReplyHandler;
+
+  void prepare();
+};
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,524 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sha1.h"
+#include "global_p.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+#define CPPCRATE_SHA1_X86
+// Hashing several buffers at once relies on the vector extensions of GCC and Clang.
+#define CPPCRATE_SHA1_LANES
+#define CPPCRATE_TARGET(features) __attribute__((target(features)))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER) && _MSC_VER >= 1900
+#define CPPCRATE_SHA1_X86
+#define CPPCRATE_TARGET(features)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+namespace Internal {
+const uint32_t sha1Keys[4] = {0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6};
+
+inline uint32_t rotateLeft(uint32_t value, int bits) {
+  return (value << bits) | (value >> (32 - bits));
+}
+
+inline uint32_t readBigEndian(const unsigned char* data) {
+  return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+         (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+}
+
+std::string hexDigest(const uint32_t* state) {
+  static const char digits[] = "0123456789abcdef";
+  std::string digest(40, '0');
+  for (int i = 0; i < 40; ++i) digest[i] = digits[(state[i / 8] >> (28 - 4 * (i % 8))) & 0xf];
+  return digest;
+}
+
+inline uint32_t choose(uint32_t b, uint32_t c, uint32_t d) { return d ^ (b & (c ^ d)); }
+inline uint32_t parity(uint32_t b, uint32_t c, uint32_t d) { return b ^ c ^ d; }
+inline uint32_t majority(uint32_t b, uint32_t c, uint32_t d) { return (b & c) | (d & (b | c)); }
+
+// The 80 rounds, fully unrolled. Instead of moving the working variables after each round, their
+// roles rotate, which keeps them in registers. CPPCRATE_SHA1_W(t) has to provide the message word
+// of round t plus its key. CPPCRATE_SHA1_PREPARE(t) runs before round t, so the schedule can be
+// computed in between the rounds: they depend on each other, the schedule does not.
+#define CPPCRATE_SHA1_ROUND(function, t, a, b, c, d, e)         \
+  CPPCRATE_SHA1_PREPARE(t)                                      \
+  e += rotateLeft(a, 5) + function(b, c, d) + CPPCRATE_SHA1_W(t); \
+  b = rotateLeft(b, 30);
+#define CPPCRATE_SHA1_ROUNDS(function, t)                 \
+  CPPCRATE_SHA1_ROUND(function, t, a, b, c, d, e)         \
+  CPPCRATE_SHA1_ROUND(function, t + 1, e, a, b, c, d)     \
+  CPPCRATE_SHA1_ROUND(function, t + 2, d, e, a, b, c)     \
+  CPPCRATE_SHA1_ROUND(function, t + 3, c, d, e, a, b)     \
+  CPPCRATE_SHA1_ROUND(function, t + 4, b, c, d, e, a)
+#define CPPCRATE_SHA1_ALL_ROUNDS                                                             \
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];             \
+  CPPCRATE_SHA1_ROUNDS(choose, 0) CPPCRATE_SHA1_ROUNDS(choose, 5)                            \
+  CPPCRATE_SHA1_ROUNDS(choose, 10) CPPCRATE_SHA1_ROUNDS(choose, 15)                          \
+  CPPCRATE_SHA1_ROUNDS(parity, 20) CPPCRATE_SHA1_ROUNDS(parity, 25)                          \
+  CPPCRATE_SHA1_ROUNDS(parity, 30) CPPCRATE_SHA1_ROUNDS(parity, 35)                          \
+  CPPCRATE_SHA1_ROUNDS(majority, 40) CPPCRATE_SHA1_ROUNDS(majority, 45)                      \
+  CPPCRATE_SHA1_ROUNDS(majority, 50) CPPCRATE_SHA1_ROUNDS(majority, 55)                      \
+  CPPCRATE_SHA1_ROUNDS(parity, 60) CPPCRATE_SHA1_ROUNDS(parity, 65)                          \
+  CPPCRATE_SHA1_ROUNDS(parity, 70) CPPCRATE_SHA1_ROUNDS(parity, 75)                          \
+  state[0] += a, state[1] += b, state[2] += c, state[3] += d, state[4] += e;
+
+// The message words are kept in a ring of 16 words.
+#define CPPCRATE_SHA1_PREPARE(t)
+#define CPPCRATE_SHA1_W(t)                                                                \
+  (((t) < 16 ? w[(t)]                                                                      \
+             : (w[(t)&15] = rotateLeft(                                                    \
+                    w[((t) + 13) & 15] ^ w[((t) + 8) & 15] ^ w[((t) + 2) & 15] ^ w[(t)&15], 1))) + \
+   sha1Keys[(t) / 20])
+void sha1CompressScalar(uint32_t* state, const unsigned char* blocks, std::size_t count) {
+  uint32_t w[16];
+  for (; count > 0; --count, blocks += 64) {
+    for (int t = 0; t < 16; ++t) w[t] = readBigEndian(blocks + 4 * t);
+    CPPCRATE_SHA1_ALL_ROUNDS
+  }
+}
+#undef CPPCRATE_SHA1_PREPARE
+#undef CPPCRATE_SHA1_W
+
+#ifdef CPPCRATE_SHA1_X86
+// Computes the message words 4i..4i+3 of w and stores them plus their key to wk.
+CPPCRATE_TARGET("ssse3")
+inline void sha1ScheduleSsse3(__m128i* w, uint32_t* wk, int i) {
+  // w[t] = rol(w[t-3] ^ w[t-8] ^ w[t-14] ^ w[t-16], 1) for t = 4i..4i+3. The last word depends on
+  // the first one of the same vector, its term is added afterwards.
+  __m128i x = _mm_srli_si128(w[i - 1], 4);
+  x = _mm_xor_si128(x, w[i - 2]);
+  x = _mm_xor_si128(x, _mm_alignr_epi8(w[i - 3], w[i - 4], 8));
+  x = _mm_xor_si128(x, w[i - 4]);
+  x = _mm_or_si128(_mm_slli_epi32(x, 1), _mm_srli_epi32(x, 31));
+  const __m128i first = _mm_slli_si128(x, 12);
+  w[i] = _mm_xor_si128(x, _mm_or_si128(_mm_slli_epi32(first, 1), _mm_srli_epi32(first, 31)));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(wk + 4 * i),
+                   _mm_add_epi32(w[i], _mm_set1_epi32(static_cast<int>(sha1Keys[i / 5]))));
+}
+
+// Computes the message schedule four words at a time, twelve rounds before they are needed.
+#define CPPCRATE_SHA1_PREPARE(t) \
+  if ((t) % 4 == 0 && (t) < 64) sha1ScheduleSsse3(w, wk, (t) / 4 + 4);
+#define CPPCRATE_SHA1_W(t) wk[(t)]
+CPPCRATE_TARGET("ssse3")
+void sha1CompressSsse3(uint32_t* state, const unsigned char* blocks, std::size_t count) {
+  const __m128i byteSwap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+  const __m128i key = _mm_set1_epi32(static_cast<int>(sha1Keys[0]));
+  __m128i w[20];
+  uint32_t wk[80];
+  for (; count > 0; --count, blocks += 64) {
+    for (int i = 0; i < 4; ++i) {
+      w[i] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * i)), byteSwap);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(wk + 4 * i), _mm_add_epi32(w[i], key));
+    }
+    CPPCRATE_SHA1_ALL_ROUNDS
+  }
+}
+#undef CPPCRATE_SHA1_PREPARE
+#undef CPPCRATE_SHA1_W
+#undef CPPCRATE_SHA1_ALL_ROUNDS
+#undef CPPCRATE_SHA1_ROUNDS
+#undef CPPCRATE_SHA1_ROUND
+
+// Four rounds with the SHA extensions. Group g uses the message words 4g..4g+3 in m[g % 4] and
+// prepares the words of the groups g+1 to g+3.
+#define CPPCRATE_SHA1_NI_ROUNDS(g, current, other)                                 \
+  if (g == 0) {                                                                    \
+    current = _mm_add_epi32(current, m[0]);                                        \
+  } else {                                                                         \
+    current = _mm_sha1nexte_epu32(current, m[g % 4]);                              \
+  }                                                                                \
+  other = abcd;                                                                    \
+  if (g >= 3 && g <= 18) m[(g + 1) % 4] = _mm_sha1msg2_epu32(m[(g + 1) % 4], m[g % 4]); \
+  abcd = _mm_sha1rnds4_epu32(abcd, current, g / 5);                                \
+  if (g >= 1 && g <= 16) m[(g + 3) % 4] = _mm_sha1msg1_epu32(m[(g + 3) % 4], m[g % 4]); \
+  if (g >= 2 && g <= 17) m[(g + 2) % 4] = _mm_xor_si128(m[(g + 2) % 4], m[g % 4]);
+
+CPPCRATE_TARGET("sha,sse4.1")
+void sha1CompressShaNi(uint32_t* state, const unsigned char* blocks, std::size_t count) {
+  const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+  __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+  __m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+  __m128i e1;
+  __m128i m[4];
+  for (; count > 0; --count, blocks += 64) {
+    const __m128i abcdSaved = abcd;
+    const __m128i eSaved = e0;
+    for (int i = 0; i < 4; ++i) {
+      m[i] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * i)), byteSwap);
+    }
+    CPPCRATE_SHA1_NI_ROUNDS(0, e0, e1)
+    CPPCRATE_SHA1_NI_ROUNDS(1, e1, e0)
+    CPPCRATE_SHA1_NI_ROUNDS(2, e0, e1)
+    CPPCRATE_SHA1_NI_ROUNDS(3, e1, e0)
+    CPPCRATE_SHA1_NI_ROUNDS(4, e0, e1)
+    CPPCRATE_SHA1_NI_ROUNDS(5, e1, e0)
+    CPPCRATE_SHA1_NI_ROUNDS(6, e0, e1)
+    CPPCRATE_SHA1_NI_ROUNDS(7, e1, e0)
+    CPPCRATE_SHA1_NI_ROUNDS(8, e0, e1)
+    CPPCRATE_SHA1_NI_ROUNDS(9, e1, e0)
+    CPPCRATE_SHA1_NI_ROUNDS(10, e0, e1)
+    CPPCRATE_SHA1_NI_ROUNDS(11, e1, e0)
+    CPPCRATE_SHA1_NI_ROUNDS(12, e0, e1)
+    CPPCRATE_SHA1_NI_ROUNDS(13, e1, e0)
+    CPPCRATE_SHA1_NI_ROUNDS(14, e0, e1)
+    CPPCRATE_SHA1_NI_ROUNDS(15, e1, e0)
+    CPPCRATE_SHA1_NI_ROUNDS(16, e0, e1)
+    CPPCRATE_SHA1_NI_ROUNDS(17, e1, e0)
+    CPPCRATE_SHA1_NI_ROUNDS(18, e0, e1)
+    CPPCRATE_SHA1_NI_ROUNDS(19, e1, e0)
+    e0 = _mm_sha1nexte_epu32(e0, eSaved);
+    abcd = _mm_add_epi32(abcd, abcdSaved);
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+  state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+#undef CPPCRATE_SHA1_NI_ROUNDS
+
+#ifdef CPPCRATE_SHA1_LANES
+typedef uint32_t Lanes4 __attribute__((vector_size(16)));
+typedef uint32_t Lanes8 __attribute__((vector_size(32)));
+
+// Compresses one block of each lane, where every lane of a vector belongs to another buffer. The
+// rounds are the same as for a single buffer, just on vectors.
+#define CPPCRATE_SHA1_LANES_ROTATE(x, bits) (((x) << (bits)) | ((x) >> (32 - (bits))))
+#define CPPCRATE_SHA1_LANES_ROUND(function, t, a, b, c, d, e)                               \
+  if ((t) >= 16) {                                                                           \
+    const Lanes x = w[((t) + 13) & 15] ^ w[((t) + 8) & 15] ^ w[((t) + 2) & 15] ^ w[(t)&15]; \
+    w[(t)&15] = CPPCRATE_SHA1_LANES_ROTATE(x, 1);                                          \
+  }                                                                                          \
+  e += CPPCRATE_SHA1_LANES_ROTATE(a, 5) + function + w[(t)&15] + sha1Keys[(t) / 20];       \
+  b = CPPCRATE_SHA1_LANES_ROTATE(b, 30);
+#define CPPCRATE_SHA1_LANES_CHOOSE(b, c, d) (d ^ (b & (c ^ d)))
+#define CPPCRATE_SHA1_LANES_PARITY(b, c, d) (b ^ c ^ d)
+#define CPPCRATE_SHA1_LANES_MAJORITY(b, c, d) ((b & c) | (d & (b | c)))
+#define CPPCRATE_SHA1_LANES_ROUNDS(function, t)                                             \
+  CPPCRATE_SHA1_LANES_ROUND(CPPCRATE_SHA1_LANES_##function(b, c, d), t, a, b, c, d, e)     \
+  CPPCRATE_SHA1_LANES_ROUND(CPPCRATE_SHA1_LANES_##function(a, b, c), t + 1, e, a, b, c, d) \
+  CPPCRATE_SHA1_LANES_ROUND(CPPCRATE_SHA1_LANES_##function(e, a, b), t + 2, d, e, a, b, c) \
+  CPPCRATE_SHA1_LANES_ROUND(CPPCRATE_SHA1_LANES_##function(d, e, a), t + 3, c, d, e, a, b) \
+  CPPCRATE_SHA1_LANES_ROUND(CPPCRATE_SHA1_LANES_##function(c, d, e), t + 4, b, c, d, e, a)
+
+template <typename Lanes, int lanes>
+inline __attribute__((always_inline)) void sha1CompressLanes(Lanes* state,
+                                                             const unsigned char* const* blocks) {
+  Lanes w[16];
+  for (int t = 0; t < 16; ++t) {
+    for (int lane = 0; lane < lanes; ++lane) w[t][lane] = readBigEndian(blocks[lane] + 4 * t);
+  }
+  Lanes a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+  CPPCRATE_SHA1_LANES_ROUNDS(CHOOSE, 0) CPPCRATE_SHA1_LANES_ROUNDS(CHOOSE, 5)
+  CPPCRATE_SHA1_LANES_ROUNDS(CHOOSE, 10) CPPCRATE_SHA1_LANES_ROUNDS(CHOOSE, 15)
+  CPPCRATE_SHA1_LANES_ROUNDS(PARITY, 20) CPPCRATE_SHA1_LANES_ROUNDS(PARITY, 25)
+  CPPCRATE_SHA1_LANES_ROUNDS(PARITY, 30) CPPCRATE_SHA1_LANES_ROUNDS(PARITY, 35)
+  CPPCRATE_SHA1_LANES_ROUNDS(MAJORITY, 40) CPPCRATE_SHA1_LANES_ROUNDS(MAJORITY, 45)
+  CPPCRATE_SHA1_LANES_ROUNDS(MAJORITY, 50) CPPCRATE_SHA1_LANES_ROUNDS(MAJORITY, 55)
+  CPPCRATE_SHA1_LANES_ROUNDS(PARITY, 60) CPPCRATE_SHA1_LANES_ROUNDS(PARITY, 65)
+  CPPCRATE_SHA1_LANES_ROUNDS(PARITY, 70) CPPCRATE_SHA1_LANES_ROUNDS(PARITY, 75)
+  state[0] += a, state[1] += b, state[2] += c, state[3] += d, state[4] += e;
+}
+#undef CPPCRATE_SHA1_LANES_ROUNDS
+#undef CPPCRATE_SHA1_LANES_MAJORITY
+#undef CPPCRATE_SHA1_LANES_PARITY
+#undef CPPCRATE_SHA1_LANES_CHOOSE
+#undef CPPCRATE_SHA1_LANES_ROUND
+#undef CPPCRATE_SHA1_LANES_ROTATE
+
+CPPCRATE_TARGET("sse2")
+void sha1CompressSse2Lanes(Lanes4* state, const unsigned char* const* blocks) {
+  sha1CompressLanes<Lanes4, 4>(state, blocks);
+}
+
+CPPCRATE_TARGET("avx2")
+void sha1CompressAvx2Lanes(Lanes8* state, const unsigned char* const* blocks) {
+  sha1CompressLanes<Lanes8, 8>(state, blocks);
+}
+
+// A buffer hashed in a lane. Its complete blocks are read right from the buffer, the remainder and
+// the padding are copied to tail.
+struct Sha1Lane {
+  Sha1Lane() : buffer(-1), data(CPPCRATE_NULLPTR), blocks(0), tailBlocks(0) {}
+
+  void assign(int index, const char* bytes, std::size_t size) {
+    buffer = index;
+    data = reinterpret_cast<const unsigned char*>(bytes);
+    blocks = size / 64;
+    const std::size_t rest = size % 64;
+    tailBlocks = rest < 56 ? 1 : 2;
+    std::memset(tail, 0, sizeof(tail));
+    std::memcpy(tail, data + blocks * 64, rest);
+    tail[rest] = 0x80;
+    const uint64_t bits = static_cast<uint64_t>(size) * 8;
+    unsigned char* end = tail + 64 * tailBlocks;
+    for (int i = 1; i <= 8; ++i) end[-i] = static_cast<unsigned char>(bits >> (8 * (i - 1)));
+    tailBlock = tail;
+  }
+
+  // Returns the next block and advances, or returns a null pointer if the lane is done.
+  const unsigned char* next() {
+    if (blocks > 0) {
+      --blocks;
+      data += 64;
+      return data - 64;
+    }
+    if (tailBlocks == 0) return CPPCRATE_NULLPTR;
+    --tailBlocks;
+    tailBlock += 64;
+    return tailBlock - 64;
+  }
+
+  int buffer;
+  const unsigned char* data;
+  std::size_t blocks;
+  int tailBlocks;
+  const unsigned char* tailBlock;
+  unsigned char tail[128];
+};
+
+// Hashes \a buffers with one buffer per lane. A lane that is done takes the next buffer right away,
+// so all lanes are busy until the last buffers.
+template <typename Lanes, int lanes>
+void sha1HashLanes(void (*compress)(Lanes*, const unsigned char* const*),
+                   const std::vector<Sha1::Buffer>& buffers, std::vector<std::string>& digests) {
+  static const unsigned char idle[64] = {0};
+  static const uint32_t initial[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+  Sha1Lane lane[lanes];
+  Lanes state[5];
+  const unsigned char* blocks[lanes];
+  std::size_t assigned = 0;
+  int active = 0;
+
+  while (true) {
+    for (int i = 0; i < lanes; ++i) {
+      blocks[i] = lane[i].buffer < 0 ? CPPCRATE_NULLPTR : lane[i].next();
+      if (blocks[i] || lane[i].buffer < 0) continue;
+      // The lane is done.
+      uint32_t digest[5];
+      for (int j = 0; j < 5; ++j) digest[j] = state[j][i];
+      digests[lane[i].buffer] = hexDigest(digest);
+      lane[i].buffer = -1;
+      --active;
+    }
+    for (int i = 0; i < lanes && assigned < buffers.size(); ++i) {
+      if (lane[i].buffer >= 0) continue;
+      lane[i].assign(static_cast<int>(assigned), buffers[assigned].data, buffers[assigned].size);
+      ++assigned;
+      ++active;
+      for (int j = 0; j < 5; ++j) state[j][i] = initial[j];
+      blocks[i] = lane[i].next();
+    }
+    if (active == 0) return;
+    for (int i = 0; i < lanes; ++i) {
+      if (!blocks[i]) blocks[i] = idle;
+    }
+    compress(state, blocks);
+  }
+}
+#endif
+
+// Returns the registers of the CPUID \a leaf (EAX, EBX, ECX, EDX), or zeros if it does not exist.
+void cpuid(unsigned int leaf, unsigned int* registers) {
+  registers[0] = registers[1] = registers[2] = registers[3] = 0;
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (static_cast<unsigned int>(info[0]) < leaf) return;
+  __cpuidex(info, static_cast<int>(leaf), 0);
+  for (int i = 0; i < 4; ++i) registers[i] = static_cast<unsigned int>(info[i]);
+#else
+  if (__get_cpuid_max(0, CPPCRATE_NULLPTR) < leaf) return;
+  __cpuid_count(leaf, 0, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+#ifdef CPPCRATE_SHA1_LANES
+// Returns whether the operating system saves the AVX registers on context switches.
+bool hasAvxState() {
+  unsigned int features[4];
+  cpuid(1, features);
+  if ((features[2] & (1u << 27)) == 0) return false;
+  unsigned int low = 0, high = 0;
+  __asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+  return (low & 6) == 6;
+}
+#endif
+#endif
+}
+
+// Hashes with \a implementation, which must be supported by the CPU.
+Sha1::Sha1(Implementation implementation) : compress(Internal::sha1CompressScalar) {
+#ifdef CPPCRATE_SHA1_X86
+  if (implementation == Ssse3Implementation) compress = Internal::sha1CompressSsse3;
+  if (implementation == ShaNiImplementation) compress = Internal::sha1CompressShaNi;
+#else
+  (void)implementation;
+#endif
+  reset();
+}
+
+// Returns the fastest implementation supported by the CPU. It is detected once.
+Sha1::Implementation Sha1::fastest() {
+  static const Implementation implementation =
+      isSupported(ShaNiImplementation)
+          ? ShaNiImplementation
+          : isSupported(Ssse3Implementation) ? Ssse3Implementation : ScalarImplementation;
+  return implementation;
+}
+
+// Returns the fastest implementation for hashing many buffers with hash(). Eight lanes outrun
+// SHA-NI, four lanes are about as fast.
+Sha1::Implementation Sha1::fastestBatch() {
+  static const Implementation implementation =
+      isSupported(Avx2LanesImplementation)
+          ? Avx2LanesImplementation
+          : isSupported(ShaNiImplementation)
+                ? ShaNiImplementation
+                : isSupported(Sse2LanesImplementation) ? Sse2LanesImplementation : fastest();
+  return implementation;
+}
+
+bool Sha1::isSupported(Implementation implementation) {
+  if (implementation == ScalarImplementation) return true;
+#ifdef CPPCRATE_SHA1_X86
+  unsigned int features[4];
+  Internal::cpuid(1, features);
+  const bool sse2 = (features[3] & (1u << 26)) != 0;
+  const bool ssse3 = (features[2] & (1u << 9)) != 0;
+  const bool sse41 = (features[2] & (1u << 19)) != 0;
+  if (implementation == Ssse3Implementation) return ssse3;
+  Internal::cpuid(7, features);
+  const bool avx2 = (features[1] & (1u << 5)) != 0;
+  const bool sha = (features[1] & (1u << 29)) != 0;
+#ifdef CPPCRATE_SHA1_LANES
+  if (implementation == Sse2LanesImplementation) return sse2;
+  if (implementation == Avx2LanesImplementation) return avx2 && Internal::hasAvxState();
+#else
+  (void)sse2;
+  (void)avx2;
+#endif
+  return implementation == ShaNiImplementation && ssse3 && sse41 && sha;
+#else
+  return false;
+#endif
+}
+
+const char* Sha1::name(Implementation implementation) {
+  switch (implementation) {
+    case ScalarImplementation:
+      return "scalar";
+    case Ssse3Implementation:
+      return "SSSE3";
+    case ShaNiImplementation:
+      return "SHA-NI";
+    case Sse2LanesImplementation:
+      return "SSE2 4 lanes";
+    case Avx2LanesImplementation:
+      return "AVX2 8 lanes";
+  }
+  return "";
+}
+
+// Returns the hex digests of \a buffers in the same order. \a implementation must be supported by
+// the CPU.
+std::vector<std::string> Sha1::hash(const std::vector<Buffer>& buffers,
+                                    Implementation implementation) {
+  std::vector<std::string> digests(buffers.size());
+#ifdef CPPCRATE_SHA1_LANES
+  if (implementation == Sse2LanesImplementation) {
+    Internal::sha1HashLanes<Internal::Lanes4, 4>(Internal::sha1CompressSse2Lanes, buffers, digests);
+    return digests;
+  }
+  if (implementation == Avx2LanesImplementation) {
+    Internal::sha1HashLanes<Internal::Lanes8, 8>(Internal::sha1CompressAvx2Lanes, buffers, digests);
+    return digests;
+  }
+#endif
+  Sha1 sha1(implementation);
+  for (std::size_t i = 0, total = buffers.size(); i < total; ++i) {
+    sha1.update(buffers[i].data, buffers[i].size);
+    digests[i] = sha1.final();
+  }
+  return digests;
+}
+
+// Hashes \a data. Complete blocks are read right from \a data, only the remainder is buffered.
+void Sha1::update(const char* data, std::size_t size) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  length += size;
+  if (buffered > 0) {
+    const std::size_t missing = std::min(sizeof(buffer) - buffered, size);
+    std::memcpy(buffer + buffered, bytes, missing);
+    buffered += missing;
+    bytes += missing;
+    size -= missing;
+    if (buffered < sizeof(buffer)) return;
+    compress(state, buffer, 1);
+    buffered = 0;
+  }
+  const std::size_t blocks = size / sizeof(buffer);
+  if (blocks > 0) compress(state, bytes, blocks);
+  bytes += blocks * sizeof(buffer);
+  size -= blocks * sizeof(buffer);
+  std::memcpy(buffer, bytes, size);
+  buffered = size;
+}
+
+// Returns the digest as lowercase hex string and starts a new hash.
+std::string Sha1::final() {
+  const uint64_t bits = length * 8;
+  buffer[buffered++] = 0x80;
+  if (buffered > 56) {
+    std::memset(buffer + buffered, 0, sizeof(buffer) - buffered);
+    compress(state, buffer, 1);
+    buffered = 0;
+  }
+  std::memset(buffer + buffered, 0, 56 - buffered);
+  for (int i = 0; i < 8; ++i) buffer[63 - i] = static_cast<unsigned char>(bits >> (8 * i));
+  compress(state, buffer, 1);
+
+  const std::string digest = Internal::hexDigest(state);
+  reset();
+  return digest;
+}
+
+void Sha1::reset() {
+  state[0] = 0x67452301;
+  state[1] = 0xefcdab89;
+  state[2] = 0x98badcfe;
+  state[3] = 0x10325476;
+  state[4] = 0xc3d2e1f0;
+  buffered = 0;
+  length = 0;
+}
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifdef ENABLE_CPP11_SUPPORT
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+class Sha1 {
+ public:
+  // The lane implementations hash several buffers at once and are only used by hash().
+  enum Implementation {
+    ScalarImplementation,
+    Ssse3Implementation,
+    ShaNiImplementation,
+    Sse2LanesImplementation,
+    Avx2LanesImplementation
+  };
+
+  struct Buffer {
+    Buffer(const char* data, std::size_t size) : data(data), size(size) {}
+    const char* data;
+    std::size_t size;
+  };
+
+  explicit Sha1(Implementation implementation = fastest());
+
+  static Implementation fastest();
+  static Implementation fastestBatch();
+  static bool isSupported(Implementation implementation);
+  static const char* name(Implementation implementation);
+  static std::vector<std::string> hash(const std::vector<Buffer>& buffers,
+                                       Implementation implementation = fastestBatch());
+
+  void update(const char* data, std::size_t size);
+  std::string final();
+
+ private:
+  typedef void (*Compress)(uint32_t* state, const unsigned char* blocks, std::size_t count);
+
+  void reset();
+
+  Compress compress;
+  uint32_t state[5];
+  unsigned char buffer[64];
+  std::size_t buffered;
+  uint64_t length;
+};
+/// \endcond
+
+}  // namespace CppCrate
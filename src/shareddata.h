@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/global.h>
+
+#ifdef ENABLE_CPP11_SUPPORT
+#include <atomic>
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <algorithm>
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+#ifdef ENABLE_CPP11_SUPPORT
+typedef std::atomic<int> RefCount;
+#else
+// Atomic reference count for builds without C++11 support. It uses the compiler's atomic
+// intrinsics, so it is only thread-safe with MSVC, GCC and compatible compilers like Clang.
+class RefCount {
+ public:
+  explicit RefCount(int value) : value(value) {}
+
+#if defined(_MSC_VER)
+  int operator++() { return _InterlockedIncrement(&value); }
+  int operator--() { return _InterlockedDecrement(&value); }
+  operator int() const { return _InterlockedOr(const_cast<volatile long*>(&value), 0); }
+#elif defined(__GNUC__)
+  int operator++() { return __sync_add_and_fetch(&value, 1); }
+  int operator--() { return __sync_sub_and_fetch(&value, 1); }
+  operator int() const { return __sync_add_and_fetch(const_cast<volatile long*>(&value), 0); }
+#else
+  int operator++() { return ++value; }
+  int operator--() { return --value; }
+  operator int() const { return value; }
+#endif
+
+ private:
+  RefCount(const RefCount&);
+  RefCount& operator=(const RefCount&);
+
+  volatile long value;
+};
+#endif
+
+// Base class for immutable data that is shared by SharedDataPointer. The reference count is
+// atomic, so the data can be shared between threads.
+class SharedData {
+ public:
+  SharedData() : refs(0) {}
+
+  mutable RefCount refs;
+
+ private:
+  SharedData(const SharedData&);
+  SharedData& operator=(const SharedData&);
+};
+
+// Reference counting pointer to a class derived from SharedData. The data is deleted together with
+// the last pointer referring to it.
+template <class T>
+class SharedDataPointer {
+ public:
+  SharedDataPointer() : d(CPPCRATE_NULLPTR) {}
+  explicit SharedDataPointer(T* data) : d(data) {
+    if (d) ++d->refs;
+  }
+  SharedDataPointer(const SharedDataPointer& other) : d(other.d) {
+    if (d) ++d->refs;
+  }
+  ~SharedDataPointer() {
+    if (d && --d->refs == 0) delete d;
+  }
+
+  SharedDataPointer& operator=(const SharedDataPointer& other) {
+    SharedDataPointer copy(other);
+    std::swap(d, copy.d);
+    return *this;
+  }
+
+  bool isNull() const { return d == CPPCRATE_NULLPTR; }
+  T* data() const { return d; }
+  T& operator*() const { return *d; }
+  T* operator->() const { return d; }
+
+ private:
+  T* d;
+};
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cppcrate/tablescanner.h>
+#include "global_p.h"
+
+#include <cppcrate/cell.h>
+#include <cppcrate/client.h>
+#include <cppcrate/query.h>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <future>
+
+namespace CppCrate {
+
+/*!
+ * \class CppCrate::TableScanner
+ *
+ * \brief Reads a whole table page by page ordered by a key column.
+ *
+ * The class %TableScanner reads a table in pages of a fixed size. Instead of skipping rows with
+ * OFFSET, which gets slower with every page, each page starts after the last key of the previous
+ * page:
+ * \code
+ * SELECT <columns> FROM <table> WHERE <key> > <last key> ORDER BY <key> LIMIT <page size>
+ * \endcode
+ * So every page costs the same regardless of its position. The key column must be unique and must
+ * be part of the selected columns. Rows whose key is null are skipped on every page, including the
+ * first one, which is requested with \c "WHERE <key> IS NOT NULL".
+ *
+ * A scanner is created by Client::scan(). While the caller processes the current page the next
+ * page is already fetched asynchronously, which hides the latency of the round trips:
+ * \code
+ * TableScanner scanner = client.scan("players", "id", 10000);
+ * while (scanner.next()) {
+ *   const Result& page = scanner.page();
+ *   for (int i = 0, total = page.recordSize(); i < total; ++i) {
+ *     // use page.record(i) here
+ *   }
+ * }
+ * if (!scanner) {
+ *   std::cout << scanner.errorString() << std::endl;
+ * }
+ * \endcode
+ *
+ * \note The scanner must not be used after the client was disconnected or destroyed.
+ */
+
+/// \cond INTERNAL
+class TableScanner::Private {
+ public:
+  Private() : client(CPPCRATE_NULLPTR), pageSize(0), keyIndex(-1), current(emptyPage()) {}
+
+  static Result emptyPage() { return Result(RawResult("{}")); }
+
+  void fetch(const std::string &lastKey);
+  bool receive();
+  std::string statement(bool first) const;
+  static std::string keyArguments(const Cell &key);
+
+  Client *client;
+  std::string table;
+  std::string keyColumn;
+  std::string columns;
+  int pageSize;
+
+  // The position of the key column, resolved with the first page.
+  int keyIndex;
+  std::future<Result> pending;
+  Result current;
+  std::string errorString;
+};
+
+// Requests the page following the key \a lastKey, which is a JSON array holding the key, or the
+// first page if \a lastKey is empty.
+void TableScanner::Private::fetch(const std::string &lastKey) {
+  if (lastKey.empty()) {
+    pending = client->execAsync(Query(statement(true)));
+  } else {
+    pending = client->execAsync(Query(statement(false), lastKey));
+  }
+}
+
+// Waits for the pending page and requests the next one. Returns false if there are no more rows.
+bool TableScanner::Private::receive() {
+  if (!pending.valid()) return false;
+  current = pending.get();
+  if (!current) {
+    errorString = current.errorString();
+    return false;
+  }
+
+  const int total = current.recordSize();
+  if (total == 0) return false;
+
+  if (keyIndex < 0) keyIndex = current.columnIndex(keyColumn);
+  if (keyIndex < 0) {
+    errorString = "[CppCrate] The key column \"" + keyColumn + "\" is not part of the result.";
+    return false;
+  }
+
+  // A short page is the last one, so there is no need to ask for an empty page.
+  if (total >= pageSize) {
+    const std::string lastKey = keyArguments(current.cell(total - 1, keyIndex));
+    if (!lastKey.empty()) fetch(lastKey);
+  }
+  return true;
+}
+
+std::string TableScanner::Private::statement(bool first) const {
+  std::string sql = "SELECT " + columns + " FROM " + table;
+  sql.append(" WHERE " + keyColumn + (first ? " IS NOT NULL" : " > ?"));
+  sql.append(" ORDER BY " + keyColumn + " LIMIT " + CPPCRATE_TO_STRING(pageSize));
+  return sql;
+}
+
+// Returns the arguments array for the key \a key or an empty string if the key is null.
+std::string TableScanner::Private::keyArguments(const Cell &key) {
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  bool b;
+  int64_t ll;
+  double d;
+  std::string s;
+  writer.StartArray();
+  if (key.read(b)) {
+    writer.Bool(b);
+  } else if (key.read(ll)) {
+    writer.Int64(ll);
+  } else if (key.read(d)) {
+    writer.Double(d);
+  } else if (key.read(s)) {
+    writer.String(s.c_str(), static_cast<rapidjson::SizeType>(s.size()));
+  } else {
+    return std::string();
+  }
+  writer.EndArray();
+  return std::string(sb.GetString(), sb.GetSize());
+}
+/// \endcond
+
+CPPCRATE_PIMPL_IMPLEMENT_PRIVATE(TableScanner)
+CPPCRATE_PIMPL_IMPLEMENT_MOVE(TableScanner)
+
+/*!
+ * Constructs an empty scanner without any pages.
+ */
+TableScanner::TableScanner() : p(new Private) {}
+
+// Constructs a scanner that reads \a columns of \a table from \a client and requests the first
+// page right away.
+TableScanner::TableScanner(Client &client, const std::string &table, const std::string &keyColumn,
+                           int pageSize, const std::string &columns)
+    : p(new Private) {
+  p->client = &client;
+  p->table = table;
+  p->keyColumn = keyColumn;
+  p->columns = columns.empty() ? "*" : columns;
+  p->pageSize = pageSize > 0 ? pageSize : 1;
+  p->fetch(std::string());
+}
+
+/*!
+ * Returns whether the scanner is valid.
+ */
+TableScanner::operator bool() const { return !hasError(); }
+
+/*!
+ * Returns whether the scanner has an error. Errors can only be detected after next() returned
+ * \c false.
+ */
+bool TableScanner::hasError() const { return !p->errorString.empty(); }
+
+/*!
+ * Returns the error string.
+ */
+const std::string &TableScanner::errorString() const { return p->errorString; }
+
+/*!
+ * Advances the scanner to the next page and returns \c true if there is one. Blocks until the page
+ * is received. Returns \c false if all rows were read or an error occurred.
+ *
+ * \sa page()
+ */
+bool TableScanner::next() {
+  if (p->receive()) return true;
+  p->current = Private::emptyPage();
+  return false;
+}
+
+/*!
+ * Returns the current page. It holds at most pageSize() rows. The page is empty if next() was not
+ * called yet or returned \c false.
+ */
+const Result &TableScanner::page() const { return p->current; }
+
+/*!
+ * Returns the scanned table.
+ */
+const std::string &TableScanner::table() const { return p->table; }
+
+/*!
+ * Returns the column by which the table is paged.
+ */
+const std::string &TableScanner::keyColumn() const { return p->keyColumn; }
+
+/*!
+ * Returns the maximal number of rows per page.
+ */
+int TableScanner::pageSize() const { return p->pageSize; }
+
+}  // namespace CppCrate
@@ -16,7 +16,9 @@
 
 #include <cppcrate/value.h>
 #include "global_p.h"
+#include "value_p.h"
 
+#include <cstring>
 #include <sstream>
 
 namespace CppCrate {
@@ -61,6 +63,15 @@ namespace CppCrate {
  * into different types using asBool(), asInt(), asLong(), asLongLong(), asFloat(), asDouble() and
  * asString(). If a conversion is not possible a default value will be returned. Note, however, that
  * it is advised to get the value according it's own data type.
+ *
+ * \section sec_class_value_storage Storage
+ *
+ * A %Value stores its data inline. Only strings longer than 16 characters are allocated on the
+ * heap. The column name and the Crate data type are shared between all values of a column, so
+ * copying a value is cheap.
+ *
+ * \note Up to version 0.1 %Value kept its data behind a private pointer. Storing it inline changed
+ *       the size and layout of the class, so version 0.2 is not binary compatible with 0.1.
  */
 
 /*!
@@ -96,219 +107,171 @@ namespace CppCrate {
  */
 
 /// \cond INTERNAL
-class Value::Private {
- public:
-  Private() : type(CrateDataType::NotSupported), dataType(InvalidType) {}
+namespace Internal {
+const std::string emptyName;
+const CrateDataType notSupportedType;
+
+// Returns new meta information that is already referenced by the caller.
+const ValueMeta *createMeta(const std::string &name, const CrateDataType &type) {
+  ValueMeta *meta = new ValueMeta(name, type);
+  ++meta->refs;
+  return meta;
+}
+}
 
-  ~Private() {
-    if (dataType == StringType) delete data.sp;
-  }
+Value::Value(const ValueMeta *meta, Type type) : meta(meta), dataType(type), length(0) {
+  if (meta) ++meta->refs;
+}
 
-  Private(const Private &other) {
-    type = other.type;
-    dataType = other.dataType;
-    if (dataType == StringType)
-      data.sp = new std::string(*other.data.sp);
-    else
-      data = other.data;
-    name = other.name;
-  }
+Value::Value(const ValueMeta *meta, bool value) : meta(meta), dataType(BoolType), length(0) {
+  if (meta) ++meta->refs;
+  data.b = value;
+}
 
-  Private &operator=(const Private &other) {
-    if (this != &other) {
-      if (dataType == StringType) delete data.sp;
-      *this = Private(other);
-    }
-    return *this;
-  }
+Value::Value(const ValueMeta *meta, int16_t value) : meta(meta), dataType(Int16Type), length(0) {
+  if (meta) ++meta->refs;
+  data.i = value;
+}
 
-#ifdef ENABLE_CPP11_SUPPORT
-  Private(Private &&other)
-      : type(std::move(other.type)),
-        dataType(std::move(other.dataType)),
-        name(std::move(other.name)) {
-    if (dataType == StringType) {
-      data.sp = std::move(other.data.sp);
-      other.data.sp = CPPCRATE_NULLPTR;
-    } else {
-      data = std::move(other.data);
-    }
-  }
+Value::Value(const ValueMeta *meta, int32_t value) : meta(meta), dataType(Int32Type), length(0) {
+  if (meta) ++meta->refs;
+  data.l = value;
+}
 
-  Private &operator=(Private &&other) {
-    if (this != &other) {
-      if (dataType == StringType) delete data.sp;
-
-      type = std::move(other.type);
-      dataType = std::move(other.dataType);
-      if (dataType == StringType) {
-        data.sp = std::move(other.data.sp);
-        other.data.sp = CPPCRATE_NULLPTR;
-      } else {
-        data = std::move(other.data);
-      }
-      name = std::move(other.name);
-    }
-    return *this;
-  }
-#endif
+Value::Value(const ValueMeta *meta, int64_t value) : meta(meta), dataType(Int64Type), length(0) {
+  if (meta) ++meta->refs;
+  data.ll = value;
+}
 
-  bool operator==(const Private &other) const {
-    if (type != other.type || dataType != other.dataType || name != other.name) {
-      return false;
-    }
-    switch (dataType) {
-      case InvalidType:  // [[fallthrough]]
-      case NullType:
-        break;
-      case BoolType:
-        return data.b == other.data.b;
-      case Int16Type:
-        return data.i == other.data.i;
-      case Int32Type:
-        return data.l == other.data.l;
-      case Int64Type:
-        return data.ll == other.data.ll;
-      case FloatType:
-        return data.f == other.data.f;
-      case DoubleType:
-        return data.d == other.data.d;
-      case StringType:
-        return *data.sp == *other.data.sp;
-    }
-    return true;
+Value::Value(const ValueMeta *meta, float value) : meta(meta), dataType(FloatType), length(0) {
+  if (meta) ++meta->refs;
+  data.f = value;
+}
+
+Value::Value(const ValueMeta *meta, double value) : meta(meta), dataType(DoubleType), length(0) {
+  if (meta) ++meta->refs;
+  data.d = value;
+}
+
+Value::Value(const ValueMeta *meta, const char *value, std::size_t length)
+    : meta(meta), dataType(StringType), length(0) {
+  if (meta) ++meta->refs;
+  setString(value, length);
+}
+
+// Strings up to SmallStringSize characters are stored inline, longer ones on the heap.
+void Value::setString(const char *value, std::size_t length) {
+  this->length = length;
+  if (length > SmallStringSize) {
+    data.sp = new char[length];
+    std::memcpy(data.sp, value, length);
+  } else if (length > 0) {
+    std::memcpy(data.s, value, length);
   }
+}
+
+const char *Value::stringData() const { return length > SmallStringSize ? data.sp : data.s; }
 
-  template <typename T>
-  T asNumeric() const {
-    switch (dataType) {
-      case InvalidType:  // [[fallthrough]]
-      case NullType:
-        break;
-      case StringType: {
-        T number;
-        if (!(std::istringstream(*data.sp) >> number)) number = static_cast<T>(0);
-        return number;
+template <typename T>
+T Value::asNumeric() const {
+  switch (dataType) {
+    case InvalidType:  // [[fallthrough]]
+    case NullType:
+      break;
+    case StringType: {
+      T number;
+      if (!(std::istringstream(std::string(stringData(), length)) >> number)) {
+        number = static_cast<T>(0);
       }
-      case Int16Type:
-        return static_cast<T>(data.i);
-      case Int32Type:
-        return static_cast<T>(data.l);
-      case Int64Type:
-        return static_cast<T>(data.ll);
-      case FloatType:
-        return static_cast<T>(data.f);
-      case DoubleType:
-        return static_cast<T>(data.d);
-      case BoolType:
-        return static_cast<T>(data.b);
+      return number;
     }
-
-    return static_cast<T>(0);
+    case Int16Type:
+      return static_cast<T>(data.i);
+    case Int32Type:
+      return static_cast<T>(data.l);
+    case Int64Type:
+      return static_cast<T>(data.ll);
+    case FloatType:
+      return static_cast<T>(data.f);
+    case DoubleType:
+      return static_cast<T>(data.d);
+    case BoolType:
+      return static_cast<T>(data.b);
   }
 
-  CrateDataType type;
-  Type dataType;
-  union Data {
-    bool b;
-    int16_t i;
-    int32_t l;
-    int64_t ll;
-    float f;
-    double d;
-    std::string *sp;
-  } data;
-  std::string name;
-};
+  return static_cast<T>(0);
+}
 /// \endcond
 
-CPPCRATE_PIMPL_IMPLEMENT_ALL(Value)
-
 /*!
  * Constructs an invalid value.
  */
-Value::Value() : p(new Private) {}
+Value::Value() : meta(CPPCRATE_NULLPTR), dataType(InvalidType), length(0) {}
 
 /*!
  * Constructs an invalid value with Crate's original data type \a type.
  */
-Value::Value(const CrateDataType &type) : p(new Private) {
-  p->type = type;
-  p->dataType = InvalidType;
-}
+Value::Value(const CrateDataType &type)
+    : meta(Internal::createMeta(std::string(), type)), dataType(InvalidType), length(0) {}
 
 /*!
  * Constructs a null value with Crate's original data type \a type.
  */
-Value::Value(const CrateDataType &type, bool) : p(new Private) {
-  p->type = type;
-  p->dataType = NullType;
-}
+Value::Value(const CrateDataType &type, bool)
+    : meta(Internal::createMeta(std::string(), type)), dataType(NullType), length(0) {}
 
 /*!
  * Constructs a value with the column name \a name and Crate's original data type \a type.
  * The \a value is internally stored as a \c bool with it's own type Value::BoolType.
  */
-Value::Value(const std::string &name, const CrateDataType &type, bool value) : p(new Private) {
-  p->type = type;
-  p->name = name;
-  p->dataType = BoolType;
-  p->data.b = value;
+Value::Value(const std::string &name, const CrateDataType &type, bool value)
+    : meta(Internal::createMeta(name, type)), dataType(BoolType), length(0) {
+  data.b = value;
 }
 
 /*!
  * Constructs a value with the column name \a name and Crate's original data type \a type.
  * The \a value is internally stored as a \c int with it's own type Value::Int16Type.
  */
-Value::Value(const std::string &name, const CrateDataType &type, int16_t value) : p(new Private) {
-  p->type = type;
-  p->name = name;
-  p->dataType = Int16Type;
-  p->data.i = value;
+Value::Value(const std::string &name, const CrateDataType &type, int16_t value)
+    : meta(Internal::createMeta(name, type)), dataType(Int16Type), length(0) {
+  data.i = value;
 }
 
 /*!
  * Constructs a value with the column name \a name and Crate's original data type \a type.
  * The \a value is internally stored as a \c long with it's own type Value::Int32Type.
  */
-Value::Value(const std::string &name, const CrateDataType &type, int32_t value) : p(new Private) {
-  p->type = type;
-  p->name = name;
-  p->dataType = Int32Type;
-  p->data.l = value;
+Value::Value(const std::string &name, const CrateDataType &type, int32_t value)
+    : meta(Internal::createMeta(name, type)), dataType(Int32Type), length(0) {
+  data.l = value;
 }
 
 /*!
  * Constructs a value with the column name \a name and Crate's original data type \a type.
  * The \a value is internally stored as a \c long \c long with it's own type Value::Int64Type.
  */
-Value::Value(const std::string &name, const CrateDataType &type, int64_t value) : p(new Private) {
-  p->type = type;
-  p->name = name;
-  p->dataType = Int64Type;
-  p->data.ll = value;
+Value::Value(const std::string &name, const CrateDataType &type, int64_t value)
+    : meta(Internal::createMeta(name, type)), dataType(Int64Type), length(0) {
+  data.ll = value;
 }
 
 /*!
  * Constructs a value with the column name \a name and Crate's original data type \a type.
  * The \a value is internally stored as a \c float with it's own type Value::FloatType.
  */
-Value::Value(const std::string &name, const CrateDataType &type, float value) : p(new Private) {
-  p->type = type;
-  p->name = name;
-  p->dataType = FloatType;
-  p->data.f = value;
+Value::Value(const std::string &name, const CrateDataType &type, float value)
+    : meta(Internal::createMeta(name, type)), dataType(FloatType), length(0) {
+  data.f = value;
 }
 
 /*!
  * Constructs a value with the column name \a name and Crate's original data type \a type.
  * The \a value is internally stored as a \c double with it's own type Value::DoubleType.
  */
-Value::Value(const std::string &name, const CrateDataType &type, double value) : p(new Private) {
-  p->type = type;
-  p->name = name;
-  p->dataType = DoubleType;
-  p->data.d = value;
+Value::Value(const std::string &name, const CrateDataType &type, double value)
+    : meta(Internal::createMeta(name, type)), dataType(DoubleType), length(0) {
+  data.d = value;
 }
 
 /*!
@@ -316,60 +279,142 @@ Value::Value(const std::string &name, const CrateDataType &type, double value) :
  * The \a value is internally stored as a \c std::string with it's own type Value::StringType.
  */
 Value::Value(const std::string &name, const CrateDataType &type, const std::string &value)
-    : p(new Private) {
-  p->type = type;
-  p->name = name;
-  p->dataType = StringType;
-  p->data.sp = new std::string(value);
+    : meta(Internal::createMeta(name, type)), dataType(StringType), length(0) {
+  setString(value.data(), value.size());
+}
+
+/*!
+ * Constructs a copy of \a other.
+ */
+Value::Value(const Value &other)
+    : meta(other.meta), dataType(other.dataType), length(other.length), data(other.data) {
+  if (meta) ++meta->refs;
+  if (dataType == StringType && length > SmallStringSize) setString(other.data.sp, length);
+}
+
+#ifdef ENABLE_CPP11_SUPPORT
+/*!
+ * Move-constructs a value from \a other. \a other becomes an invalid value.
+ */
+Value::Value(Value &&other)
+    : meta(other.meta), dataType(other.dataType), length(other.length), data(other.data) {
+  other.meta = CPPCRATE_NULLPTR;
+  other.dataType = InvalidType;
+  other.length = 0;
+}
+#endif
+
+/*!
+ * Destroys the value.
+ */
+Value::~Value() {
+  if (dataType == StringType && length > SmallStringSize) delete[] data.sp;
+  if (meta && --meta->refs == 0) delete meta;
+}
+
+/*!
+ * Assigns \a other to this value.
+ */
+Value &Value::operator=(Value other) {
+  swap(*this, other);
+  return *this;
+}
+
+/*!
+ * Swaps the values \a lhs and \a rhs.
+ */
+void swap(Value &lhs, Value &rhs) {
+  using std::swap;
+  swap(lhs.meta, rhs.meta);
+  swap(lhs.dataType, rhs.dataType);
+  swap(lhs.length, rhs.length);
+  swap(lhs.data, rhs.data);
+}
+
+/*!
+ * Returns \c true if this value is equal to \a other.
+ */
+bool Value::operator==(const Value &other) const {
+  if (dataType != other.dataType) return false;
+  if (meta != other.meta && (name() != other.name() || crateType() != other.crateType())) {
+    return false;
+  }
+  switch (dataType) {
+    case InvalidType:  // [[fallthrough]]
+    case NullType:
+      break;
+    case BoolType:
+      return data.b == other.data.b;
+    case Int16Type:
+      return data.i == other.data.i;
+    case Int32Type:
+      return data.l == other.data.l;
+    case Int64Type:
+      return data.ll == other.data.ll;
+    case FloatType:
+      return data.f == other.data.f;
+    case DoubleType:
+      return data.d == other.data.d;
+    case StringType:
+      return length == other.length && std::memcmp(stringData(), other.stringData(), length) == 0;
+  }
+  return true;
 }
 
+/*!
+ * Returns \c true if this value is not equal to \a other.
+ */
+bool Value::operator!=(const Value &other) const { return !(*this == other); }
+
 /*!
  * Returns the value's original column name.
  */
-const std::string &Value::name() const { return p->name; }
+const std::string &Value::name() const { return meta ? meta->name : Internal::emptyName; }
 
 /*!
  * Returns the value's original Crate type.
  */
-CrateDataType Value::crateType() const { return p->type; }
+const CrateDataType &Value::crateType() const {
+  return meta ? meta->type : Internal::notSupportedType;
+}
 
 /*!
  * Returns whether the value is invalid.
  */
-bool Value::isInvalid() const { return p->dataType == InvalidType; }
+bool Value::isInvalid() const { return dataType == InvalidType; }
 
 /*!
  * Returns whether the value is NULL.
  */
-bool Value::isNull() const { return p->dataType == NullType; }
+bool Value::isNull() const { return dataType == NullType; }
 
 /*!
  * Returns the value's own storage type.
  */
-Value::Type Value::type() const { return p->dataType; }
+Value::Type Value::type() const { return dataType; }
 
 /*!
  * Returns the value as a \c std::string or an empty string if the value couldn't be converted.
  */
 std::string Value::asString() const {
-  switch (p->dataType) {
+  switch (dataType) {
     case InvalidType:  // [[fallthrough]]
     case NullType:
       break;
     case StringType:
-      return *p->data.sp;
+      return std::string(stringData(), length);
     case Int16Type:
-      return CPPCRATE_TO_STRING(p->data.i);
+      return CPPCRATE_TO_STRING(data.i);
     case Int32Type:
-      return CPPCRATE_TO_STRING(p->data.l);
+      return CPPCRATE_TO_STRING(data.l);
     case Int64Type:
-      return CPPCRATE_TO_STRING(p->data.ll);
+      return CPPCRATE_TO_STRING(data.ll);
     case FloatType:
-      return CPPCRATE_TO_STRING(p->data.f);
+      return CPPCRATE_TO_STRING(data.f);
     case DoubleType:
-      return CPPCRATE_TO_STRING(p->data.d);
+      return CPPCRATE_TO_STRING(data.d);
     case BoolType:
-      return (p->data.b) ? std::string("true") : std::string("false");
+      return (data.b) ? std::string("true") : std::string("false");
   }
   return std::string();
 }
@@ -377,35 +422,37 @@ std::string Value::asString() const {
 /*!
  * Returns the value as a signed 16 bit integer or 0 if the value couldn't be converted.
  */
-int16_t Value::asInt16() const { return p->asNumeric<int16_t>(); }
+int16_t Value::asInt16() const { return asNumeric<int16_t>(); }
 
 /*!
  * Returns the value as a signed 32 bit integer or 0 if the value couldn't be converted.
  */
-int32_t Value::asInt32() const { return p->asNumeric<int32_t>(); }
+int32_t Value::asInt32() const { return asNumeric<int32_t>(); }
 
 /*!
  * Returns the value as a signed 64 bit integer or 0 if the value couldn't be converted.
  */
-int64_t Value::asInt64() const { return p->asNumeric<int64_t>(); }
+int64_t Value::asInt64() const { return asNumeric<int64_t>(); }
 
 /*!
  * Returns the value as a \c float or 0 if the value couldn't be converted.
  */
-float Value::asFloat() const { return p->asNumeric<float>(); }
+float Value::asFloat() const { return asNumeric<float>(); }
 
 /*!
  * Returns the value as a \c double or 0 if the value couldn't be converted.
  */
-double Value::asDouble() const { return p->asNumeric<double>(); }
+double Value::asDouble() const { return asNumeric<double>(); }
 
 /*!
  * Returns the value as a \c bool or \c false if the value couldn't be converted.
  */
 bool Value::asBool() const {
-  return (p->dataType == StringType)
-             ? !(*p->data.sp == "false" || *p->data.sp == "0" || p->data.sp->empty())
-             : (p->asNumeric<int>() != 0);
+  if (dataType == StringType) {
+    const std::string value(stringData(), length);
+    return !(value == "false" || value == "0" || value.empty());
+  }
+  return asNumeric<int>() != 0;
 }
 
 }  // namespace CppCrate
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2017 Lorenz Haas <lorenz.haas@histomatics.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cppcrate/cratedatatype.h>
+#include <cppcrate/value.h>
+
+#include "shareddata.h"
+
+#include <string>
+
+namespace CppCrate {
+
+/// \cond INTERNAL
+// Column name and type of a value. All values of a column share the same meta information.
+class ValueMeta : public SharedData {
+ public:
+  ValueMeta(const std::string& name, const CrateDataType& type) : name(name), type(type) {}
+
+  std::string name;
+  CrateDataType type;
+};
+/// \endcond
+
+}  // namespace CppCrate
@@ -0,0 +1,299 @@
+#include <gtest/gtest.h>
+
+#include "../src/blobbatch.h"
+#include "../src/crypto.h"
+#include "../src/nodelist.h"
+#include "fakeserver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+// Opens string streams, except for the key "closed".
+class StringSinks : public CppCrate::BlobBatch::Sinks {
+ public:
+  std::ostream* open(const std::string& key) {
+    opened.push_back(key);
+    return key == "closed" ? CPPCRATE_NULLPTR : new std::ostringstream;
+  }
+
+  std::vector<std::string> opened;
+};
+
+// Opens streams that cannot seek, so their position is unknown, and collects what is written.
+class UnseekableSinks : public CppCrate::BlobBatch::Sinks, private std::streambuf {
+ public:
+  std::ostream* open(const std::string&) { return new std::ostream(this); }
+
+  std::string data;
+
+ private:
+  int overflow(int c) {
+    if (c != traits_type::eof()) data += static_cast<char>(c);
+    return c;
+  }
+};
+
+// Returns a blob of \a size bytes that differ from their neighbours.
+std::string blob(std::size_t size) {
+  std::string data(size, '\0');
+  for (std::size_t i = 0; i < size; ++i) data[i] = static_cast<char>('a' + i % 23);
+  return data;
+}
+
+// Serves \a data, honouring range requests if \a ranges is set.
+FakeServer::Response serve(const std::string& data, const FakeServer::Request& request,
+                           bool ranges) {
+  unsigned long first = 0;
+  unsigned long last = 0;
+  const std::string range = request.header("range");
+  if (!ranges || std::sscanf(range.c_str(), "bytes=%lu-%lu", &first, &last) != 2) {
+    return FakeServer::Response(200, data);
+  }
+  return FakeServer::Response(206, data.substr(first, last - first + 1))
+      .header("Content-Range", "bytes " + std::to_string(first) + "-" + std::to_string(last) +
+                                   "/" + std::to_string(data.size()));
+}
+
+// Returns the ranges requested from \a server in ascending order.
+std::vector<std::string> ranges(const FakeServer& server) {
+  std::vector<std::string> ranges;
+  const std::vector<FakeServer::Request> requests = server.requests();
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    if (!requests[i].header("range").empty()) ranges.push_back(requests[i].header("range"));
+  }
+  std::sort(ranges.begin(), ranges.end());
+  return ranges;
+}
+
+std::string readFile(const std::string& path) {
+  std::ifstream file(path.c_str(), std::ifstream::binary);
+  std::ostringstream data;
+  data << file.rdbuf();
+  return data.str();
+}
+}
+
+TEST(BlobBatchTests, Upload) {
+  using namespace CppCrate;
+
+  const std::string path = "/tmp/cppcrate_blobbatch";
+  std::ofstream(path.c_str(), std::ofstream::binary) << "123456";
+  std::vector<std::string> files;
+  files.push_back(path);
+  files.push_back(path + "_missing");
+  files.push_back(path);
+
+  // Every file gets its own result in the same order.
+  NodeList nodes;
+  std::vector<BlobResult> results = BlobBatch(nodes, 2).upload("t", files);
+  ASSERT_EQ(results.size(), 3u);
+  EXPECT_EQ(results[0].key(), "7c4a8d09ca3762af61e59520943dc26494f8941b");
+  EXPECT_EQ(results[0].errorString(), "No node is available.");
+  EXPECT_EQ(results[1].errorString(), "Could not open file.");
+  EXPECT_EQ(results[2].key(), "7c4a8d09ca3762af61e59520943dc26494f8941b");
+
+  // Nodes that cannot be reached fail the transfers but not the batch.
+  nodes.setNodes(std::vector<Node>(1, Node("http://127.0.0.1:1")),
+                 Client::ConnectToFirstNodeAlways);
+  results = BlobBatch(nodes, 8).upload("t", files);
+  ASSERT_EQ(results.size(), 3u);
+  EXPECT_EQ(results[0].errorType(), BlobResult::HttpErrorType);
+  EXPECT_EQ(results[1].errorString(), "Could not open file.");
+  EXPECT_EQ(results[2].errorType(), BlobResult::HttpErrorType);
+
+  std::remove(path.c_str());
+  EXPECT_TRUE(BlobBatch(nodes, 8).upload("t", std::vector<std::string>()).empty());
+}
+
+TEST(BlobBatchTests, Download) {
+  using namespace CppCrate;
+
+  std::vector<std::string> keys;
+  keys.push_back("a");
+  keys.push_back("closed");
+  keys.push_back("b");
+
+  NodeList nodes;
+  StringSinks sinks;
+  const std::vector<BlobResult> results = BlobBatch(nodes, 0).download("t", keys, sinks);
+  ASSERT_EQ(results.size(), 3u);
+  EXPECT_EQ(sinks.opened, keys);
+  for (std::size_t i = 0; i < keys.size(); ++i) EXPECT_EQ(results[i].key(), keys[i]);
+  EXPECT_EQ(results[0].errorString(), "No node is available.");
+  EXPECT_EQ(results[1].errorString(), "Could not open the stream.");
+  EXPECT_EQ(results[2].errorString(), "No node is available.");
+}
+
+TEST(BlobBatchTests, DownloadFailover) {
+  using namespace CppCrate;
+
+  FakeServer server([](const FakeServer::Request&) { return FakeServer::Response(200, "123456"); });
+  FakeServer truncating([](const FakeServer::Request&) {
+    FakeServer::Response response(200, "123456");
+    response.truncateAt = 3;
+    return response;
+  });
+  const std::vector<std::string> keys(1, "a");
+
+  // Nothing was written yet, so the next node is tried.
+  std::vector<Node> urls;
+  urls.push_back(Node("http://127.0.0.1:1"));
+  urls.push_back(Node(server.url()));
+  NodeList nodes;
+  nodes.setNodes(urls, Client::ConnectToFirstNodeAlways);
+  UnseekableSinks sinks;
+  std::vector<BlobResult> results = BlobBatch(nodes, 1).download("t", keys, sinks);
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_FALSE(results[0].hasError()) << results[0].errorString();
+  EXPECT_EQ(sinks.data, "123456");
+
+  // Once data was written, the download fails instead of writing the blob a second time, even
+  // though the position of the stream is unknown.
+  urls[0] = Node(truncating.url());
+  nodes.setNodes(urls, Client::ConnectToFirstNodeAlways);
+  sinks.data.clear();
+  results = BlobBatch(nodes, 1).download("t", keys, sinks);
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_EQ(results[0].errorType(), BlobResult::HttpErrorType);
+  EXPECT_EQ(sinks.data, "123");
+  EXPECT_EQ(server.requests().size(), 1u);
+}
+
+TEST(BlobBatchTests, DownloadCached) {
+  using namespace CppCrate;
+
+  std::system("rm -rf /tmp/cppcrate_blobbatch_cache");
+  BlobCache cache("/tmp/cppcrate_blobbatch_cache", 1024);
+  const std::string key = "7c4a8d09ca3762af61e59520943dc26494f8941b";
+  std::ostringstream data;
+  {
+    BlobCache::Download download(cache, "t", key, data);
+    download.stream() << "123456";
+    download.commit();
+  }
+
+  // Cached blobs are served without a node.
+  std::vector<std::string> keys;
+  keys.push_back(key);
+  keys.push_back("b");
+  NodeList nodes;
+  StringSinks sinks;
+  const std::vector<BlobResult> results = BlobBatch(nodes, 2, &cache).download("t", keys, sinks);
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(sinks.opened, keys);
+  EXPECT_EQ(results[0].key(), key);
+  EXPECT_FALSE(results[0].hasError());
+  EXPECT_EQ(results[1].errorString(), "No node is available.");
+
+  const std::string path = "/tmp/cppcrate_blobbatch";
+  const BlobResult result = BlobBatch(nodes, 4, &cache).downloadRanges("t", key, path);
+  EXPECT_EQ(result.key(), key);
+  EXPECT_FALSE(result.hasError());
+  std::ifstream file(path.c_str(), std::ifstream::binary);
+  data.str(std::string());
+  data << file.rdbuf();
+  EXPECT_EQ(data.str(), "123456");
+  std::remove(path.c_str());
+  std::system("rm -rf /tmp/cppcrate_blobbatch_cache");
+}
+
+TEST(BlobBatchTests, DownloadRanges) {
+  using namespace CppCrate;
+
+  NodeList nodes;
+  BlobResult result = BlobBatch(nodes, 4).downloadRanges("t", "a", "/tmp/cppcrate_blobbatch");
+  EXPECT_EQ(result.key(), "a");
+  EXPECT_EQ(result.errorString(), "No node is available.");
+
+  nodes.setNodes(std::vector<Node>(1, Node("http://127.0.0.1:1")),
+                 Client::ConnectToFirstNodeAlways);
+  result = BlobBatch(nodes, 4).downloadRanges("t", "a", "/tmp/cppcrate_blobbatch");
+  EXPECT_EQ(result.errorType(), BlobResult::HttpErrorType);
+}
+
+TEST(BlobBatchTests, DownloadRangesSplit) {
+  using namespace CppCrate;
+
+  // The blob is split at size * i / count, ranges of less than 1 MiB are not worth it.
+  const std::string data = blob(3 * 1024 * 1024 + 2);
+  FakeServer server([&data](const FakeServer::Request& request) {
+    return serve(data, request, true);
+  });
+  NodeList nodes;
+  nodes.setNodes(std::vector<Node>(1, Node(server.url())), Client::ConnectToFirstNodeAlways);
+  const std::string path = "/tmp/cppcrate_blobbatch";
+  const BlobResult result = BlobBatch(nodes, 8).downloadRanges("t", "a", path);
+  EXPECT_FALSE(result.hasError()) << result.errorString();
+  EXPECT_TRUE(readFile(path) == data);
+
+  std::vector<std::string> expected;
+  expected.push_back("bytes=0-1048575");
+  expected.push_back("bytes=1048576-2097152");
+  expected.push_back("bytes=2097153-3145729");
+  EXPECT_EQ(ranges(server), expected);
+  std::remove(path.c_str());
+}
+
+TEST(BlobBatchTests, DownloadRangesResume) {
+  using namespace CppCrate;
+
+  // The connection of the first range breaks once after 1000 bytes.
+  const std::string data = blob(2 * 1024 * 1024);
+  std::atomic<bool> broken(false);
+  FakeServer server([&data, &broken](const FakeServer::Request& request) {
+    FakeServer::Response response = serve(data, request, true);
+    if (request.header("range") == "bytes=0-1048575" && !broken.exchange(true)) {
+      response.truncateAt = 1000;
+    }
+    return response;
+  });
+  NodeList nodes;
+  nodes.setNodes(std::vector<Node>(1, Node(server.url())), Client::ConnectToFirstNodeAlways);
+  const std::string path = "/tmp/cppcrate_blobbatch";
+  const BlobResult result = BlobBatch(nodes, 2).downloadRanges("t", "a", path);
+  EXPECT_FALSE(result.hasError()) << result.errorString();
+  EXPECT_TRUE(readFile(path) == data);
+
+  // Only the missing bytes are requested again.
+  std::vector<std::string> expected;
+  expected.push_back("bytes=0-1048575");
+  expected.push_back("bytes=1000-1048575");
+  expected.push_back("bytes=1048576-2097151");
+  EXPECT_EQ(ranges(server), expected);
+  std::remove(path.c_str());
+}
+
+TEST(BlobBatchTests, DownloadRangesIgnored) {
+  using namespace CppCrate;
+
+  // A server that ignores ranges sends the whole blob, which is then downloaded at once.
+  const std::string data = blob(2 * 1024 * 1024);
+  FakeServer server([&data](const FakeServer::Request& request) {
+    return serve(data, request, false);
+  });
+  NodeList nodes;
+  nodes.setNodes(std::vector<Node>(1, Node(server.url())), Client::ConnectToFirstNodeAlways);
+  const std::string path = "/tmp/cppcrate_blobbatch";
+  const BlobResult result = BlobBatch(nodes, 2).downloadRanges("t", "a", path);
+  EXPECT_FALSE(result.hasError()) << result.errorString();
+  EXPECT_TRUE(readFile(path) == data);
+
+  const std::vector<FakeServer::Request> requests = server.requests();
+  ASSERT_FALSE(requests.empty());
+  EXPECT_EQ(requests.front().method, "HEAD");
+  EXPECT_EQ(requests.back().method, "GET");
+  EXPECT_EQ(requests.back().header("range"), "");
+  std::remove(path.c_str());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
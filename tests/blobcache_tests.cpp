@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+
+#include "../src/blobcache.h"
+#include "../src/crypto.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+const std::string directory = "/tmp/cppcrate_blobcache";
+
+bool exists(const std::string& path) { return std::ifstream(path.c_str()).good(); }
+
+std::string store(CppCrate::BlobCache& cache, const std::string& table, const std::string& content,
+                  bool complete = true) {
+  const std::string key = CppCrate::Crypto::sha1(content.data(), content.size());
+  std::ostringstream data;
+  CppCrate::BlobCache::Download download(cache, table, key, data);
+  download.stream() << content;
+  EXPECT_EQ(data.str(), content);
+  EXPECT_EQ(download.stream().tellp(), static_cast<std::streamoff>(content.size()));
+  if (complete) download.commit();
+  return key;
+}
+
+std::string read(CppCrate::BlobCache& cache, const std::string& table, const std::string& key) {
+  std::ostringstream data;
+  EXPECT_EQ(cache.read(table, key, data), CppCrate::BlobCache::Read);
+  return data.str();
+}
+
+// Removes the blob from the cache while it is read.
+class RemovingBuffer : public std::stringbuf {
+ public:
+  RemovingBuffer(CppCrate::BlobCache& cache, const std::string& table, const std::string& key)
+      : cache(cache), table(table), key(key) {}
+
+ protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) {
+    cache.remove(table, key);
+    EXPECT_TRUE(exists(directory + "/" + table + "/" + key));
+    return std::stringbuf::xsputn(s, n);
+  }
+
+ private:
+  CppCrate::BlobCache& cache;
+  std::string table;
+  std::string key;
+};
+}
+
+TEST(BlobCacheTests, Store) {
+  using CppCrate::BlobCache;
+
+  std::system(("rm -rf " + directory).c_str());
+  BlobCache cache(directory, 1024);
+  ASSERT_TRUE(cache.isValid());
+  EXPECT_EQ(cache.size(), 0u);
+
+  const std::string key = store(cache, "t", "123456");
+  EXPECT_EQ(key, "7c4a8d09ca3762af61e59520943dc26494f8941b");
+  EXPECT_TRUE(cache.contains("t", key));
+  EXPECT_FALSE(cache.contains("u", key));
+  EXPECT_EQ(cache.size(), 6u);
+  EXPECT_EQ(read(cache, "t", key), "123456");
+
+  // Incomplete downloads are not cached and leave no files behind.
+  const std::string other = store(cache, "t", "abc", false);
+  EXPECT_FALSE(cache.contains("t", other));
+  std::ostringstream data;
+  EXPECT_EQ(cache.read("t", other, data), BlobCache::NotCached);
+  EXPECT_TRUE(data.str().empty());
+
+  // Blobs whose content does not match the key are not cached.
+  {
+    BlobCache::Download download(cache, "t", other, data);
+    download.stream() << "abd";
+    download.commit();
+  }
+  EXPECT_FALSE(cache.contains("t", other));
+
+  // Names that are not a table and a key are not cached.
+  {
+    BlobCache::Download download(cache, "..", other, data);
+    download.stream() << "abc";
+    download.commit();
+  }
+  EXPECT_FALSE(cache.contains("..", other));
+  EXPECT_FALSE(cache.contains("t", "../t/" + key));
+  EXPECT_EQ(cache.size(), 6u);
+
+  cache.remove("t", key);
+  EXPECT_FALSE(cache.contains("t", key));
+  EXPECT_FALSE(exists(directory + "/t/" + key));
+  EXPECT_EQ(cache.size(), 0u);
+
+  EXPECT_FALSE(BlobCache(std::string(), 1024).isValid());
+  EXPECT_FALSE(BlobCache("/tmp/cppcrate_missing_directory/cache", 1024).isValid());
+  std::system(("rm -rf " + directory).c_str());
+}
+
+TEST(BlobCacheTests, RemoveTable) {
+  using CppCrate::BlobCache;
+
+  std::system(("rm -rf " + directory).c_str());
+  BlobCache cache(directory, 1024);
+  const std::string key = store(cache, "t", "123456");
+  store(cache, "t", "abc");
+  store(cache, "t2", "123456");
+  store(cache, "u", "123456");
+  EXPECT_EQ(cache.size(), 21u);
+
+  cache.removeTable("t");
+  EXPECT_FALSE(cache.contains("t", key));
+  EXPECT_FALSE(exists(directory + "/t/" + key));
+  EXPECT_TRUE(cache.contains("t2", key));
+  EXPECT_TRUE(cache.contains("u", key));
+  EXPECT_EQ(cache.size(), 12u);
+
+  cache.removeTable("..");
+  cache.removeTable("missing");
+  EXPECT_EQ(cache.size(), 12u);
+  std::system(("rm -rf " + directory).c_str());
+}
+
+TEST(BlobCacheTests, Eviction) {
+  using CppCrate::BlobCache;
+
+  std::system(("rm -rf " + directory).c_str());
+  BlobCache cache(directory, 10);
+  const std::string a = store(cache, "t", "aaaa");
+  const std::string b = store(cache, "t", "bbbb");
+  EXPECT_EQ(cache.size(), 8u);
+
+  // The least recently used blob is evicted.
+  EXPECT_TRUE(cache.contains("t", a));
+  const std::string c = store(cache, "u", "cccc");
+  EXPECT_TRUE(cache.contains("t", a));
+  EXPECT_FALSE(cache.contains("t", b));
+  EXPECT_FALSE(exists(directory + "/t/" + b));
+  EXPECT_TRUE(cache.contains("u", c));
+  EXPECT_EQ(cache.size(), 8u);
+
+  // Blobs larger than the cache are not cached.
+  const std::string large = store(cache, "t", "01234567890");
+  EXPECT_FALSE(cache.contains("t", large));
+  EXPECT_EQ(cache.size(), 8u);
+  std::system(("rm -rf " + directory).c_str());
+}
+
+TEST(BlobCacheTests, RemoveWhileReading) {
+  using CppCrate::BlobCache;
+
+  std::system(("rm -rf " + directory).c_str());
+  BlobCache cache(directory, 1024);
+  const std::string key = store(cache, "t", "123456");
+
+  // The file is deleted once the read finished.
+  RemovingBuffer buffer(cache, "t", key);
+  std::ostream data(&buffer);
+  EXPECT_EQ(cache.read("t", key, data), BlobCache::Read);
+  EXPECT_EQ(buffer.str(), "123456");
+  EXPECT_FALSE(cache.contains("t", key));
+  EXPECT_FALSE(exists(directory + "/t/" + key));
+  EXPECT_EQ(cache.size(), 0u);
+
+  // A cached file that vanished is forgotten.
+  store(cache, "t", "123456");
+  std::remove((directory + "/t/" + key).c_str());
+  std::ostringstream other;
+  EXPECT_EQ(cache.read("t", key, other), BlobCache::NotCached);
+  EXPECT_FALSE(cache.contains("t", key));
+  std::system(("rm -rf " + directory).c_str());
+}
+
+TEST(BlobCacheTests, Load) {
+  using CppCrate::BlobCache;
+
+  std::system(("rm -rf " + directory).c_str());
+  std::string a;
+  std::string b;
+  {
+    BlobCache cache(directory, 1024);
+    a = store(cache, "t", "aaaa");
+    b = store(cache, "u", "bbbb");
+  }
+  std::ofstream((directory + "/t/" + a + ".7.part").c_str()) << "aa";
+  std::ofstream((directory + "/t/other").c_str()) << "other";
+
+  // Blobs are picked up, leftovers of downloads are deleted and other files are ignored.
+  BlobCache cache(directory, 1024);
+  EXPECT_EQ(cache.size(), 8u);
+  EXPECT_EQ(read(cache, "t", a), "aaaa");
+  EXPECT_EQ(read(cache, "u", b), "bbbb");
+  EXPECT_FALSE(exists(directory + "/t/" + a + ".7.part"));
+  EXPECT_TRUE(exists(directory + "/t/other"));
+
+  // The size limit applies to loaded blobs as well.
+  EXPECT_EQ(BlobCache(directory, 6).size(), 4u);
+  std::system(("rm -rf " + directory).c_str());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <cppcrate/bulkresult.h>
+#include <cppcrate/bulkwriter.h>
+#include <cppcrate/client.h>
+
+#include "fakeserver.h"
+
+#include <algorithm>
+
+TEST(BulkWriterTests, BulkResult) {
+  using CppCrate::BulkResult;
+  using CppCrate::RawResult;
+
+  BulkResult empty;
+  EXPECT_TRUE(empty);
+  EXPECT_EQ(empty.size(), 0);
+  EXPECT_EQ(empty.errorString(), "");
+  EXPECT_TRUE(empty.isFailed(0));
+
+  BulkResult r(5);
+  EXPECT_FALSE(r);
+  EXPECT_EQ(r.failedCount(), 5);
+
+  r.setChunkResult(0, 2, RawResult("{\"results\":[{\"rowcount\":1},{\"rowcount\":-2}]}"));
+  r.setChunkResult(2, 2, RawResult("{\"results\":[{\"rowcount\":3},{\"rowcount\":0}]}"));
+  r.setChunkResult(4, 1, RawResult("{\"results\":[{\"rowcount\":1}]}"));
+  EXPECT_TRUE(r.hasError());
+  EXPECT_EQ(r.rowCount(0), 1);
+  EXPECT_EQ(r.rowCount(1), -2);
+  EXPECT_EQ(r.rowCount(2), 3);
+  EXPECT_EQ(r.rowCount(3), 0);
+  EXPECT_EQ(r.rowCount(4), 1);
+  EXPECT_EQ(r.rowCount(5), -2);
+  EXPECT_EQ(r.failedCount(), 1);
+  EXPECT_EQ(r.failedRows(), std::vector<int>({1}));
+  EXPECT_EQ(r.errorString(), "[crate] Error in bulk arguments [2].");
+
+  // Retrying the failed row
+  r.setChunkResult(1, 1, RawResult("{\"results\":[{\"rowcount\":1}]}"));
+  EXPECT_TRUE(r);
+  EXPECT_EQ(r.errorString(), "");
+
+  // A chunk that failed as a whole, or a reply with too few results
+  r.setChunkResult(3, 5, RawResult("{\"error\":{\"message\":\"m\",\"code\":4000}}"));
+  r.setChunkResult(0, 2, RawResult("{\"results\":[{\"rowcount\":1}]}"));
+  EXPECT_EQ(r.failedRows(), std::vector<int>({1, 3, 4}));
+  EXPECT_EQ(r.errorString(), "[crate] m (4000)");
+
+  // Retrying the chunk clears its error
+  r.setChunkResult(3, 2, RawResult("{\"results\":[{\"rowcount\":1},{\"rowcount\":1}]}"));
+  EXPECT_EQ(r.failedRows(), std::vector<int>({1}));
+  EXPECT_EQ(r.errorString(), "[crate] Error in bulk arguments [2].");
+  r.setChunkResult(1, 1, RawResult("{\"results\":[{\"rowcount\":1}]}"));
+  EXPECT_TRUE(r);
+  EXPECT_EQ(r.errorString(), "");
+
+  // With several failed chunks the error of the first remaining one is kept
+  r.setChunkResult(0, 2, RawResult("a"));
+  r.setChunkResult(2, 2, RawResult("{\"error\":{\"message\":\"m\",\"code\":4000}}"));
+  r.setChunkResult(4, 1, RawResult("{}"));
+  EXPECT_EQ(r.failedCount(), 5);
+  EXPECT_EQ(r.errorString().compare(0, 7, "[json] "), 0);
+  r.setChunkResult(0, 2, RawResult("{\"results\":[{\"rowcount\":1},{\"rowcount\":1}]}"));
+  EXPECT_EQ(r.errorString(), "[crate] m (4000)");
+  r.setChunkResult(2, 2, RawResult("{\"results\":[{\"rowcount\":1},{\"rowcount\":-2}]}"));
+  EXPECT_EQ(r.errorString(), "[CppCrate] The reply contains no bulk results.");
+  r.setChunkResult(4, 1, RawResult("{\"results\":[{\"rowcount\":1}]}"));
+  EXPECT_EQ(r.errorString(), "[crate] Error in bulk arguments [4].");
+
+  BulkResult copy = r;
+  EXPECT_EQ(copy, r);
+  copy.setChunkResult(3, 1, RawResult("a"));
+  EXPECT_NE(copy, r);
+}
+
+TEST(BulkWriterTests, Properties) {
+  using namespace CppCrate;
+
+  Client c;
+  BulkWriter w(c, 0, -1);
+  EXPECT_EQ(w.chunkSize(), 1);
+  EXPECT_EQ(w.maxParallelChunks(), 1);
+  w.setChunkSize(100);
+  w.setMaxParallelChunks(3);
+  EXPECT_EQ(w.chunkSize(), 100);
+  EXPECT_EQ(w.maxParallelChunks(), 3);
+  w.setChunkSize(0);
+  EXPECT_EQ(w.chunkSize(), 100);
+}
+
+TEST(BulkWriterTests, Write) {
+  using namespace CppCrate;
+
+  Client c;
+  BulkWriter w(c, 2, 2);
+
+  const BulkResult none = w.write(Query("a"));
+  EXPECT_TRUE(none);
+  EXPECT_EQ(none.size(), 0);
+
+  Query q("a");
+  for (int i = 0; i < 5; ++i) q.bind(i).nextRow();
+
+  BulkResult r = w.write(q);
+  EXPECT_EQ(r.size(), 5);
+  EXPECT_EQ(r.failedCount(), 5);
+  EXPECT_EQ(r.errorString(), "[CppCrate] CppCrate::Client is not connected. (0)");
+
+  // Every chunk is answered by its own request. The second row of the second chunk fails.
+  FakeServer server([](const FakeServer::Request& request) {
+    if (request.body.find("[[2],[3]]") != std::string::npos)
+      return FakeServer::Response(200, "{\"results\":[{\"rowcount\":1},{\"rowcount\":-2}]}");
+    if (request.body.find("[[4]]") != std::string::npos)
+      return FakeServer::Response(200, "{\"results\":[{\"rowcount\":3}]}");
+    return FakeServer::Response(200, "{\"results\":[{\"rowcount\":1},{\"rowcount\":2}]}");
+  });
+  ASSERT_TRUE(c.connect(server.url()));
+  r = w.write(q);
+
+  std::vector<std::string> bodies;
+  const std::vector<FakeServer::Request> requests = server.requests();
+  for (std::size_t i = 0; i < requests.size(); ++i) bodies.push_back(requests[i].body);
+  std::sort(bodies.begin(), bodies.end());
+  ASSERT_EQ(bodies.size(), 3u);
+  EXPECT_EQ(bodies[0], "{\"stmt\":\"a\",\"bulk_args\":[[0],[1]]}");
+  EXPECT_EQ(bodies[1], "{\"stmt\":\"a\",\"bulk_args\":[[2],[3]]}");
+  EXPECT_EQ(bodies[2], "{\"stmt\":\"a\",\"bulk_args\":[[4]]}");
+
+  EXPECT_EQ(r.rowCount(0), 1);
+  EXPECT_EQ(r.rowCount(1), 2);
+  EXPECT_EQ(r.rowCount(2), 1);
+  EXPECT_EQ(r.rowCount(3), -2);
+  EXPECT_EQ(r.rowCount(4), 3);
+  EXPECT_EQ(r.failedCount(), 1);
+  EXPECT_EQ(r.failedRows(), std::vector<int>({3}));
+  EXPECT_EQ(r.errorString(), "[crate] Error in bulk arguments [4].");
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -3,6 +3,12 @@
 #include <cppcrate/client.h>
 #include <cppcrate/result.h>
 
+#include "fakeserver.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
 TEST(ClientTests, Connections) {
   using namespace CppCrate;
 
@@ -48,11 +54,28 @@ TEST(ClientTests, DisconnectedClient) {
   std::istringstream is;
   EXPECT_FALSE(c.uploadBlob("a", is));
   EXPECT_FALSE(c.uploadBlob("a", "/tmp/cppcrateblob"));
+  const std::vector<std::string> files(2, "/tmp/cppcrateblob");
+  std::vector<BlobResult> results = c.uploadBlobs("a", files);
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(results[1].errorString(), "Client is not connected.");
+  results = c.downloadBlobs("a", files, "/tmp");
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(results[1].key(), "/tmp/cppcrateblob");
+  EXPECT_EQ(results[1].errorString(), "Client is not connected.");
+  EXPECT_EQ(c.maxBlobTransfers(), 8);
+  c.setMaxBlobTransfers(0);
+  EXPECT_EQ(c.maxBlobTransfers(), 1);
+  EXPECT_FALSE(c.setBlobCache("/tmp/cppcrate_missing_directory/cache", 1024));
+  EXPECT_FALSE(c.setBlobCache("/tmp/cppcrate_client_cache", 0));
+  EXPECT_TRUE(c.setBlobCache("/tmp/cppcrate_client_cache", 1024));
   std::ostringstream os;
   EXPECT_FALSE(c.downloadBlob("a", "b", os));
+  EXPECT_FALSE(c.downloadBlob("a", "b", "/tmp/cppcrateblob", 4));
   EXPECT_FALSE(c.downloadBlob("a", "b", "/tmp/cppcrateblob"));
   EXPECT_FALSE(c.existsBlob("a", "b"));
   EXPECT_FALSE(c.deleteBlob("a", "b"));
+  c.clearBlobCache();
+  std::remove("/tmp/cppcrate_client_cache");
 }
 
 TEST(ClientTests, DefaultSchema) {
@@ -78,6 +101,43 @@ TEST(ClientTests, DefaultSchema) {
   EXPECT_EQ(c.defaultSchema(), "");
 }
 
+TEST(ClientTests, Compression) {
+  using namespace CppCrate;
+
+  Client c;
+  EXPECT_FALSE(c.replyCompression());
+  c.setReplyCompression(true);
+  EXPECT_TRUE(c.replyCompression());
+  ASSERT_TRUE(c.connect("foo://bar"));
+  EXPECT_TRUE(c.replyCompression());
+
+#ifdef ENABLE_COMPRESSION_SUPPORT
+  EXPECT_EQ(c.requestCompressionThreshold(), -1);
+  c.setRequestCompressionThreshold(0);
+  EXPECT_EQ(c.requestCompressionThreshold(), 0);
+  EXPECT_TRUE(c.execRaw("SELECT 1").hasError());
+  c.setRequestCompressionThreshold(-2);
+  EXPECT_EQ(c.requestCompressionThreshold(), -1);
+#endif
+}
+
+TEST(ClientTests, NodeRefresh) {
+  using namespace CppCrate;
+
+  Client c;
+  EXPECT_EQ(c.nodeRefreshInterval(), 0);
+  c.setNodeRefreshInterval(10);
+  EXPECT_EQ(c.nodeRefreshInterval(), 10);
+
+  // Unreachable seeds are kept.
+  ASSERT_TRUE(c.connect("foo://bar"));
+  EXPECT_FALSE(c.exec("SELECT 1"));
+  EXPECT_EQ(c.clusterNodes(), std::vector<Node>());
+  c.setNodeRefreshInterval(0);
+  EXPECT_EQ(c.nodeRefreshInterval(), 0);
+  c.disconnect();
+}
+
 TEST(ClientTests, UnaccessibleNodesWithAuthentication) {
   using namespace CppCrate;
 
@@ -93,6 +153,7 @@ TEST(ClientTests, UnaccessibleNodesWithAuthentication) {
   options.emplace_back(Client::ConnectToFirstNodeAlways);
   options.emplace_back(Client::ConnectToLastAccessedNode);
   options.emplace_back(Client::ConnectToRandomNode);
+  options.emplace_back(Client::ConnectToLeastLoadedNode);
   for (std::size_t i = 0, total = options.size(); i < total; ++i) {
     c.connect(nodes, options[i]);
     ASSERT_TRUE(c);
@@ -130,6 +191,66 @@ TEST(ClientTests, UnaccessibleNodesWithAuthentication) {
   }
 }
 
+TEST(ClientTests, AsyncExecution) {
+  using namespace CppCrate;
+
+  Client c;
+  EXPECT_FALSE(c.execAsync("a").get());
+  EXPECT_FALSE(c.execRawAsync(Query("a")).get());
+
+  bool called = false;
+  c.execAsync(Query("a"), [&called](const Result& result) { called = !result; });
+  EXPECT_TRUE(called);
+
+  std::vector<Node> nodes;
+  nodes.push_back(Node("foo://bar"));
+  nodes.push_back(Node("foo://baz"));
+  ASSERT_TRUE(c.connect(nodes));
+
+  std::vector<std::future<Result>> results;
+  for (int i = 0; i < 10; ++i) results.push_back(c.execAsync("a"));
+  std::future<RawResult> raw = c.execRawAsync(Query("a"));
+  for (std::size_t i = 0; i < results.size(); ++i) EXPECT_FALSE(results[i].get());
+  EXPECT_FALSE(raw.get());
+
+  // Requests in flight are cancelled on disconnect.
+  std::future<Result> cancelled = c.execAsync("a");
+  c.disconnect();
+  EXPECT_FALSE(cancelled.get());
+}
+
+#ifdef ENABLE_BLOB_SUPPORT
+TEST(ClientTests, BlobCacheDeleted) {
+  using namespace CppCrate;
+
+  // The blob is served once and deleted by someone else afterwards.
+  const std::string key = "7c4a8d09ca3762af61e59520943dc26494f8941b";
+  std::atomic<bool> deleted(false);
+  FakeServer server([&deleted](const FakeServer::Request& request) {
+    if (request.path == "/_sql") return FakeServer::Response(200, "{\"rows\":[],\"rowcount\":1}");
+    if (deleted.exchange(true)) return FakeServer::Response(404);
+    return FakeServer::Response(200, "123456");
+  });
+  std::system("rm -rf /tmp/cppcrate_client_cache");
+  Client c;
+  ASSERT_TRUE(c.connect(server.url()));
+  ASSERT_TRUE(c.setBlobCache("/tmp/cppcrate_client_cache", 1024));
+  std::ostringstream data;
+  EXPECT_TRUE(c.downloadBlob("t", key, data));
+
+  // existsBlob() asks the cluster instead of the cache.
+  EXPECT_FALSE(c.existsBlob("t", key));
+  data.str(std::string());
+  EXPECT_TRUE(c.downloadBlob("t", key, data));
+  EXPECT_EQ(data.str(), "123456");
+
+  // Dropping the table removes its blobs from the cache.
+  EXPECT_TRUE(c.removeBlobStorage("t"));
+  EXPECT_FALSE(c.downloadBlob("t", key, data));
+  std::system("rm -rf /tmp/cppcrate_client_cache");
+}
+#endif
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
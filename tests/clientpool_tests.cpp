@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <cppcrate/clientpool.h>
+
+#include <cstdio>
+#include <sstream>
+#include <thread>
+
+TEST(ClientPoolTests, Connections) {
+  using namespace CppCrate;
+
+  ClientPool pool(4);
+  EXPECT_EQ(pool.maxConnections(), 4);
+  EXPECT_EQ(pool.openConnections(), 0);
+  EXPECT_FALSE(pool);
+
+  EXPECT_TRUE(pool.connect("localhost:4200"));
+  EXPECT_TRUE(pool);
+  EXPECT_TRUE(pool.isConnected());
+  EXPECT_EQ(pool.openConnections(), 1);
+  pool.disconnect();
+  EXPECT_FALSE(pool.isConnected());
+  EXPECT_EQ(pool.openConnections(), 0);
+
+  std::vector<Node> nodes;
+  nodes.push_back(Node("localhost:4200"));
+  nodes.push_back(Node("localhost:4200"));
+  EXPECT_TRUE(pool.connect(nodes, Client::ConnectToRandomNode));
+  EXPECT_TRUE(pool.isConnected());
+  pool.disconnect();
+
+  ClientPool minimal(0);
+  EXPECT_EQ(minimal.maxConnections(), 1);
+}
+
+TEST(ClientPoolTests, DisconnectedPool) {
+  using namespace CppCrate;
+
+  ClientPool pool;
+  EXPECT_FALSE(pool.exec("a"));
+  EXPECT_FALSE(pool.execRaw(Query("a")));
+  EXPECT_EQ(pool.exec("a"), pool.exec(Query("a")));
+
+  std::istringstream is;
+  EXPECT_FALSE(pool.uploadBlob("a", is));
+  const std::vector<std::string> files(2, "/tmp/cppcrateblob");
+  std::vector<BlobResult> results = pool.uploadBlobs("a", files);
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(results[1].errorString(), "ClientPool is not connected.");
+  results = pool.downloadBlobs("a", files, "/tmp");
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(results[1].key(), "/tmp/cppcrateblob");
+  EXPECT_EQ(results[1].errorString(), "ClientPool is not connected.");
+  EXPECT_EQ(pool.maxBlobTransfers(), 8);
+  pool.setMaxBlobTransfers(0);
+  EXPECT_EQ(pool.maxBlobTransfers(), 1);
+  EXPECT_FALSE(pool.setBlobCache("/tmp/cppcrate_missing_directory/cache", 1024));
+  EXPECT_FALSE(pool.setBlobCache("/tmp/cppcrate_clientpool_cache", 0));
+  EXPECT_TRUE(pool.setBlobCache("/tmp/cppcrate_clientpool_cache", 1024));
+  std::ostringstream os;
+  EXPECT_FALSE(pool.downloadBlob("a", "b", os));
+  EXPECT_FALSE(pool.downloadBlob("a", "b", "/tmp/cppcrateblob", 4));
+  EXPECT_FALSE(pool.existsBlob("a", "b"));
+  EXPECT_FALSE(pool.deleteBlob("a", "b"));
+  pool.clearBlobCache();
+  std::remove("/tmp/cppcrate_clientpool_cache");
+}
+
+TEST(ClientPoolTests, DefaultSchema) {
+  using namespace CppCrate;
+
+  ClientPool pool;
+  EXPECT_EQ(pool.defaultSchema(), "");
+  pool.setDefaultSchema("a");
+  EXPECT_EQ(pool.defaultSchema(), "a");
+  pool.clearDefaultSchema();
+  EXPECT_EQ(pool.defaultSchema(), "");
+}
+
+TEST(ClientPoolTests, Compression) {
+  using namespace CppCrate;
+
+  ClientPool pool;
+  EXPECT_FALSE(pool.replyCompression());
+  pool.setReplyCompression(true);
+  EXPECT_TRUE(pool.replyCompression());
+
+#ifdef ENABLE_COMPRESSION_SUPPORT
+  EXPECT_EQ(pool.requestCompressionThreshold(), -1);
+  pool.setRequestCompressionThreshold(1024);
+  EXPECT_EQ(pool.requestCompressionThreshold(), 1024);
+  pool.setRequestCompressionThreshold(-5);
+  EXPECT_EQ(pool.requestCompressionThreshold(), -1);
+
+  // Compressed bodies fail over like uncompressed ones.
+  std::vector<Node> nodes;
+  nodes.push_back(Node("foo://bar"));
+  nodes.push_back(Node("foo://baz"));
+  ASSERT_TRUE(pool.connect(nodes));
+  pool.setRequestCompressionThreshold(0);
+  Result r = pool.exec("SELECT 1");
+  EXPECT_TRUE(r.hasError());
+  EXPECT_EQ(r.errorString().compare(0, 7, "[curl] "), 0);
+#endif
+}
+
+TEST(ClientPoolTests, NodeRefresh) {
+  using namespace CppCrate;
+
+  ClientPool pool;
+  EXPECT_EQ(pool.nodeRefreshInterval(), 0);
+  pool.setNodeRefreshInterval(-1);
+  EXPECT_EQ(pool.nodeRefreshInterval(), 0);
+  pool.setNodeRefreshInterval(10);
+  EXPECT_EQ(pool.nodeRefreshInterval(), 10);
+
+  // Unreachable seeds are kept.
+  ASSERT_TRUE(pool.connect("foo://bar"));
+  EXPECT_TRUE(pool.exec("SELECT 1").hasError());
+  pool.setNodeRefreshInterval(0);
+  EXPECT_EQ(pool.nodeRefreshInterval(), 0);
+  pool.setNodeRefreshInterval(10);
+  pool.disconnect();
+  EXPECT_EQ(pool.nodeRefreshInterval(), 10);
+}
+
+TEST(ClientPoolTests, ConcurrentRequests) {
+  using namespace CppCrate;
+
+  std::vector<Node> nodes;
+  nodes.push_back(Node("foo://bar"));
+  nodes.push_back(Node("foo://baz"));
+
+  ClientPool pool(3);
+  ASSERT_TRUE(pool.connect(nodes, Client::ConnectToLastAccessedNode));
+  pool.setDefaultSchema("b");
+
+  std::vector<int> failures(8, 0);
+  std::vector<std::thread> workers;
+  for (std::size_t i = 0; i < failures.size(); ++i) {
+    workers.emplace_back([&pool, &failures, i]() {
+      for (int j = 0; j < 10; ++j) {
+        if (!pool.exec("a")) ++failures[i];
+        std::ostringstream os;
+        if (!pool.downloadBlob("a", "b", os)) ++failures[i];
+      }
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+
+  for (std::size_t i = 0; i < failures.size(); ++i) EXPECT_EQ(failures[i], 20);
+  EXPECT_LE(pool.openConnections(), pool.maxConnections());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cppcrate/column.h>
+#include <cppcrate/result.h>
+
+TEST(ColumnTests, Constructor) {
+  using CppCrate::Column;
+
+  Column c;
+  EXPECT_EQ(c.type(), Column::InvalidType);
+  EXPECT_EQ(c.name(), "");
+  EXPECT_EQ(c.size(), 0);
+  EXPECT_EQ(c.nullCount(), 0);
+  EXPECT_TRUE(c.isNull(0));
+  EXPECT_TRUE(c.nullBitmap().empty());
+  EXPECT_EQ(c.string(0), "");
+  EXPECT_EQ(c, Column());
+}
+
+TEST(ColumnTests, Decode) {
+  using CppCrate::Column;
+  using CppCrate::CrateDataType;
+  using CppCrate::RawResult;
+  using CppCrate::Result;
+
+  const Result result(
+      RawResult("{\"cols\":[\"id\",\"name\",\"score\",\"flag\",\"tags\"],"
+                "\"col_types\":[10,4,6,3,[100,4]],"
+                "\"rows\":[[1,\"Calvin\",1.5,true,[\"a\"]],"
+                "[null,null,2,false,null],"
+                "[3,\"Hobbes\",\"x\",1,[]]]}"));
+  ASSERT_TRUE(result);
+
+  Column id = result.column(0);
+  EXPECT_EQ(id.name(), "id");
+  EXPECT_EQ(id.crateType().type(), CrateDataType::Long);
+  EXPECT_EQ(id.type(), Column::Int64Type);
+  EXPECT_EQ(id.size(), 3);
+  EXPECT_EQ(id.int64s(), std::vector<int64_t>({1, 0, 3}));
+  EXPECT_TRUE(id.doubles().empty());
+  EXPECT_EQ(id.nullCount(), 1);
+  EXPECT_FALSE(id.isNull(0));
+  EXPECT_TRUE(id.isNull(1));
+  EXPECT_EQ(id.nullBitmap(), std::vector<uint8_t>({2}));
+
+  Column name = result.column("name");
+  EXPECT_EQ(name.type(), Column::StringType);
+  EXPECT_EQ(name.stringData(), "CalvinHobbes");
+  EXPECT_EQ(name.stringOffsets(), std::vector<std::size_t>({0, 6, 6, 12}));
+  EXPECT_EQ(name.string(2), "Hobbes");
+  EXPECT_EQ(name.string(3), "");
+  EXPECT_TRUE(name.isNull(1));
+
+  // Values not matching the storage type are null.
+  Column score = result.column("score");
+  EXPECT_EQ(score.type(), Column::DoubleType);
+  EXPECT_EQ(score.doubles(), std::vector<double>({1.5, 2.0, 0.0}));
+  EXPECT_EQ(score.nullCount(), 1);
+  EXPECT_TRUE(score.isNull(2));
+
+  Column flag = result.column("flag");
+  EXPECT_EQ(flag.type(), Column::BoolType);
+  EXPECT_EQ(flag.bools(), std::vector<uint8_t>({1, 0, 0}));
+  EXPECT_TRUE(flag.isNull(2));
+
+  Column tags = result.column(4);
+  EXPECT_EQ(tags.type(), Column::StringType);
+  EXPECT_EQ(tags.string(0), "[\"a\"]");
+  EXPECT_TRUE(tags.isNull(1));
+  EXPECT_EQ(tags.string(2), "[]");
+
+  EXPECT_EQ(result.column(5).type(), Column::InvalidType);
+  EXPECT_EQ(result.column(-1).type(), Column::InvalidType);
+  EXPECT_EQ(result.column("foo").type(), Column::InvalidType);
+
+  EXPECT_EQ(id, result.column("id"));
+  EXPECT_NE(id, name);
+}
+
+TEST(ColumnTests, EmptyResult) {
+  using CppCrate::Column;
+  using CppCrate::RawResult;
+  using CppCrate::Result;
+
+  const Result result(RawResult("{\"cols\":[\"a\"],\"col_types\":[9],\"rows\":[]}"));
+  Column c = result.column(0);
+  EXPECT_EQ(c.type(), Column::Int64Type);
+  EXPECT_EQ(c.size(), 0);
+  EXPECT_TRUE(c.int64s().empty());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
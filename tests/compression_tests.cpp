@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include "../src/compression.h"
+
+#include <zlib.h>
+
+#include <string>
+
+namespace {
+// Reads everything from \a reader using a buffer of \a bufferSize bytes.
+std::string readAll(CppCrate::GzipReader& reader, std::size_t bufferSize) {
+  std::string compressed;
+  std::string buffer(bufferSize, '\0');
+  while (std::size_t read = reader.read(&buffer[0], buffer.size())) {
+    compressed.append(buffer, 0, read);
+  }
+  return compressed;
+}
+
+std::string gunzip(const std::string& compressed) {
+  z_stream stream = z_stream();
+  EXPECT_EQ(inflateInit2(&stream, 15 + 16), Z_OK);
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+  stream.avail_in = static_cast<uInt>(compressed.size());
+
+  std::string data;
+  char buffer[1024];
+  int code = Z_OK;
+  while (code == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    stream.avail_out = sizeof(buffer);
+    code = inflate(&stream, Z_NO_FLUSH);
+    data.append(buffer, sizeof(buffer) - stream.avail_out);
+  }
+  EXPECT_EQ(code, Z_STREAM_END);
+  inflateEnd(&stream);
+  return data;
+}
+}
+
+TEST(CompressionTests, Settings) {
+  using CppCrate::Compression;
+
+  Compression c;
+  EXPECT_FALSE(c.replies);
+  EXPECT_EQ(c.requestThreshold, -1);
+  EXPECT_TRUE(c == Compression());
+
+  c.replies = true;
+  EXPECT_TRUE(c != Compression());
+}
+
+TEST(CompressionTests, GzipReader) {
+  using CppCrate::GzipReader;
+
+  std::string body = "{\"stmt\":\"INSERT INTO t (id, name) VALUES (?, ?)\",\"bulk_args\":[";
+  for (int i = 0; i < 1000; ++i) body += "[" + std::to_string(i) + ",\"name\"],";
+  body.back() = ']';
+  body += "}";
+
+  GzipReader reader;
+  ASSERT_TRUE(reader.isValid());
+  reader.reset(body.data(), body.size());
+  const std::string compressed = readAll(reader, 7);
+  EXPECT_FALSE(reader.hasError());
+  EXPECT_LT(compressed.size(), body.size() / 4);
+  EXPECT_EQ(gunzip(compressed), body);
+  EXPECT_EQ(reader.read(&body[0], 10), 0u);
+
+  // Rewinding restarts the same stream, resetting compresses new data.
+  EXPECT_TRUE(reader.rewind());
+  EXPECT_EQ(readAll(reader, 16384), compressed);
+  reader.reset("", 0);
+  EXPECT_EQ(gunzip(readAll(reader, 100)), "");
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
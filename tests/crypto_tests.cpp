@@ -3,6 +3,7 @@
 #include "../src/crypto.h"
 
 #include <string>
+#include <vector>
 
 TEST(CryptoTests, FileSize) {
   using CppCrate::Crypto;
@@ -10,6 +11,11 @@ TEST(CryptoTests, FileSize) {
   std::string str = "123456";
   std::istringstream stream(str);
   EXPECT_EQ(Crypto::fileSize(stream), 6);
+
+  // A stream read to its end is rewound.
+  Crypto::sha1(stream);
+  EXPECT_EQ(Crypto::fileSize(stream), 6);
+  EXPECT_EQ(stream.get(), '1');
 }
 
 TEST(CryptoTests, Sha1) {
@@ -20,6 +26,43 @@ TEST(CryptoTests, Sha1) {
   EXPECT_EQ(Crypto::sha1(stream), "7c4a8d09ca3762af61e59520943dc26494f8941b");
 }
 
+TEST(CryptoTests, Sha1Memory) {
+  using CppCrate::Crypto;
+
+  EXPECT_EQ(Crypto::sha1("123456", 6), "7c4a8d09ca3762af61e59520943dc26494f8941b");
+  EXPECT_EQ(Crypto::sha1("", 0), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+
+  // Sizes around the block size of 64 bytes.
+  std::string data;
+  for (int i = 0; i < 200; ++i) data += static_cast<char>(i * 7);
+  for (std::size_t size = 0; size <= data.size(); ++size) {
+    std::istringstream stream(data.substr(0, size));
+    EXPECT_EQ(Crypto::sha1(data.data(), size), Crypto::sha1(stream));
+  }
+}
+
+TEST(CryptoTests, Sha1Batch) {
+  using CppCrate::Crypto;
+  using CppCrate::Sha1;
+
+  EXPECT_TRUE(Crypto::sha1Batch(std::vector<Sha1::Buffer>()).empty());
+
+  // Large buffers are hashed apart from the small ones, the order is kept anyway.
+  const std::string large(3 * 1024 * 1024, 'x');
+  std::vector<Sha1::Buffer> buffers;
+  buffers.push_back(Sha1::Buffer("123456", 6));
+  buffers.push_back(Sha1::Buffer(large.data(), large.size()));
+  buffers.push_back(Sha1::Buffer("", 0));
+  const std::vector<std::string> digests = Crypto::sha1Batch(buffers);
+  ASSERT_EQ(digests.size(), 3u);
+  EXPECT_EQ(digests[0], "7c4a8d09ca3762af61e59520943dc26494f8941b");
+  EXPECT_EQ(digests[1], Crypto::sha1(large.data(), large.size()));
+  EXPECT_EQ(digests[2], "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+
+  buffers.erase(buffers.begin() + 1, buffers.end());
+  EXPECT_EQ(Crypto::sha1Batch(buffers), std::vector<std::string>(1, digests[0]));
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
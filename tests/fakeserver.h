@@ -0,0 +1,227 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Minimal HTTP/1.1 server on 127.0.0.1 that answers every request with the response returned by a
+// handler. It is used to feed canned replies to the client and to inspect the requests it sends.
+class FakeServer {
+ public:
+  struct Request {
+    std::string method;
+    std::string path;  // Without the query.
+    std::string query;
+    std::map<std::string, std::string> headers;  // Names are lower case.
+    std::string body;
+
+    std::string header(const std::string& name) const {
+      const std::map<std::string, std::string>::const_iterator it = headers.find(name);
+      return it == headers.end() ? std::string() : it->second;
+    }
+  };
+
+  struct Response {
+    Response(int status = 200, const std::string& body = std::string())
+        : status(status), body(body), truncateAt(std::string::npos) {}
+
+    Response& header(const std::string& name, const std::string& value) {
+      headers.push_back(std::make_pair(name, value));
+      return *this;
+    }
+
+    int status;
+    std::vector<std::pair<std::string, std::string> > headers;
+    std::string body;
+    // If set, the connection is closed after this many bytes of the body.
+    std::size_t truncateAt;
+  };
+
+  typedef std::function<Response(const Request&)> Handler;
+
+  explicit FakeServer(Handler handler) : handler(handler), stopped(false), listener(-1), port_(0) {
+    listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    const int yes = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in address = sockaddr_in();
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, 128) != 0 ||
+        ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+      std::abort();
+    }
+    port_ = ntohs(address.sin_port);
+    acceptor = std::thread(&FakeServer::accept, this);
+  }
+
+  ~FakeServer() {
+    stopped = true;
+    acceptor.join();
+    for (std::size_t i = 0; i < connections.size(); ++i) connections[i].join();
+    ::close(listener);
+  }
+
+  int port() const { return port_; }
+  std::string url() const { return "http://127.0.0.1:" + std::to_string(port_); }
+
+  // Returns all requests received so far.
+  std::vector<Request> requests() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return received;
+  }
+
+ private:
+  FakeServer(const FakeServer&);
+  FakeServer& operator=(const FakeServer&);
+
+  // Waits up to 50 ms for \a fd to become readable. Returns false once the server is stopped.
+  bool wait(int fd) {
+    pollfd entry = {fd, POLLIN, 0};
+    while (!stopped) {
+      if (::poll(&entry, 1, 50) > 0) return true;
+    }
+    return false;
+  }
+
+  void accept() {
+    while (wait(listener)) {
+      const int fd = ::accept(listener, nullptr, nullptr);
+      if (fd >= 0) connections.push_back(std::thread(&FakeServer::serve, this, fd));
+    }
+  }
+
+  // Reads from \a fd until \a buffer holds at least \a size bytes.
+  bool fill(int fd, std::string& buffer, std::size_t size) {
+    char data[16384];
+    while (buffer.size() < size) {
+      if (!wait(fd)) return false;
+      const ssize_t count = ::recv(fd, data, sizeof(data), 0);
+      if (count <= 0) return false;
+      buffer.append(data, static_cast<std::size_t>(count));
+    }
+    return true;
+  }
+
+  // Reads from \a fd until \a buffer contains \a delimiter and returns its position.
+  std::size_t fillUntil(int fd, std::string& buffer, const std::string& delimiter) {
+    std::size_t pos;
+    while ((pos = buffer.find(delimiter)) == std::string::npos) {
+      if (!fill(fd, buffer, buffer.size() + 1)) return std::string::npos;
+    }
+    return pos;
+  }
+
+  bool send(int fd, const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+      const ssize_t count = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+      if (count <= 0) return false;
+      sent += static_cast<std::size_t>(count);
+    }
+    return true;
+  }
+
+  bool read(int fd, std::string& buffer, Request& request) {
+    const std::size_t end = fillUntil(fd, buffer, "\r\n\r\n");
+    if (end == std::string::npos) return false;
+    const std::string head = buffer.substr(0, end);
+    buffer.erase(0, end + 4);
+
+    std::size_t lineEnd = head.find("\r\n");
+    const std::string line = head.substr(0, lineEnd);
+    const std::size_t space = line.find(' ');
+    const std::string target = line.substr(space + 1, line.rfind(' ') - space - 1);
+    request.method = line.substr(0, space);
+    request.path = target.substr(0, target.find('?'));
+    if (target.find('?') != std::string::npos) request.query = target.substr(target.find('?') + 1);
+    while (lineEnd != std::string::npos) {
+      const std::size_t start = lineEnd + 2;
+      lineEnd = head.find("\r\n", start);
+      const std::string field = head.substr(start, lineEnd - start);
+      const std::size_t colon = field.find(':');
+      if (colon == std::string::npos) continue;
+      std::string name = field.substr(0, colon);
+      std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+      const std::size_t value = field.find_first_not_of(' ', colon + 1);
+      request.headers[name] = value == std::string::npos ? std::string() : field.substr(value);
+    }
+
+    if (request.header("expect") == "100-continue" && !send(fd, "HTTP/1.1 100 Continue\r\n\r\n")) {
+      return false;
+    }
+    if (request.header("transfer-encoding") == "chunked") {
+      for (;;) {
+        const std::size_t sizeEnd = fillUntil(fd, buffer, "\r\n");
+        if (sizeEnd == std::string::npos) return false;
+        const std::size_t size = std::strtoul(buffer.substr(0, sizeEnd).c_str(), nullptr, 16);
+        buffer.erase(0, sizeEnd + 2);
+        if (!fill(fd, buffer, size + 2)) return false;
+        request.body.append(buffer, 0, size);
+        buffer.erase(0, size + 2);
+        if (size == 0) return true;
+      }
+    }
+    const std::size_t size = std::strtoul(request.header("content-length").c_str(), nullptr, 10);
+    if (!fill(fd, buffer, size)) return false;
+    request.body = buffer.substr(0, size);
+    buffer.erase(0, size);
+    return true;
+  }
+
+  bool write(int fd, const Request& request, const Response& response) {
+    std::string head = "HTTP/1.1 " + std::to_string(response.status) + " Fake\r\n";
+    bool length = false;
+    for (std::size_t i = 0; i < response.headers.size(); ++i) {
+      head += response.headers[i].first + ": " + response.headers[i].second + "\r\n";
+      length = length || response.headers[i].first == "Content-Length";
+    }
+    if (!length) head += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+    head += "\r\n";
+    if (request.method == "HEAD") return send(fd, head);
+    if (response.truncateAt < response.body.size()) {
+      send(fd, head + response.body.substr(0, response.truncateAt));
+      return false;
+    }
+    return send(fd, head + response.body);
+  }
+
+  void serve(int fd) {
+    std::string buffer;
+    Request request;
+    while (read(fd, buffer, request)) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.push_back(request);
+      }
+      if (!write(fd, request, handler(request))) break;
+      request = Request();
+    }
+    ::close(fd);
+  }
+
+  Handler handler;
+  std::atomic<bool> stopped;
+  int listener;
+  int port_;
+  std::thread acceptor;
+  std::vector<std::thread> connections;  // Only accessed by the acceptor and the destructor.
+  mutable std::mutex mutex;
+  std::vector<Request> received;
+};
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include "../src/filewriter.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+std::string contents(const std::string& path) {
+  std::ifstream file(path.c_str(), std::ifstream::binary);
+  std::ostringstream data;
+  data << file.rdbuf();
+  return data.str();
+}
+}
+
+TEST(FileWriterTests, Write) {
+  using CppCrate::FileWriter;
+
+  const std::string path = "/tmp/cppcrate_filewriter";
+  std::ofstream(path.c_str(), std::ofstream::binary) << "old contents";
+  {
+    // The file is truncated and the gaps between the writes are zeros.
+    FileWriter writer(path);
+    ASSERT_TRUE(writer.isValid());
+    ASSERT_TRUE(writer.resize(8));
+    EXPECT_TRUE(writer.write("cd", 2, 2));
+    EXPECT_TRUE(writer.write("gh", 2, 6));
+    EXPECT_TRUE(writer.write("a", 1, 0));
+  }
+  EXPECT_EQ(contents(path), std::string("a\0cd\0\0gh", 8));
+
+  std::remove(path.c_str());
+  EXPECT_FALSE(FileWriter("/tmp/cppcrate_missing_directory/file").isValid());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include <cppcrate/clientpool.h>
+#include <cppcrate/insertcoalescer.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace {
+// Waits up to ten seconds until \a count reaches \a expected. Returns whether it did.
+bool waitForCount(const std::atomic<int>& count, int expected) {
+  const std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (count.load() < expected) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+}
+
+TEST(InsertCoalescerTests, Properties) {
+  using namespace CppCrate;
+
+  ClientPool pool;
+  InsertCoalescer c(pool);
+  EXPECT_EQ(c.maxRows(), 1000);
+  EXPECT_EQ(c.maxDelay(), 100);
+  EXPECT_EQ(c.overflowPolicy(), InsertCoalescer::BlockOnOverflow);
+  EXPECT_EQ(c.pendingRows(), 0);
+
+  c.setMaxRows(10);
+  c.setMaxBytes(20);
+  c.setMaxDelay(30);
+  c.setHighWaterMark(40);
+  c.setOverflowPolicy(InsertCoalescer::RejectOnOverflow);
+  EXPECT_EQ(c.maxRows(), 10);
+  EXPECT_EQ(c.maxBytes(), 20u);
+  EXPECT_EQ(c.maxDelay(), 30);
+  EXPECT_EQ(c.highWaterMark(), 40);
+  EXPECT_EQ(c.overflowPolicy(), InsertCoalescer::RejectOnOverflow);
+
+  c.setMaxRows(0);
+  c.setMaxBytes(0);
+  c.setMaxDelay(-1);
+  c.setHighWaterMark(0);
+  EXPECT_EQ(c.maxRows(), 10);
+  EXPECT_EQ(c.maxBytes(), 20u);
+  EXPECT_EQ(c.maxDelay(), 30);
+  EXPECT_EQ(c.highWaterMark(), 40);
+}
+
+TEST(InsertCoalescerTests, Flush) {
+  using namespace CppCrate;
+
+  ClientPool pool;
+  InsertCoalescer c(pool);
+  c.setMaxDelay(60000);
+
+  std::mutex mutex;
+  std::vector<std::string> failed;
+  int failedRows = 0;
+  c.setErrorHandler([&](const std::string& sql, const RowBatch& rows, const BulkResult& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    failed.push_back(sql + " " + rows.json());
+    failedRows += result.failedCount();
+  });
+
+  EXPECT_TRUE(c.insert("a", "[1]"));
+  EXPECT_TRUE(c.insert("b", "[2]"));
+  Query q("a");
+  q.bind(3).nextRow().bind(4).nextRow();
+  EXPECT_TRUE(c.insert(q));
+  EXPECT_TRUE(c.insert(Query("b", "[5]")));
+  EXPECT_EQ(c.pendingRows(), 5);
+
+  c.flush();
+  EXPECT_EQ(c.pendingRows(), 0);
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(failed.size(), 2u);
+  EXPECT_EQ(failed[0], "a [[1],[3],[4]]");
+  EXPECT_EQ(failed[1], "b [[2],[5]]");
+  EXPECT_EQ(failedRows, 5);
+}
+
+TEST(InsertCoalescerTests, Thresholds) {
+  using namespace CppCrate;
+
+  ClientPool pool;
+  std::atomic<int> sent(0);
+  {
+    InsertCoalescer c(pool);
+    c.setMaxDelay(60000);
+    c.setMaxRows(2);
+    c.setErrorHandler([&sent](const std::string&, const RowBatch& rows, const BulkResult&) {
+      sent += rows.size();
+    });
+
+    // The batch is sent as soon as it is full.
+    c.insert("a", "[1]");
+    c.insert("a", "[2]");
+    ASSERT_TRUE(waitForCount(sent, 2));
+    EXPECT_EQ(c.pendingRows(), 0);
+
+    // The destructor sends the rest.
+    c.insert("a", "[3]");
+  }
+  EXPECT_EQ(sent.load(), 3);
+
+  sent = 0;
+  InsertCoalescer c(pool);
+  c.setMaxDelay(0);
+  c.setErrorHandler([&sent](const std::string&, const RowBatch& rows, const BulkResult&) {
+    sent += rows.size();
+  });
+  c.insert("a", "[1]");
+  ASSERT_TRUE(waitForCount(sent, 1));
+  EXPECT_EQ(c.pendingRows(), 0);
+}
+
+TEST(InsertCoalescerTests, Overflow) {
+  using namespace CppCrate;
+
+  ClientPool pool;
+  InsertCoalescer c(pool);
+  c.setMaxDelay(60000);
+  c.setHighWaterMark(2);
+  c.setOverflowPolicy(InsertCoalescer::RejectOnOverflow);
+
+  EXPECT_TRUE(c.insert("a", "[1]"));
+  EXPECT_TRUE(c.insert("b", "[2]"));
+  EXPECT_FALSE(c.insert("a", "[3]"));
+  EXPECT_EQ(c.pendingRows(), 2);
+
+  // Blocking producers continue once the rows were sent.
+  c.setOverflowPolicy(InsertCoalescer::BlockOnOverflow);
+  std::thread producer([&c]() { EXPECT_TRUE(c.insert("a", "[3]")); });
+  c.flush();
+  producer.join();
+  c.flush();
+  EXPECT_EQ(c.pendingRows(), 0);
+}
+
+TEST(InsertCoalescerTests, RetryFromHandler) {
+  using namespace CppCrate;
+
+  ClientPool pool;
+  std::atomic<int> handled(0);
+  InsertCoalescer c(pool);
+  c.setMaxDelay(0);
+  c.setHighWaterMark(1);
+
+  // Retrying from the handler neither blocks at the high-water mark nor waits in flush().
+  // The rows of "a" are retried once as "b".
+  c.setErrorHandler([&](const std::string& sql, const RowBatch& rows, const BulkResult& result) {
+    EXPECT_EQ(result.failedCount(), rows.size());
+    if (sql == "a") {
+      EXPECT_TRUE(c.insert(Query("b", rows)));
+      c.flush();
+    }
+    handled += rows.size();
+  });
+  EXPECT_TRUE(c.insert("a", "[1]"));
+  EXPECT_TRUE(c.insert("a", "[2]"));
+  ASSERT_TRUE(waitForCount(handled, 4));
+  c.flush();
+  EXPECT_EQ(c.pendingRows(), 0);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include "../src/mappedfile.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+TEST(MappedFileTests, Map) {
+  using CppCrate::MappedFile;
+
+  const std::string path = "/tmp/cppcrate_mappedfile";
+  {
+    std::ofstream file(path.c_str(), std::ofstream::binary);
+    file << "123456";
+  }
+  {
+    const MappedFile mapped(path);
+    ASSERT_TRUE(mapped.isValid());
+    ASSERT_EQ(mapped.size(), 6u);
+    EXPECT_EQ(std::string(mapped.data(), mapped.size()), "123456");
+  }
+
+  std::ofstream(path.c_str(), std::ofstream::binary | std::ofstream::trunc);
+  {
+    const MappedFile mapped(path);
+    EXPECT_TRUE(mapped.isValid());
+    EXPECT_EQ(mapped.size(), 0u);
+  }
+
+  std::remove(path.c_str());
+  EXPECT_FALSE(MappedFile(path).isValid());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <cppcrate/mapping.h>
+#include <cppcrate/result.h>
+
+namespace {
+struct Player {
+  Player() : id(-1), age(-1), rank(-1), score(-1.0), ratio(-1.0f), active(false) {}
+  int64_t id;
+  int32_t age;
+  int16_t rank;
+  double score;
+  float ratio;
+  bool active;
+  std::string name;
+  std::string tags;
+};
+}
+
+TEST(MappingTests, Cell) {
+  using CppCrate::Cell;
+  using CppCrate::RawResult;
+  using CppCrate::Result;
+
+  const Result result(
+      RawResult("{\"cols\":[\"a\",\"b\",\"c\",\"d\",\"e\"],\"col_types\":[10,4,6,3,[100,4]],"
+                "\"rows\":[[70000,\"Calvin\",1.5,true,[\"x\"]],[null,null,null,null,null]]}"));
+  ASSERT_TRUE(result);
+
+  int64_t ll = 0;
+  int32_t l = 0;
+  int16_t i = 0;
+  double d = 0.0;
+  bool b = false;
+  std::string s;
+
+  EXPECT_TRUE(result.cell(0, 0).read(ll));
+  EXPECT_EQ(ll, 70000);
+  EXPECT_TRUE(result.cell(0, 0).read(l));
+  EXPECT_EQ(l, 70000);
+  EXPECT_TRUE(result.cell(0, 0).read(d));
+  EXPECT_DOUBLE_EQ(d, 70000.0);
+  EXPECT_FALSE(result.cell(0, 0).read(i));  // out of range
+  EXPECT_EQ(i, 0);
+  EXPECT_FALSE(result.cell(0, 2).read(ll));  // not an integer
+  EXPECT_TRUE(result.cell(0, 1).read(s));
+  EXPECT_EQ(s, "Calvin");
+  EXPECT_FALSE(result.cell(0, 1).read(ll));
+  EXPECT_TRUE(result.cell(0, 3).read(b));
+  EXPECT_TRUE(b);
+  EXPECT_TRUE(result.cell(0, 4).read(s));
+  EXPECT_EQ(s, "[\"x\"]");
+
+  for (int column = 0; column < 5; ++column) {
+    EXPECT_TRUE(result.cell(1, column).isNull());
+    EXPECT_FALSE(result.cell(1, column).read(s));
+  }
+
+  EXPECT_TRUE(result.cell(2, 0).isNull());
+  EXPECT_TRUE(result.cell(0, 5).isNull());
+  EXPECT_TRUE(result.cell(-1, 0).isNull());
+  EXPECT_FALSE(result.cell(0, -1).read(ll));
+  EXPECT_TRUE(Cell().isNull());
+}
+
+TEST(MappingTests, Decode) {
+  using CppCrate::Mapping;
+  using CppCrate::RawResult;
+  using CppCrate::Result;
+
+  const Result result(RawResult(
+      "{\"cols\":[\"name\",\"id\",\"age\",\"rank\",\"score\",\"ratio\",\"active\",\"tags\"],"
+      "\"col_types\":[4,10,9,8,6,7,3,[100,4]],"
+      "\"rows\":[[\"Calvin\",1,6,2,1.5,0.5,true,[\"a\",\"b\"]],"
+      "[null,2,null,null,2,null,false,null]]}"));
+  ASSERT_TRUE(result);
+
+  const Mapping<Player> mapping(&Player::id, "id", &Player::age, "age", &Player::rank, "rank",
+                                &Player::score, "score", &Player::ratio, "ratio", &Player::active,
+                                "active", &Player::name, "name", &Player::tags, "tags");
+  const std::vector<Player> players = mapping.decode(result);
+  ASSERT_EQ(players.size(), 2u);
+
+  EXPECT_EQ(players[0].id, 1);
+  EXPECT_EQ(players[0].age, 6);
+  EXPECT_EQ(players[0].rank, 2);
+  EXPECT_DOUBLE_EQ(players[0].score, 1.5);
+  EXPECT_FLOAT_EQ(players[0].ratio, 0.5f);
+  EXPECT_TRUE(players[0].active);
+  EXPECT_EQ(players[0].name, "Calvin");
+  EXPECT_EQ(players[0].tags, "[\"a\",\"b\"]");
+
+  // Null values keep the default
+  EXPECT_EQ(players[1].id, 2);
+  EXPECT_EQ(players[1].age, -1);
+  EXPECT_EQ(players[1].rank, -1);
+  EXPECT_DOUBLE_EQ(players[1].score, 2.0);
+  EXPECT_FLOAT_EQ(players[1].ratio, -1.0f);
+  EXPECT_FALSE(players[1].active);
+  EXPECT_EQ(players[1].name, "");
+  EXPECT_EQ(players[1].tags, "");
+}
+
+TEST(MappingTests, Map) {
+  using CppCrate::Mapping;
+  using CppCrate::RawResult;
+  using CppCrate::Result;
+
+  const Result result(
+      RawResult("{\"cols\":[\"id\",\"name\"],\"col_types\":[10,4],\"rows\":[[1,\"Hobbes\"]]}"));
+  ASSERT_TRUE(result);
+
+  Mapping<Player> mapping;
+  EXPECT_EQ(mapping.decode(result).size(), 1u);
+  EXPECT_EQ(mapping.decode(result).front().id, -1);
+
+  mapping.map(&Player::id, "id").map(&Player::name, "name").map(&Player::age, "missing");
+  const Mapping<Player> copy = mapping;
+  std::vector<Player> players = copy.decode(result);
+  ASSERT_EQ(players.size(), 1u);
+  EXPECT_EQ(players[0].id, 1);
+  EXPECT_EQ(players[0].name, "Hobbes");
+  EXPECT_EQ(players[0].age, -1);
+
+  EXPECT_TRUE(mapping.decode(Result(RawResult("{}"))).empty());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
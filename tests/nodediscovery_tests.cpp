@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "../src/nodediscovery.h"
+#include "../src/nodelist.h"
+#include "fakeserver.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+CppCrate::Result sysNodes(const std::string& rows) {
+  return CppCrate::Result(
+      CppCrate::RawResult("{\"cols\":[\"rest_url\"],\"rows\":" + rows + ",\"rowcount\":0}"));
+}
+
+// Waits up to 10 seconds until \a nodes hold \a size nodes, the last one with \a url.
+bool waitForSize(const CppCrate::NodeList& nodes, std::size_t size, const std::string& url) {
+  const std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (std::chrono::steady_clock::now() < deadline) {
+    const std::vector<CppCrate::Node> current = nodes.nodes();
+    if (current.size() == size && current.back().url() == url) return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+}
+
+TEST(NodeDiscoveryTests, DiscoveredNodes) {
+  using namespace CppCrate;
+
+  Node seed("https://seed:4200");
+  seed.setHttpAuthentication("user", "secret");
+  const std::vector<Node> seeds(1, seed);
+
+  // The scheme and the credentials are taken from the first seed, empty URLs are skipped.
+  const std::vector<Node> nodes = NodeDiscovery::discoveredNodes(
+      sysNodes("[[\"10.0.0.1:4200\"],[null],[\"\"],[\"http://10.0.0.2:4201\"]]"), seeds);
+  ASSERT_EQ(nodes.size(), 2u);
+  EXPECT_EQ(nodes[0].url(), "https://10.0.0.1:4200");
+  EXPECT_EQ(nodes[0].httpUser(), "user");
+  EXPECT_EQ(nodes[0].httpPassword(), "secret");
+  EXPECT_EQ(nodes[1].url(), "http://10.0.0.2:4201");
+  EXPECT_EQ(nodes[1].httpUser(), "user");
+
+  // Without a seed, plain HTTP without credentials is used.
+  const std::vector<Node> plain =
+      NodeDiscovery::discoveredNodes(sysNodes("[[\"10.0.0.1:4200\"]]"), std::vector<Node>());
+  ASSERT_EQ(plain.size(), 1u);
+  EXPECT_EQ(plain[0].url(), "http://10.0.0.1:4200");
+  EXPECT_FALSE(plain[0].hasHttpAuthenticationInformation());
+
+  // Neither an empty nor a failed query discovers anything.
+  EXPECT_TRUE(NodeDiscovery::discoveredNodes(sysNodes("[]"), seeds).empty());
+  const Result error(RawResult("{\"error\":{\"message\":\"e\",\"code\":4000}}"));
+  ASSERT_TRUE(error.hasError());
+  EXPECT_TRUE(NodeDiscovery::discoveredNodes(error, seeds).empty());
+}
+
+TEST(NodeDiscoveryTests, Refresh) {
+  using namespace CppCrate;
+
+  FakeServer server([](const FakeServer::Request& request) {
+    if (request.body.find("sys.nodes") == std::string::npos) return FakeServer::Response(404);
+    return FakeServer::Response(
+        200, "{\"cols\":[\"rest_url\"],\"rows\":[[\"127.0.0.1:1\"]],\"rowcount\":1}");
+  });
+  const std::vector<Node> seeds(1, Node(server.url()));
+  NodeList nodes;
+  nodes.setNodes(seeds, Client::ConnectToFirstNodeAlways);
+
+  // The nodes are replaced by the discovered ones.
+  {
+    NodeDiscovery discovery(nodes, seeds, 60000);
+    EXPECT_TRUE(waitForSize(nodes, 1, "http://127.0.0.1:1"));
+  }
+  EXPECT_EQ(server.requests().size(), 1u);
+
+  // If the refresh fails, the seeds are added again.
+  {
+    NodeDiscovery discovery(nodes, seeds, 60000);
+    EXPECT_TRUE(waitForSize(nodes, 2, server.url()));
+  }
+  EXPECT_EQ(nodes.nodes()[0].url(), "http://127.0.0.1:1");
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
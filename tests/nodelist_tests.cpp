@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+
+#include "../src/nodelist.h"
+
+#include <vector>
+
+namespace {
+std::vector<CppCrate::Node> nodes(int count) {
+  const char* urls[] = {"http://a:4200", "http://b:4200", "http://c:4200"};
+  return std::vector<CppCrate::Node>(urls, urls + count);
+}
+
+// Returns the URL of the node the next try of \a tries would use, or "-" if none is left.
+std::string next(CppCrate::NodeList& list, CppCrate::NodeList::Tries& tries) {
+  CppCrate::Node node;
+  return list.next(tries, node) ? node.url() : "-";
+}
+
+std::string first(CppCrate::NodeList& list) {
+  CppCrate::NodeList::Tries tries;
+  return next(list, tries);
+}
+}
+
+TEST(NodeListTests, Failover) {
+  using namespace CppCrate;
+
+  NodeList list;
+  NodeList::Tries tries;
+  EXPECT_EQ(next(list, tries), "-");
+
+  list.setNodes(nodes(2), Client::ConnectToFirstNodeAlways);
+  EXPECT_EQ(next(list, tries), "http://a:4200");
+  EXPECT_EQ(next(list, tries), "http://b:4200");
+  EXPECT_EQ(next(list, tries), "-");
+  EXPECT_EQ(tries.count, 2u);
+
+  list.setNodes(nodes(2), Client::ConnectToLastAccessedNode);
+  tries = NodeList::Tries();
+  next(list, tries);
+  list.setNodeSuccess(Node("http://b:4200"), tries);
+  EXPECT_EQ(first(list), "http://a:4200");
+  next(list, tries);
+  list.setNodeSuccess(Node("http://b:4200"), tries);
+  EXPECT_EQ(first(list), "http://b:4200");
+}
+
+TEST(NodeListTests, Reordered) {
+  using namespace CppCrate;
+
+  // A request keeps trying the nodes in the order it started with, even if another request
+  // reorders the list meanwhile.
+  NodeList list;
+  list.setNodes(nodes(3), Client::ConnectToLastAccessedNode);
+  NodeList::Tries tries;
+  EXPECT_EQ(next(list, tries), "http://a:4200");
+  NodeList::Tries other;
+  next(list, other);
+  EXPECT_EQ(next(list, other), "http://b:4200");
+  list.setNodeSuccess(Node("http://b:4200"), other);
+  EXPECT_EQ(first(list), "http://b:4200");
+  EXPECT_EQ(next(list, tries), "http://b:4200");
+  EXPECT_EQ(next(list, tries), "http://c:4200");
+  EXPECT_EQ(next(list, tries), "-");
+
+  // So does a request that started before the nodes were replaced.
+  tries = NodeList::Tries();
+  EXPECT_EQ(next(list, tries), "http://b:4200");
+  list.setNodes(nodes(1), Client::ConnectToLastAccessedNode);
+  EXPECT_EQ(next(list, tries), "http://c:4200");
+  EXPECT_EQ(next(list, tries), "http://a:4200");
+  EXPECT_EQ(next(list, tries), "-");
+  EXPECT_EQ(first(list), "http://a:4200");
+}
+
+TEST(NodeListTests, CircuitBreaker) {
+  using namespace CppCrate;
+
+  NodeList list;
+  list.setNodes(nodes(3), Client::ConnectToFirstNodeAlways);
+
+  // A failed node is skipped by all following requests.
+  list.setNodeError(Node("http://a:4200"));
+  NodeList::Tries tries;
+  EXPECT_EQ(next(list, tries), "http://b:4200");
+  EXPECT_EQ(next(list, tries), "http://c:4200");
+  EXPECT_EQ(next(list, tries), "-");
+  EXPECT_EQ(first(list), "http://b:4200");
+
+  // If all nodes failed, a single try goes to the node that is due next.
+  list.setNodeError(Node("http://b:4200"));
+  list.setNodeError(Node("http://c:4200"));
+  tries = NodeList::Tries();
+  EXPECT_EQ(next(list, tries), "http://a:4200");
+  EXPECT_EQ(next(list, tries), "-");
+
+  // A success closes the circuit again.
+  list.setNodeSuccess(Node("http://c:4200"), NodeList::Tries());
+  EXPECT_EQ(first(list), "http://c:4200");
+
+  // The state survives setting the nodes again, unless a node was removed.
+  list.setNodeError(Node("http://c:4200"));
+  list.setNodes(nodes(3), Client::ConnectToFirstNodeAlways);
+  tries = NodeList::Tries();
+  next(list, tries);
+  EXPECT_EQ(next(list, tries), "-");
+  list.setNodes(nodes(2), Client::ConnectToFirstNodeAlways);
+  list.setNodes(nodes(3), Client::ConnectToFirstNodeAlways);
+  EXPECT_EQ(first(list), "http://c:4200");
+}
+
+TEST(NodeListTests, UpdateNodes) {
+  using namespace CppCrate;
+
+  NodeList list;
+  list.setNodes(nodes(2), Client::ConnectToFirstNodeAlways);
+  list.setNodeError(Node("http://a:4200"));
+
+  // Remaining nodes keep their position and state, new ones are appended.
+  std::vector<Node> discovered;
+  discovered.push_back(Node("http://c:4200"));
+  discovered.push_back(Node("http://a:4200"));
+  list.updateNodes(discovered);
+  std::vector<Node> expected;
+  expected.push_back(Node("http://a:4200"));
+  expected.push_back(Node("http://c:4200"));
+  EXPECT_EQ(list.nodes(), expected);
+  EXPECT_EQ(first(list), "http://c:4200");
+
+  // Merging does not remove any node.
+  list.updateNodes(nodes(2), true);
+  expected.push_back(Node("http://b:4200"));
+  EXPECT_EQ(list.nodes(), expected);
+  EXPECT_EQ(first(list), "http://c:4200");
+}
+
+#ifdef ENABLE_BLOB_SUPPORT
+TEST(NodeListTests, BlobNodes) {
+  using namespace CppCrate;
+
+  NodeList list;
+  Node node;
+  EXPECT_FALSE(list.blobNode("/_blobs/t/a", node));
+
+  list.setBlobNode("/_blobs/t/a", Node("http://b:4200"));
+  ASSERT_TRUE(list.blobNode("/_blobs/t/a", node));
+  EXPECT_EQ(node.url(), "http://b:4200");
+  EXPECT_FALSE(list.blobNode("/_blobs/u/a", node));
+
+  list.setBlobNode("/_blobs/t/a", Node("http://c:4200"));
+  ASSERT_TRUE(list.blobNode("/_blobs/t/a", node));
+  EXPECT_EQ(node.url(), "http://c:4200");
+
+  list.removeBlobNode("/_blobs/t/a");
+  EXPECT_FALSE(list.blobNode("/_blobs/t/a", node));
+
+  // The least recently used blob is forgotten first.
+  list.setBlobNode("/_blobs/t/a", Node("http://b:4200"));
+  for (int i = 0; i < 5000; ++i) {
+    list.setBlobNode("/_blobs/t/" + std::to_string(i), Node("http://c:4200"));
+    if (i % 100 == 0) {
+      EXPECT_TRUE(list.blobNode("/_blobs/t/a", node));
+    }
+  }
+  EXPECT_TRUE(list.blobNode("/_blobs/t/a", node));
+  EXPECT_FALSE(list.blobNode("/_blobs/t/0", node));
+  EXPECT_TRUE(list.blobNode("/_blobs/t/4999", node));
+
+  // A node whose circuit is open is not used.
+  list.setNodeError(Node("http://b:4200"));
+  EXPECT_FALSE(list.blobNode("/_blobs/t/a", node));
+  list.setNodeSuccess(Node("http://b:4200"), NodeList::Tries());
+  EXPECT_TRUE(list.blobNode("/_blobs/t/a", node));
+
+  // Blobs owned by a removed node are forgotten.
+  list.setNodes(nodes(3), Client::ConnectToFirstNodeAlways);
+  list.setBlobNode("/_blobs/t/a", Node("http://b:4200"));
+  list.setBlobNode("/_blobs/t/b", Node("http://c:4200"));
+  list.updateNodes(std::vector<Node>(1, Node("http://c:4200")), false);
+  EXPECT_FALSE(list.blobNode("/_blobs/t/a", node));
+  EXPECT_TRUE(list.blobNode("/_blobs/t/b", node));
+  list.setNodes(std::vector<Node>(1, Node("http://a:4200")), Client::ConnectToFirstNodeAlways);
+  EXPECT_FALSE(list.blobNode("/_blobs/t/b", node));
+
+  list.setBlobNode("/_blobs/t/a", Node("http://a:4200"));
+  list.clear();
+  EXPECT_FALSE(list.blobNode("/_blobs/t/a", node));
+}
+#endif
+
+TEST(NodeListTests, LeastLoaded) {
+  using namespace CppCrate;
+
+  NodeList list;
+  list.setNodes(nodes(2), Client::ConnectToLeastLoadedNode);
+  const Node a("http://a:4200");
+  const Node b("http://b:4200");
+
+  // The slower node is avoided.
+  list.setNodeStarted(a);
+  list.setNodeFinished(a, 2.0);
+  list.setNodeStarted(b);
+  list.setNodeFinished(b, 0.01);
+  for (int i = 0; i < 10; ++i) EXPECT_EQ(first(list), b.url());
+
+  // So is a node with too many requests in flight.
+  for (int i = 0; i < 500; ++i) list.setNodeStarted(b);
+  for (int i = 0; i < 10; ++i) EXPECT_EQ(first(list), a.url());
+  for (int i = 0; i < 500; ++i) list.setNodeFinished(b, 0.01);
+  EXPECT_EQ(first(list), b.url());
+
+  // Failover continues after the picked node.
+  NodeList::Tries tries;
+  EXPECT_EQ(next(list, tries), b.url());
+  EXPECT_EQ(next(list, tries), a.url());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
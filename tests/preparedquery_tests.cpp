@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <cppcrate/client.h>
+#include <cppcrate/clientpool.h>
+#include <cppcrate/preparedquery.h>
+
+#include "fakeserver.h"
+
+TEST(PreparedQueryTests, Contructors) {
+  using CppCrate::PreparedQuery;
+
+  PreparedQuery q;
+  EXPECT_TRUE(q.isEmpty());
+  EXPECT_EQ(q.statement(), "");
+  EXPECT_EQ(q.defaultSchema(), "");
+
+  PreparedQuery q2("SELECT \"name\" FROM players WHERE id = ?");
+  EXPECT_FALSE(q2.isEmpty());
+  EXPECT_EQ(q2.statement(), "SELECT \"name\" FROM players WHERE id = ?");
+  EXPECT_EQ(q2.defaultSchema(), "");
+
+  PreparedQuery q3("a", "b");
+  EXPECT_EQ(q3.statement(), "a");
+  EXPECT_EQ(q3.defaultSchema(), "b");
+}
+
+TEST(PreparedQueryTests, Equal) {
+  using CppCrate::PreparedQuery;
+
+  EXPECT_EQ(PreparedQuery(), PreparedQuery());
+  EXPECT_EQ(PreparedQuery("a", "b"), PreparedQuery("a", "b"));
+  EXPECT_NE(PreparedQuery("a", "b"), PreparedQuery("a"));
+  EXPECT_NE(PreparedQuery("a"), PreparedQuery("b"));
+
+  PreparedQuery q("a");
+  PreparedQuery copy = q;
+  EXPECT_EQ(copy, q);
+}
+
+TEST(PreparedQueryTests, Prepare) {
+  using namespace CppCrate;
+
+  Client c;
+  EXPECT_EQ(c.prepare("a"), PreparedQuery("a"));
+  c.setDefaultSchema("b");
+  const PreparedQuery q = c.prepare("a");
+  EXPECT_EQ(q, PreparedQuery("a", "b"));
+  c.clearDefaultSchema();
+  EXPECT_EQ(q.defaultSchema(), "b");
+
+  ClientPool pool;
+  pool.setDefaultSchema("c");
+  EXPECT_EQ(pool.prepare("a"), PreparedQuery("a", "c"));
+}
+
+TEST(PreparedQueryTests, Exec) {
+  using namespace CppCrate;
+
+  const PreparedQuery q("a");
+
+  Client c;
+  EXPECT_EQ(c.exec(q), c.exec(Query("a")));
+  EXPECT_EQ(c.execRaw(q, "[1]"), c.execRaw(Query("a")));
+
+  ClientPool pool;
+  EXPECT_FALSE(pool.exec(q));
+  EXPECT_FALSE(pool.execRaw(q, "[1]"));
+
+  std::vector<Node> nodes;
+  nodes.push_back(Node("foo://bar"));
+  nodes.push_back(Node("foo://baz"));
+  ASSERT_TRUE(c.connect(nodes));
+  const Result result = c.exec(q, "[1]");
+  EXPECT_FALSE(result);
+  EXPECT_EQ(result.errorString().compare(0, 7, "[curl] "), 0);
+  EXPECT_EQ(c.exec(q), result);
+}
+
+TEST(PreparedQueryTests, ExecEmpty) {
+  using namespace CppCrate;
+
+  FakeServer server([](const FakeServer::Request&) {
+    return FakeServer::Response(200, "{\"rowcount\":1}");
+  });
+  const PreparedQuery empty;
+
+  Client c;
+  ASSERT_TRUE(c.connect(server.url()));
+  const Result result = c.exec(empty, "[1]");
+  EXPECT_FALSE(result);
+  EXPECT_EQ(result.errorString(), "[CppCrate] The prepared query is empty. (0)");
+  EXPECT_EQ(c.execRaw(empty), result.rawResult());
+
+  ClientPool pool;
+  ASSERT_TRUE(pool.connect(server.url()));
+  EXPECT_EQ(pool.exec(empty), result);
+  EXPECT_EQ(pool.execRaw(empty, "[1]"), result.rawResult());
+
+  // Nothing was sent, while a query that is not empty still is.
+  EXPECT_TRUE(server.requests().empty());
+  EXPECT_TRUE(c.exec(PreparedQuery("a")));
+  EXPECT_EQ(server.requests().size(), 1u);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -2,6 +2,10 @@
 
 #include <cppcrate/query.h>
 
+#include <cstddef>
+#include <limits>
+#include <thread>
+
 TEST(QueryTests, Contructors) {
   using CppCrate::Query;
 
@@ -152,6 +156,135 @@ TEST(QueryTests, BulkArgumentsAndArguments) {
   EXPECT_FALSE(q.hasBulkArguments());
 }
 
+TEST(QueryTests, Bind) {
+  using CppCrate::Query;
+
+  Query q("a");
+  q.bind(true).bind(int32_t(-7)).bind(int64_t(1) << 40).bind(1.5).bind("Calvin").bindNull();
+  EXPECT_EQ(q.arguments(), "[true,-7,1099511627776,1.5,\"Calvin\",null]");
+  EXPECT_EQ(q.type(), Query::ArgumentType);
+
+  q.clearArguments();
+  EXPECT_EQ(q.type(), Query::SimpleType);
+  q.bind(std::string("a\"b\\c\n", 6)).bind(std::string("\0x", 2));
+  EXPECT_EQ(q.arguments(), "[\"a\\\"b\\\\c\\n\",\"\\u0000x\"]");
+
+  q.clearArguments();
+  q.bind(static_cast<const char*>(0)).bind(1.0 / 0.0);
+  EXPECT_EQ(q.arguments(), "[null,null]");
+
+  // Binding continues an array set by setArguments()
+  q.setArguments("[]");
+  q.bind(1);
+  EXPECT_EQ(q.arguments(), "[1]");
+  q.setArguments("[1]");
+  q.bind(2);
+  EXPECT_EQ(q.arguments(), "[1,2]");
+  q.setArguments(" [ 1 ]\n ");
+  q.bind(2);
+  EXPECT_EQ(q.arguments(), " [ 1,2]");
+  q.setArguments("[\n]\t");
+  q.bind(3);
+  EXPECT_EQ(q.arguments(), "[3]");
+  q.setArguments("  ");
+  q.bind(4);
+  EXPECT_EQ(q.arguments(), "[4]");
+
+  // Arguments that do not end with an array are not touched
+  q.setArguments("{\"a\":1}");
+  q.bind(1).bind("Calvin").bindNull().bind(1.5);
+  EXPECT_EQ(q.arguments(), "{\"a\":1}");
+  q.setArguments("]");
+  q.bind(1);
+  EXPECT_EQ(q.arguments(), "]");
+  q.setArguments(" ]");
+  q.bind(1);
+  EXPECT_EQ(q.arguments(), " ]");
+}
+
+TEST(QueryTests, BindIntegers) {
+  using CppCrate::Query;
+
+  Query q("a");
+  q.bind(short(-1)).bind(static_cast<unsigned short>(2)).bind(-3).bind(4u).bind(-5l).bind(6ul);
+  q.bind(-7ll).bind(8ull);
+  EXPECT_EQ(q.arguments(), "[-1,2,-3,4,-5,6,-7,8]");
+
+  q.clearArguments();
+  q.bind(std::numeric_limits<int32_t>::min()).bind(std::numeric_limits<uint32_t>::max());
+  q.bind(std::numeric_limits<int64_t>::min()).bind(std::numeric_limits<uint64_t>::max());
+  q.bind(std::size_t(9)).bind(std::ptrdiff_t(-10));
+  EXPECT_EQ(q.arguments(),
+            "[-2147483648,4294967295,-9223372036854775808,18446744073709551615,9,-10]");
+}
+
+TEST(QueryTests, BindBulk) {
+  using CppCrate::Query;
+
+  Query q("a");
+  q.bind(1).bind("Calvin").nextRow();
+  q.bind(2).bind("Hobbes").nextRow();
+  q.nextRow();
+
+  std::vector<std::string> ba;
+  ba.emplace_back("[1,\"Calvin\"]");
+  ba.emplace_back("[2,\"Hobbes\"]");
+  ba.emplace_back("[]");
+  EXPECT_EQ(q.bulkArguments(), ba);
+  EXPECT_EQ(q.arguments(), "");
+  EXPECT_EQ(q.type(), Query::BulkArgumentType);
+
+  // A const query may be read by several threads at once.
+  const Query& shared = q;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&shared, &ba]() {
+      for (int j = 0; j < 1000; ++j) {
+        if (shared.bulkArguments() != ba) ADD_FAILURE();
+      }
+    });
+  }
+  for (std::size_t i = 0; i < threads.size(); ++i) threads[i].join();
+
+  q.clearArguments();
+  EXPECT_TRUE(q.bulkArguments().empty());
+  EXPECT_EQ(q.type(), Query::SimpleType);
+}
+
+TEST(QueryTests, BindBulkUnfinishedRow) {
+  using CppCrate::Query;
+
+  // Without the final nextRow(), the last row is kept apart and the query stays a bulk operation.
+  Query q("a");
+  q.bind(1).nextRow();
+  q.bind(2).bind("Hobbes");
+  EXPECT_EQ(q.type(), Query::BulkArgumentType);
+  EXPECT_FALSE(q.hasArguments());
+  EXPECT_EQ(q.arguments(), "");
+  EXPECT_EQ(q.bulkArguments(), std::vector<std::string>(1, "[1]"));
+  EXPECT_NE(q, Query("a", std::vector<std::string>(1, "[1]")));
+
+  // The row is continued and finished as usual.
+  q.bind(3).nextRow();
+  std::vector<std::string> ba;
+  ba.emplace_back("[1]");
+  ba.emplace_back("[2,\"Hobbes\",3]");
+  EXPECT_EQ(q.bulkArguments(), ba);
+  EXPECT_EQ(q, Query("a", ba));
+
+  // Setting the arguments drops the unfinished row.
+  q.bind(4);
+  q.setBulkArguments(ba);
+  q.nextRow();
+  ba.emplace_back("[]");
+  EXPECT_EQ(q.bulkArguments(), ba);
+  q.bind(5);
+  q.setArguments("[6]");
+  q.bind(7);
+  EXPECT_EQ(q.arguments(), "[6,7]");
+  EXPECT_EQ(q.type(), Query::ArgumentType);
+}
+
 TEST(QueryTests, Equal) {
   using CppCrate::Query;
 
@@ -3,6 +3,8 @@
 #include <cppcrate/client.h>
 #include <cppcrate/result.h>
 
+#include <thread>
+
 TEST(ResultTests, ContructorNormal) {
   using CppCrate::Result;
   using CppCrate::Record;
@@ -89,6 +91,28 @@ TEST(ResultTests, ContructorErroneous) {
   EXPECT_NE(result.errorString(), "");
 }
 
+TEST(ResultTests, ColumnIndex) {
+  using CppCrate::Result;
+  using CppCrate::RawResult;
+
+  Result result(RawResult(
+      "{\"cols\":[\"age\",\"name\",\"age\"],\"col_types\":[9,4,9],"
+      "\"rows\":[[7,\"Calvin\",8],[5,\"Hobbes\",6]],\"rowcount\":2,\"duration\":1}"));
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.columnIndex("age"), 0);
+  EXPECT_EQ(result.columnIndex("name"), 1);
+  EXPECT_EQ(result.columnIndex(""), -1);
+  EXPECT_EQ(result.columnIndex("Susie"), -1);
+
+  const int name = result.columnIndex("name");
+  EXPECT_EQ(result.record(0).value(name).asString(), "Calvin");
+  EXPECT_EQ(result.record(1).value(name).asString(), "Hobbes");
+  EXPECT_EQ(result.record(1).value("name"), result.record(1).value(name));
+  EXPECT_EQ(result.record(1).value("age").asInt32(), 5);
+
+  EXPECT_EQ(Result(RawResult("{}")).columnIndex("age"), -1);
+}
+
 TEST(ResultTests, Equal) {
   using CppCrate::Result;
   using CppCrate::RawResult;
@@ -102,6 +126,100 @@ TEST(ResultTests, Equal) {
   EXPECT_NE(Result(raw1), Result(raw2));
 }
 
+TEST(ResultTests, Records) {
+  using CppCrate::Result;
+  using CppCrate::Record;
+  using CppCrate::RawResult;
+
+  Record calvin;
+  Record hobbes;
+  {
+    const Result result(RawResult(
+        "{\"cols\":[\"age\",\"name\",\"toys\"],\"col_types\":[9,4,[100,4]],"
+        "\"rows\":[[7,\"Calvin\",[\"sled\"]],[5,\"Hob\\\"bes\",null]],\"rowcount\":2}"));
+    ASSERT_TRUE(result);
+    calvin = result.record(0);
+    hobbes = result.record(1);
+  }
+
+  // Records share the parsed reply, so they stay valid after the result was destroyed.
+  ASSERT_EQ(calvin.size(), 3);
+  EXPECT_EQ(calvin.value("age").asInt32(), 7);
+  EXPECT_EQ(calvin.value("name").asString(), "Calvin");
+  EXPECT_EQ(calvin.value("toys").asString(), "[\"sled\"]");
+  ASSERT_EQ(hobbes.size(), 3);
+  EXPECT_EQ(hobbes.value(0).asInt32(), 5);
+  EXPECT_EQ(hobbes.value(1).asString(), "Hob\"bes");
+  EXPECT_TRUE(hobbes.value(2).isNull());
+
+  // Rows that are not arrays result in empty records.
+  const Result result(RawResult("{\"cols\":[\"a\"],\"rows\":[7,[1]]}"));
+  EXPECT_EQ(result.recordSize(), 2);
+  EXPECT_EQ(result.record(0).size(), 0);
+  EXPECT_EQ(result.record(1).size(), 1);
+}
+
+TEST(ResultTests, Rows) {
+  using CppCrate::Result;
+  using CppCrate::RawResult;
+
+  EXPECT_TRUE(Result(RawResult("{\"rowcount\":1}")).rows().empty());
+  EXPECT_TRUE(Result(RawResult("{\"rows\":{}}")).rows().empty());
+  EXPECT_TRUE(Result(RawResult("a")).rows().empty());
+
+  // The rows are serialized compactly, regardless of the reply's formatting.
+  const Result result(
+      RawResult("{ \"rows\" : [ [ 1 , \"a\\u0062\" ] , [ ] , [ { \"k\" : null } ] ] }"));
+  const Result copy = result;
+  std::vector<std::string> rows;
+  rows.emplace_back("[1,\"ab\"]");
+  rows.emplace_back("[]");
+  rows.emplace_back("[{\"k\":null}]");
+
+  // Copies share the serialized rows, no matter which one serializes them.
+  std::vector<std::thread> threads;
+  std::vector<const std::vector<std::string>*> serialized(8);
+  for (std::size_t i = 0; i < serialized.size(); ++i) {
+    threads.emplace_back([&, i]() { serialized[i] = &(i % 2 ? copy : result).rows(); });
+  }
+  for (std::size_t i = 0; i < threads.size(); ++i) threads[i].join();
+  for (std::size_t i = 0; i < serialized.size(); ++i) {
+    EXPECT_EQ(serialized[i], &result.rows());
+  }
+  EXPECT_EQ(result.rows(), rows);
+  EXPECT_EQ(copy.rows(), rows);
+}
+
+TEST(ResultTests, ErrorStrings) {
+  using CppCrate::Result;
+  using CppCrate::RawResult;
+
+  EXPECT_EQ(Result(RawResult("{\"error\":{\"message\":\"foo\",\"code\":42}}")).errorString(),
+            "[crate] foo (42)");
+  EXPECT_EQ(Result(RawResult("{\"error\":{\"message\":\"foo\"}}")).errorString(), "[crate] foo");
+  EXPECT_EQ(Result(RawResult("{\"error\":{\"message\":null,\"code\":false}}")).errorString(),
+            "[crate] Unknown error.");
+  EXPECT_EQ(Result(RawResult("{\"error\":true}")).errorString(), "Unknown error.");
+  EXPECT_EQ(Result(RawResult("{\"error\":{\"message\":\"foo\",\"code\":42,\"component\":\"bar\"}}"))
+                .errorString(),
+            "[bar] foo (42)");
+  EXPECT_EQ(Result(RawResult("{\"error\":{\"message\":\"foo\",\"component\":42}}")).errorString(),
+            "[unknown] foo");
+  EXPECT_EQ(
+      Result(RawResult("{\"results\":[{\"rowcount\":-2},{\"rowcount\":1},{\"rowcount\":-2}]}"))
+          .errorString(),
+            "[crate] Error in bulk arguments [1, 3].");
+  EXPECT_EQ(Result(RawResult("{\"a\":")).errorString(),
+            "[json] Parse error at offset 5: Invalid value.");
+
+  // An error reply has neither rows nor meta information.
+  const Result result(
+      RawResult("{\"error\":{\"message\":\"foo\",\"code\":42},\"rows\":[[1]],\"rowcount\":1}"));
+  EXPECT_EQ(result.recordSize(), 0);
+  EXPECT_TRUE(result.rows().empty());
+  EXPECT_EQ(result.rowCount(), 0);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <cppcrate/query.h>
+#include <cppcrate/rowbatch.h>
+
+TEST(RowBatchTests, Constructors) {
+  using CppCrate::RowBatch;
+
+  RowBatch b;
+  EXPECT_TRUE(b.isEmpty());
+  EXPECT_EQ(b.size(), 0);
+  EXPECT_EQ(b.json(), "");
+  EXPECT_TRUE(b.rows().empty());
+  EXPECT_EQ(b.row(0), "");
+
+  std::vector<std::string> rows;
+  rows.emplace_back("[1,\"Calvin\"]");
+  rows.emplace_back("[2,\"Hobbes\"]");
+  RowBatch b2(rows);
+  EXPECT_FALSE(b2.isEmpty());
+  EXPECT_EQ(b2.size(), 2);
+  EXPECT_EQ(b2.json(), "[[1,\"Calvin\"],[2,\"Hobbes\"]]");
+  EXPECT_EQ(b2.rows(), rows);
+
+  EXPECT_EQ(RowBatch(std::vector<std::string>()), b);
+}
+
+TEST(RowBatchTests, Append) {
+  using CppCrate::RowBatch;
+
+  RowBatch b;
+  b.reserve(100);
+  b.append("[1]");
+  EXPECT_EQ(b.json(), "[[1]]");
+  b.append("[2,3]xyz", 5);
+  EXPECT_EQ(b.json(), "[[1],[2,3]]");
+  EXPECT_EQ(b.size(), 2);
+  EXPECT_EQ(b.row(0), "[1]");
+  EXPECT_EQ(b.row(1), "[2,3]");
+  EXPECT_EQ(b.row(2), "");
+  EXPECT_EQ(b.row(-1), "");
+
+  RowBatch other;
+  other.append("[4]");
+  other.append("[5]");
+  b.append(other);
+  EXPECT_EQ(b.json(), "[[1],[2,3],[4],[5]]");
+  EXPECT_EQ(b.size(), 4);
+  EXPECT_EQ(b.row(3), "[5]");
+
+  RowBatch empty;
+  empty.append(other);
+  EXPECT_EQ(empty, other);
+  empty.append(RowBatch());
+  EXPECT_EQ(empty, other);
+
+  b.clear();
+  EXPECT_TRUE(b.isEmpty());
+  EXPECT_EQ(b.json(), "");
+}
+
+TEST(RowBatchTests, Slice) {
+  using CppCrate::RowBatch;
+
+  RowBatch b;
+  for (int i = 0; i < 5; ++i) b.append("[" + std::to_string(i) + "]");
+
+  RowBatch s = b.slice(1, 3);
+  EXPECT_EQ(s.json(), "[[1],[2],[3]]");
+  EXPECT_EQ(s.size(), 3);
+  EXPECT_EQ(s.row(0), "[1]");
+  EXPECT_EQ(s.row(2), "[3]");
+
+  EXPECT_EQ(b.slice(0, 5), b);
+  EXPECT_EQ(b.slice(3, 10).json(), "[[3],[4]]");
+  EXPECT_EQ(b.slice(-1, 2).json(), "[[0]]");
+  EXPECT_TRUE(b.slice(5, 1).isEmpty());
+  EXPECT_TRUE(b.slice(0, 0).isEmpty());
+}
+
+TEST(RowBatchTests, Query) {
+  using CppCrate::Query;
+  using CppCrate::RowBatch;
+
+  RowBatch b;
+  b.append("[1]");
+  b.append("[2]");
+
+  Query q("a", b);
+  EXPECT_EQ(q.type(), Query::BulkArgumentType);
+  EXPECT_EQ(q.bulkArgumentBatch(), b);
+  EXPECT_EQ(q.bulkArguments(), b.rows());
+  EXPECT_EQ(q, Query("a", b.rows()));
+
+  q.setArguments("[1]");
+  EXPECT_TRUE(q.bulkArgumentBatch().isEmpty());
+  EXPECT_TRUE(q.bulkArguments().empty());
+  q.setBulkArguments(b);
+  EXPECT_EQ(q.arguments(), "");
+  EXPECT_EQ(q.bulkArguments(), b.rows());
+
+  q.clearArguments();
+  q.bind(1).nextRow().bind(2).nextRow();
+  EXPECT_EQ(q.bulkArgumentBatch(), b);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
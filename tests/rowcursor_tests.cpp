@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <cppcrate/client.h>
+#include <cppcrate/rowcursor.h>
+
+#include "fakeserver.h"
+
+TEST(RowCursorTests, Constructor) {
+  using namespace CppCrate;
+
+  RowCursor cursor;
+  EXPECT_TRUE(cursor);
+  EXPECT_FALSE(cursor.hasError());
+  EXPECT_EQ(cursor.errorString(), "");
+  EXPECT_FALSE(cursor.next());
+  EXPECT_EQ(cursor.record().size(), 0);
+  EXPECT_TRUE(cursor.cols().empty());
+  EXPECT_TRUE(cursor.colTypes().empty());
+  EXPECT_EQ(cursor.rowCount(), 0);
+  EXPECT_EQ(cursor.duration(), 0.0);
+
+  RowCursor moved(std::move(cursor));
+  EXPECT_FALSE(moved.next());
+}
+
+TEST(RowCursorTests, DisconnectedClient) {
+  using namespace CppCrate;
+
+  Client client;
+  RowCursor cursor = client.query("a");
+  EXPECT_FALSE(cursor.next());
+  EXPECT_FALSE(cursor);
+  EXPECT_EQ(cursor.errorString(), "[CppCrate] CppCrate::Client is not connected. (0)");
+}
+
+TEST(RowCursorTests, UnreachableNodes) {
+  using namespace CppCrate;
+
+  std::vector<Node> nodes;
+  nodes.push_back(Node("foo://bar"));
+  nodes.push_back(Node("foo://baz"));
+
+  Client client;
+  ASSERT_TRUE(client.connect(nodes));
+  RowCursor cursor = client.query(Query("a"), 0);
+  EXPECT_FALSE(cursor.next());
+  EXPECT_TRUE(cursor.hasError());
+  EXPECT_EQ(cursor.errorString().compare(0, 7, "[curl] "), 0);
+
+  // Destroying a cursor that was not consumed must not block.
+  RowCursor unused = client.query("a");
+}
+
+TEST(RowCursorTests, Rows) {
+  using namespace CppCrate;
+
+  FakeServer server([](const FakeServer::Request&) {
+    return FakeServer::Response(
+        200,
+        "{\"cols\":[\"id\",\"name\",\"tags\",\"info\"],"
+        "\"col_types\":[9,4,[100,4],12],"
+        "\"rows\":[[1,\"a\",[\"x\",\"y\"],{\"k\":[1,{\"l\":2}]}],[2,null,[],{}]],"
+        "\"rowcount\":2,\"duration\":1.5}");
+  });
+
+  Client client;
+  ASSERT_TRUE(client.connect(server.url()));
+  RowCursor cursor = client.query(Query("SELECT * FROM t"), 1);
+
+  ASSERT_TRUE(cursor.next());
+  Record record = cursor.record();
+  ASSERT_EQ(record.size(), 4);
+  EXPECT_EQ(record.value("id").asInt32(), 1);
+  EXPECT_EQ(record.value("name").asString(), "a");
+  EXPECT_EQ(record.value("tags").asString(), "[\"x\",\"y\"]");
+  EXPECT_EQ(record.value("info").asString(), "{\"k\":[1,{\"l\":2}]}");
+
+  ASSERT_TRUE(cursor.next());
+  record = cursor.record();
+  ASSERT_EQ(record.size(), 4);
+  EXPECT_EQ(record.value(0).asInt32(), 2);
+  EXPECT_TRUE(record.value(1).isNull());
+  EXPECT_EQ(record.value(2).asString(), "[]");
+  EXPECT_EQ(record.value(3).asString(), "{}");
+
+  EXPECT_FALSE(cursor.next());
+  EXPECT_TRUE(cursor);
+  EXPECT_EQ(cursor.errorString(), "");
+  EXPECT_EQ(cursor.cols(), (std::vector<std::string>{"id", "name", "tags", "info"}));
+  ASSERT_EQ(cursor.colTypes().size(), 4u);
+  EXPECT_EQ(cursor.colTypes()[0].type(), CrateDataType::Integer);
+  EXPECT_EQ(cursor.colTypes()[0].definition(), "9");
+  EXPECT_EQ(cursor.colTypes()[1].type(), CrateDataType::String);
+  EXPECT_EQ(cursor.colTypes()[2].type(), CrateDataType::Array);
+  EXPECT_EQ(cursor.colTypes()[2].definition(), "[100,4]");
+  EXPECT_EQ(cursor.colTypes()[3].type(), CrateDataType::Object);
+  EXPECT_EQ(cursor.rowCount(), 2);
+  EXPECT_EQ(cursor.duration(), 1.5);
+
+  const std::vector<FakeServer::Request> requests = server.requests();
+  ASSERT_EQ(requests.size(), 1u);
+  EXPECT_EQ(requests[0].method, "POST");
+  EXPECT_EQ(requests[0].path, "/_sql");
+  EXPECT_NE(requests[0].body.find("SELECT * FROM t"), std::string::npos);
+}
+
+TEST(RowCursorTests, NoRows) {
+  using namespace CppCrate;
+
+  // Members in an unusual order and unknown members must not confuse the handler.
+  FakeServer server([](const FakeServer::Request&) {
+    return FakeServer::Response(200,
+                                "{\"duration\":0.25,\"other\":{\"rowcount\":7,\"rows\":[[1]]},"
+                                "\"rowcount\":5,\"cols\":[],\"rows\":[]}");
+  });
+
+  Client client;
+  ASSERT_TRUE(client.connect(server.url()));
+  RowCursor cursor = client.query("UPDATE t SET a = 1");
+  EXPECT_FALSE(cursor.next());
+  EXPECT_TRUE(cursor);
+  EXPECT_TRUE(cursor.cols().empty());
+  EXPECT_TRUE(cursor.colTypes().empty());
+  EXPECT_EQ(cursor.rowCount(), 5);
+  EXPECT_EQ(cursor.duration(), 0.25);
+}
+
+TEST(RowCursorTests, ErrorReply) {
+  using namespace CppCrate;
+
+  FakeServer server([](const FakeServer::Request&) {
+    return FakeServer::Response(
+        400,
+        "{\"error\":{\"message\":\"SQLActionException[t missing]\",\"code\":4041},"
+        "\"error_trace\":\"trace\"}");
+  });
+
+  Client client;
+  ASSERT_TRUE(client.connect(server.url()));
+  RowCursor cursor = client.query("SELECT * FROM t");
+  EXPECT_FALSE(cursor.next());
+  EXPECT_FALSE(cursor);
+  EXPECT_EQ(cursor.errorString(), "[crate] SQLActionException[t missing] (4041)");
+  EXPECT_EQ(cursor.rowCount(), 0);
+  EXPECT_EQ(server.requests().size(), 1u);
+}
+
+TEST(RowCursorTests, InvalidReply) {
+  using namespace CppCrate;
+
+  FakeServer server([](const FakeServer::Request&) {
+    return FakeServer::Response(200, "{\"cols\":[\"a\"],\"rows\":[[1],[2}");
+  });
+
+  Client client;
+  ASSERT_TRUE(client.connect(server.url()));
+  RowCursor cursor = client.query("SELECT a FROM t");
+  ASSERT_TRUE(cursor.next());
+  EXPECT_EQ(cursor.record().value("a").asInt32(), 1);
+  EXPECT_FALSE(cursor.next());
+  EXPECT_FALSE(cursor);
+  EXPECT_EQ(cursor.errorString().compare(0, 7, "[json] "), 0);
+}
+
+TEST(RowCursorTests, TruncatedReply) {
+  using namespace CppCrate;
+
+  const std::string reply = "{\"cols\":[\"a\"],\"rows\":[[1],[2],[3]],\"rowcount\":3}";
+  FakeServer server([&reply](const FakeServer::Request&) {
+    FakeServer::Response response(200, reply);
+    response.truncateAt = reply.find("[3]");
+    return response;
+  });
+
+  std::vector<Node> nodes;
+  nodes.push_back(Node(server.url()));
+  nodes.push_back(Node(server.url() + "/"));
+
+  Client client;
+  ASSERT_TRUE(client.connect(nodes));
+  RowCursor cursor = client.query("SELECT a FROM t");
+  ASSERT_TRUE(cursor.next());
+  EXPECT_EQ(cursor.record().value(0).asInt32(), 1);
+  ASSERT_TRUE(cursor.next());
+  EXPECT_EQ(cursor.record().value(0).asInt32(), 2);
+  EXPECT_FALSE(cursor.next());
+  EXPECT_TRUE(cursor.hasError());
+  EXPECT_EQ(cursor.errorString().compare(0, 7, "[curl] "), 0);
+  // Rows were already handed out, so the query must not be repeated on the other node.
+  EXPECT_EQ(server.requests().size(), 1u);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
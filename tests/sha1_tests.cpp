@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include "../src/sha1.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<CppCrate::Sha1::Implementation> implementations() {
+  using CppCrate::Sha1;
+  std::vector<Sha1::Implementation> supported;
+  supported.push_back(Sha1::ScalarImplementation);
+  if (Sha1::isSupported(Sha1::Ssse3Implementation)) supported.push_back(Sha1::Ssse3Implementation);
+  if (Sha1::isSupported(Sha1::ShaNiImplementation)) supported.push_back(Sha1::ShaNiImplementation);
+  return supported;
+}
+
+std::string sha1(CppCrate::Sha1::Implementation implementation, const std::string& data) {
+  CppCrate::Sha1 gen(implementation);
+  gen.update(data.data(), data.size());
+  return gen.final();
+}
+}
+
+TEST(Sha1Tests, KnownDigests) {
+  using CppCrate::Sha1;
+
+  const std::vector<Sha1::Implementation> supported = implementations();
+  for (std::size_t i = 0; i < supported.size(); ++i) {
+    SCOPED_TRACE(Sha1::name(supported[i]));
+    EXPECT_EQ(sha1(supported[i], ""), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    EXPECT_EQ(sha1(supported[i], "abc"), "a9993e364706816aba3e25717850c26c9cd0d89d");
+    EXPECT_EQ(sha1(supported[i], "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+              "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+    EXPECT_EQ(sha1(supported[i], std::string(1000000, 'a')),
+              "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+  }
+}
+
+TEST(Sha1Tests, Implementations) {
+  using CppCrate::Sha1;
+
+  EXPECT_TRUE(Sha1::isSupported(Sha1::ScalarImplementation));
+  EXPECT_TRUE(Sha1::isSupported(Sha1::fastest()));
+
+  // All implementations agree for every size around the block size and for any split of the data.
+  std::string data;
+  for (int i = 0; i < 300; ++i) data += static_cast<char>(i * 37 + 11);
+  const std::vector<Sha1::Implementation> supported = implementations();
+  for (std::size_t size = 0; size <= data.size(); ++size) {
+    const std::string expected = sha1(Sha1::ScalarImplementation, data.substr(0, size));
+    for (std::size_t i = 0; i < supported.size(); ++i) {
+      Sha1 gen(supported[i]);
+      const std::size_t split = size / 3;
+      gen.update(data.data(), split);
+      gen.update(data.data() + split, size - split);
+      EXPECT_EQ(gen.final(), expected) << Sha1::name(supported[i]) << ", size " << size;
+    }
+  }
+}
+
+TEST(Sha1Tests, Batch) {
+  using CppCrate::Sha1;
+
+  EXPECT_TRUE(Sha1::isSupported(Sha1::fastestBatch()));
+  EXPECT_TRUE(Sha1::hash(std::vector<Sha1::Buffer>()).empty());
+
+  std::vector<Sha1::Implementation> supported = implementations();
+  if (Sha1::isSupported(Sha1::Sse2LanesImplementation)) {
+    supported.push_back(Sha1::Sse2LanesImplementation);
+  }
+  if (Sha1::isSupported(Sha1::Avx2LanesImplementation)) {
+    supported.push_back(Sha1::Avx2LanesImplementation);
+  }
+
+  // Buffers of different sizes finish in different rounds, so lanes are refilled at any time.
+  std::string data;
+  for (int i = 0; i < 3000; ++i) data += static_cast<char>(i * 37 + 11);
+  std::vector<Sha1::Buffer> buffers;
+  std::vector<std::string> expected;
+  for (std::size_t size = 0; size < 200; ++size) {
+    const std::size_t length = (size * size * 7) % (data.size() - size);
+    buffers.push_back(Sha1::Buffer(data.data() + size, length));
+    expected.push_back(sha1(Sha1::ScalarImplementation, data.substr(size, length)));
+  }
+  for (std::size_t i = 0; i < supported.size(); ++i) {
+    SCOPED_TRACE(Sha1::name(supported[i]));
+    for (std::size_t count = 1; count <= buffers.size(); count += count < 20 ? 1 : 37) {
+      const std::vector<Sha1::Buffer> batch(buffers.begin(), buffers.begin() + count);
+      const std::vector<std::string> digests = Sha1::hash(batch, supported[i]);
+      ASSERT_EQ(digests.size(), count);
+      for (std::size_t j = 0; j < count; ++j) EXPECT_EQ(digests[j], expected[j]) << "buffer " << j;
+    }
+  }
+}
+
+TEST(Sha1Tests, Reuse) {
+  using CppCrate::Sha1;
+
+  Sha1 gen;
+  gen.update("abc", 3);
+  EXPECT_EQ(gen.final(), "a9993e364706816aba3e25717850c26c9cd0d89d");
+  gen.update("abc", 3);
+  EXPECT_EQ(gen.final(), "a9993e364706816aba3e25717850c26c9cd0d89d");
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "../src/shareddata.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+class Data : public CppCrate::SharedData {
+ public:
+  explicit Data(bool* deleted) : deleted(deleted) {}
+  ~Data() { *deleted = true; }
+
+  bool* deleted;
+};
+}
+
+TEST(SharedDataTests, RefCount) {
+  using CppCrate::SharedDataPointer;
+
+  EXPECT_TRUE(SharedDataPointer<Data>().isNull());
+
+  bool deleted = false;
+  Data* data = new Data(&deleted);
+  {
+    SharedDataPointer<Data> a(data);
+    EXPECT_FALSE(a.isNull());
+    EXPECT_EQ(a.data(), data);
+    EXPECT_EQ(data->refs, 1);
+    {
+      SharedDataPointer<Data> b(a);
+      EXPECT_EQ(data->refs, 2);
+      SharedDataPointer<Data> c;
+      c = b;
+      EXPECT_EQ(data->refs, 3);
+      c = c;
+      EXPECT_EQ(data->refs, 3);
+      c = SharedDataPointer<Data>();
+      EXPECT_EQ(data->refs, 2);
+    }
+    EXPECT_EQ(data->refs, 1);
+    EXPECT_FALSE(deleted);
+  }
+  EXPECT_TRUE(deleted);
+}
+
+TEST(SharedDataTests, Threaded) {
+  using CppCrate::SharedDataPointer;
+
+  bool deleted = false;
+  {
+    const SharedDataPointer<Data> data(new Data(&deleted));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+      threads.emplace_back([&data]() {
+        for (int j = 0; j < 100000; ++j) {
+          SharedDataPointer<Data> copy(data);
+          copy = data;
+        }
+      });
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) threads[i].join();
+    EXPECT_EQ(data->refs, 1);
+    EXPECT_FALSE(deleted);
+  }
+  EXPECT_TRUE(deleted);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <cppcrate/client.h>
+#include <cppcrate/tablescanner.h>
+
+#include "fakeserver.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <atomic>
+
+namespace {
+// Answers the n-th request with the n-th of \a pages, which are the rows of a page as JSON.
+FakeServer::Handler pages(const std::vector<std::string>& pages, const std::string& cols) {
+  std::shared_ptr<std::atomic<std::size_t> > count(new std::atomic<std::size_t>(0));
+  return [pages, cols, count](const FakeServer::Request&) {
+    const std::size_t n = (*count)++;
+    const std::string rows = n < pages.size() ? pages[n] : "[]";
+    return FakeServer::Response(200, "{\"cols\":" + cols + ",\"rows\":" + rows + "}");
+  };
+}
+
+// Returns the statement and the arguments of a request to /_sql.
+std::pair<std::string, std::string> statement(const FakeServer::Request& request) {
+  rapidjson::Document doc;
+  doc.Parse(request.body.c_str());
+  std::string args;
+  if (doc.HasMember("args")) {
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    doc["args"].Accept(writer);
+    args.assign(sb.GetString(), sb.GetSize());
+  }
+  return std::make_pair(std::string(doc["stmt"].GetString()), args);
+}
+}
+
+TEST(TableScannerTests, Constructor) {
+  using namespace CppCrate;
+
+  TableScanner scanner;
+  EXPECT_TRUE(scanner);
+  EXPECT_FALSE(scanner.hasError());
+  EXPECT_EQ(scanner.errorString(), "");
+  EXPECT_FALSE(scanner.next());
+  EXPECT_TRUE(scanner.page());
+  EXPECT_EQ(scanner.page().recordSize(), 0);
+  EXPECT_EQ(scanner.table(), "");
+  EXPECT_EQ(scanner.keyColumn(), "");
+  EXPECT_EQ(scanner.pageSize(), 0);
+
+  TableScanner moved(std::move(scanner));
+  EXPECT_FALSE(moved.next());
+}
+
+TEST(TableScannerTests, DisconnectedClient) {
+  using namespace CppCrate;
+
+  Client client;
+  TableScanner scanner = client.scan("players", "id", 0);
+  EXPECT_EQ(scanner.table(), "players");
+  EXPECT_EQ(scanner.keyColumn(), "id");
+  EXPECT_EQ(scanner.pageSize(), 1);
+  EXPECT_FALSE(scanner.next());
+  EXPECT_FALSE(scanner);
+  EXPECT_EQ(scanner.errorString(), "[CppCrate] CppCrate::Client is not connected. (0)");
+  EXPECT_EQ(scanner.page().recordSize(), 0);
+  EXPECT_FALSE(scanner.next());
+}
+
+TEST(TableScannerTests, UnreachableNodes) {
+  using namespace CppCrate;
+
+  std::vector<Node> nodes;
+  nodes.push_back(Node("foo://bar"));
+  nodes.push_back(Node("foo://baz"));
+
+  Client client;
+  ASSERT_TRUE(client.connect(nodes));
+  TableScanner scanner = client.scan("players", "id", 100, "id, name");
+  EXPECT_FALSE(scanner.next());
+  EXPECT_TRUE(scanner.hasError());
+  EXPECT_EQ(scanner.errorString().compare(0, 7, "[curl] "), 0);
+
+  // Destroying a scanner whose page is still pending must not block.
+  TableScanner unused = client.scan("players", "id");
+}
+
+TEST(TableScannerTests, Pages) {
+  using namespace CppCrate;
+
+  std::vector<std::string> rows;
+  rows.push_back("[[1,\"a\"],[2,\"b\"]]");
+  rows.push_back("[[3,\"c\"],[4,\"d\"]]");
+  rows.push_back("[[5,\"e\"]]");
+  FakeServer server(pages(rows, "[\"id\",\"name\"]"));
+
+  Client client;
+  ASSERT_TRUE(client.connect(server.url()));
+  TableScanner scanner = client.scan("players", "id", 2, "id, name");
+  std::string names;
+  int pageCount = 0;
+  while (scanner.next()) {
+    ++pageCount;
+    for (int i = 0, total = scanner.page().recordSize(); i < total; ++i) {
+      names += scanner.page().record(i).value("name").asString();
+    }
+  }
+  EXPECT_TRUE(scanner);
+  EXPECT_EQ(pageCount, 3);
+  EXPECT_EQ(names, "abcde");
+
+  // The key column is found by name, the last page is short, so no empty page is requested.
+  const std::vector<FakeServer::Request> requests = server.requests();
+  ASSERT_EQ(requests.size(), 3u);
+  EXPECT_EQ(statement(requests[0]),
+            std::make_pair(std::string("SELECT id, name FROM players WHERE id IS NOT NULL "
+                                       "ORDER BY id LIMIT 2"),
+                           std::string()));
+  const std::string next = "SELECT id, name FROM players WHERE id > ? ORDER BY id LIMIT 2";
+  EXPECT_EQ(statement(requests[1]), std::make_pair(next, std::string("[2]")));
+  EXPECT_EQ(statement(requests[2]), std::make_pair(next, std::string("[4]")));
+}
+
+TEST(TableScannerTests, KeyTypes) {
+  using namespace CppCrate;
+
+  std::vector<std::string> rows;
+  rows.push_back("[[\"a\\\"b\"]]");
+  rows.push_back("[[9007199254740993]]");
+  rows.push_back("[[-1.5]]");
+  rows.push_back("[[true]]");
+  rows.push_back("[[null]]");
+  FakeServer server(pages(rows, "[\"k\"]"));
+
+  Client client;
+  ASSERT_TRUE(client.connect(server.url()));
+  TableScanner scanner = client.scan("t", "k", 1);
+  int pageCount = 0;
+  while (scanner.next()) ++pageCount;
+  EXPECT_TRUE(scanner);
+  EXPECT_EQ(pageCount, 5);
+
+  // Keys are passed on without losing precision. A null key ends the scan.
+  const std::vector<FakeServer::Request> requests = server.requests();
+  ASSERT_EQ(requests.size(), 5u);
+  EXPECT_EQ(statement(requests[1]).second, "[\"a\\\"b\"]");
+  EXPECT_EQ(statement(requests[2]).second, "[9007199254740993]");
+  EXPECT_EQ(statement(requests[3]).second, "[-1.5]");
+  EXPECT_EQ(statement(requests[4]).second, "[true]");
+}
+
+TEST(TableScannerTests, MissingKeyColumn) {
+  using namespace CppCrate;
+
+  std::vector<std::string> rows;
+  rows.push_back("[[1]]");
+  FakeServer server(pages(rows, "[\"name\"]"));
+
+  Client client;
+  ASSERT_TRUE(client.connect(server.url()));
+  TableScanner scanner = client.scan("players", "id", 1, "name");
+  EXPECT_FALSE(scanner.next());
+  EXPECT_EQ(scanner.errorString(),
+            "[CppCrate] The key column \"id\" is not part of the result.");
+  EXPECT_EQ(scanner.page().recordSize(), 0);
+  EXPECT_EQ(server.requests().size(), 1u);
+}
+
+TEST(TableScannerTests, ErrorReply) {
+  using namespace CppCrate;
+
+  FakeServer server([](const FakeServer::Request& request) {
+    if (request.body.find("\"args\"") == std::string::npos) {
+      return FakeServer::Response(200, "{\"cols\":[\"id\"],\"rows\":[[1],[2]]}");
+    }
+    return FakeServer::Response(
+        404, "{\"error\":{\"message\":\"TableUnknownException\",\"code\":4041}}");
+  });
+
+  Client client;
+  ASSERT_TRUE(client.connect(server.url()));
+  TableScanner scanner = client.scan("players", "id", 2);
+  ASSERT_TRUE(scanner.next());
+  EXPECT_EQ(scanner.page().recordSize(), 2);
+  EXPECT_FALSE(scanner.next());
+  EXPECT_EQ(scanner.errorString(), "[crate] TableUnknownException (4041)");
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
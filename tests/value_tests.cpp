@@ -2,6 +2,8 @@
 
 #include <cppcrate/value.h>
 
+#include <thread>
+
 TEST(ValueTests, Contructors) {
   using CppCrate::CrateDataType;
   using CppCrate::Value;
@@ -128,6 +130,56 @@ TEST(ValueTests, PrivateMove) {
   }
 }
 
+TEST(ValueTests, Copy) {
+  using CppCrate::CrateDataType;
+  using CppCrate::Value;
+
+  const std::string text = "Calvin and Hobbes are best friends.";
+  Value copy;
+  {
+    const Value origin("a", CrateDataType(CrateDataType::String), text);
+    copy = origin;
+    // The meta information is shared, long strings are not.
+    EXPECT_EQ(&copy.name(), &origin.name());
+    EXPECT_EQ(&copy.crateType(), &origin.crateType());
+    EXPECT_EQ(copy, origin);
+  }
+  EXPECT_EQ(copy.name(), "a");
+  EXPECT_EQ(copy.crateType().type(), CrateDataType::String);
+  EXPECT_EQ(copy.asString(), text);
+
+  Value small("b", CrateDataType(CrateDataType::String), std::string("Susie"));
+  Value smallCopy(small);
+  small = copy;
+  EXPECT_EQ(smallCopy.name(), "b");
+  EXPECT_EQ(smallCopy.asString(), "Susie");
+  EXPECT_EQ(small.asString(), text);
+}
+
+TEST(ValueTests, CopyThreaded) {
+  using CppCrate::CrateDataType;
+  using CppCrate::Value;
+
+  // Copies of a value share its meta information, even if they are made by several threads.
+  Value value("a", CrateDataType(CrateDataType::Integer), int32_t(1));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&value]() {
+      for (int j = 0; j < 10000; ++j) {
+        const Value copy(value);
+        if (&copy.name() != &value.name() || copy.asInt32() != 1) ADD_FAILURE();
+      }
+    });
+  }
+  for (std::size_t i = 0; i < threads.size(); ++i) threads[i].join();
+
+  const Value copy(value);
+  value = Value();
+  EXPECT_EQ(copy.name(), "a");
+  EXPECT_EQ(copy.crateType().type(), CrateDataType::Integer);
+  EXPECT_EQ(copy.asInt32(), 1);
+}
+
 struct ConvData {
   CppCrate::Value value;
   bool asBool;